@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+
+# exports a landing from a rosbag for landing_detector_replay
+#
+# usage: export_landing.py <bag> <output.csv> --uav <uav_name> --mass <kg> --a <A> --b <B> --n-motors <n>
+#                          [--start <s>] [--touchdown <s>]
+#
+# * --start and --touchdown are relative to the start of the bag
+# * the samples are stamped by their header stamps (the bag receive time only when the stamp is zero), as the online detector,
+#   and kept in the order of arrival
+# * --touchdown is the labelled touchdown, leave it out for recordings without one (e.g., hovering)
+# * the mass estimate uses the quadratic thrust model of mrs_lib with the motor params of the UAV
+
+import argparse
+import math
+
+import rosbag
+
+parser = argparse.ArgumentParser()
+parser.add_argument("bag")
+parser.add_argument("output")
+parser.add_argument("--uav", required=True)
+parser.add_argument("--mass", type=float, required=True, help="the UAV mass [kg]")
+parser.add_argument("--a", type=float, required=True)
+parser.add_argument("--b", type=float, required=True)
+parser.add_argument("--n-motors", type=int, required=True)
+parser.add_argument("--g", type=float, default=9.8)
+parser.add_argument("--start", type=float, default=0.0)
+parser.add_argument("--touchdown", type=float)
+parser.add_argument("--odometry", default="odometry/odom_main")
+parser.add_argument("--attitude-cmd", default="control_manager/attitude_cmd")
+args = parser.parse_args()
+
+odometry_topic = "/" + args.uav + "/" + args.odometry
+attitude_topic = "/" + args.uav + "/" + args.attitude_cmd
+
+with rosbag.Bag(args.bag) as bag, open(args.output, "w") as out:
+
+    t0 = bag.get_start_time()
+
+    out.write("# exported from {}\n".format(args.bag))
+
+    mass_written = False
+
+    for topic, msg, t in bag.read_messages(topics=[odometry_topic, attitude_topic]):
+
+        # the same time base as the online detector (ControlManager::feedLandingDetector(), UavManager::callbackAttitudeCmd())
+        header_stamp = msg.header.stamp.to_sec()
+
+        stamp = (header_stamp if header_stamp > 0 else t.to_sec()) - t0
+
+        if stamp < args.start:
+            continue
+
+        if topic == attitude_topic:
+
+            if not mass_written:
+                out.write("{:.6f} mass {:.4f}\n".format(stamp, args.mass + msg.mass_difference))
+                mass_written = True
+
+            force = args.n_motors * math.pow((msg.thrust - args.b) / args.a, 2) if msg.thrust > args.b else 0.0
+            out.write("{:.6f} thrust {:.4f} {:.4f}\n".format(stamp, force / args.g, msg.thrust))
+
+        elif mass_written:
+
+            out.write("{:.6f} odom {:.4f} {:.4f}\n".format(stamp, msg.pose.pose.position.z, msg.twist.twist.linear.z))
+
+    if args.touchdown is not None:
+        out.write("{:.6f} touchdown\n".format(args.touchdown))
@@ -0,0 +1,303 @@
+// replays recorded landings through the landing::LandingDetector and reports
+// the detection latency and the false positives of the fused detection and of the thrust-only fallback
+//
+// usage: landing_detector_replay [--rate <Hz>] [--<param> <value>]... <recording.csv>...
+//
+// the recordings are produced by export_landing.py, one sample per line:
+//   <stamp> mass <expected mass [kg]>                    the landing starts, the detector is reset
+//   <stamp> thrust <mass estimate [kg]> <thrust [-]>      attitude command
+//   <stamp> odom <height [m]> <vertical speed [m/s]>      odometry
+//   <stamp> touchdown                                     labelled touchdown, missing in recordings without one
+// the separator is a space or a comma, lines starting with '#' are ignored
+
+#include <mrs_uav_managers/landing_detector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace mrs_uav_managers::landing;
+
+/* Sample //{ */
+
+struct Sample
+{
+  enum Type
+  {
+    MASS,
+    THRUST,
+    ODOM,
+    TOUCHDOWN
+  };
+
+  double stamp;
+  Type   type;
+  double a = 0;
+  double b = 0;
+};
+
+//}
+
+/* Recording //{ */
+
+struct Recording
+{
+  std::string         name;
+  std::vector<Sample> samples;
+  double              touchdown = std::numeric_limits<double>::quiet_NaN();
+};
+
+//}
+
+/* Result //{ */
+
+struct Result
+{
+  bool   detected = false;
+  double stamp    = 0;
+};
+
+//}
+
+/* load() //{ */
+
+bool load(const std::string& path, Recording& recording) {
+
+  std::ifstream file(path);
+
+  if (!file.is_open()) {
+    return false;
+  }
+
+  recording.name = path;
+
+  std::string line;
+
+  while (std::getline(file, line)) {
+
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    for (auto& c : line) {
+      if (c == ',') {
+        c = ' ';
+      }
+    }
+
+    std::stringstream ss(line);
+
+    Sample      sample;
+    std::string type;
+
+    if (!(ss >> sample.stamp >> type)) {
+      continue;
+    }
+
+    if (type == "mass") {
+      sample.type = Sample::MASS;
+      ss >> sample.a;
+    } else if (type == "thrust") {
+      sample.type = Sample::THRUST;
+      ss >> sample.a >> sample.b;
+    } else if (type == "odom") {
+      sample.type = Sample::ODOM;
+      ss >> sample.a >> sample.b;
+    } else if (type == "touchdown") {
+      sample.type         = Sample::TOUCHDOWN;
+      recording.touchdown = sample.stamp;
+    } else {
+      continue;
+    }
+
+    recording.samples.push_back(sample);
+  }
+
+  return !recording.samples.empty();
+}
+
+//}
+
+/* replay() //{ */
+
+// the detector is evaluated at a fixed rate, the same way the managers' timers do it
+Result replay(const Recording& recording, const LandingDetectorParams& params, const double rate) {
+
+  LandingDetector detector(params);
+
+  Result result;
+
+  const double period    = 1.0 / rate;
+  double       next_eval = recording.samples.front().stamp;
+
+  for (auto& sample : recording.samples) {
+
+    while (detector.active() && next_eval <= sample.stamp) {
+
+      if (detector.update(next_eval)) {
+        result.detected = true;
+        result.stamp    = next_eval;
+        return result;
+      }
+
+      next_eval += period;
+    }
+
+    switch (sample.type) {
+
+      case Sample::MASS: {
+        detector.reset(sample.a);
+        next_eval = sample.stamp;
+        break;
+      }
+
+      case Sample::THRUST: {
+        detector.addThrust(sample.stamp, sample.a, sample.b < 0.01);
+        break;
+      }
+
+      case Sample::ODOM: {
+        detector.addOdometry(sample.stamp, sample.a, sample.b);
+        break;
+      }
+
+      case Sample::TOUCHDOWN: {
+        break;
+      }
+    }
+  }
+
+  return result;
+}
+
+//}
+
+/* Stats //{ */
+
+struct Stats
+{
+  int    landings        = 0;
+  int    detected        = 0;
+  int    false_positives = 0;
+  double latency_sum     = 0;
+  double latency_max     = 0;
+
+  void add(const Recording& recording, const Result& result) {
+
+    const bool has_touchdown = !std::isnan(recording.touchdown);
+
+    if (has_touchdown) {
+      landings++;
+    }
+
+    if (!result.detected) {
+      return;
+    }
+
+    if (!has_touchdown || result.stamp < recording.touchdown) {
+      false_positives++;
+      return;
+    }
+
+    const double latency = result.stamp - recording.touchdown;
+
+    detected++;
+    latency_sum += latency;
+    latency_max = std::max(latency_max, latency);
+  }
+
+  void print(const char* name, const int recordings) const {
+
+    printf("%-9s detected %d/%d landings, false positives %d/%d recordings (%.1f %%), latency mean %.2f s, max %.2f s\n", name, detected, landings,
+           false_positives, recordings, recordings > 0 ? 100.0 * false_positives / recordings : 0.0, detected > 0 ? latency_sum / detected : 0.0,
+           latency_max);
+  }
+};
+
+//}
+
+/* main() //{ */
+
+int main(int argc, char** argv) {
+
+  LandingDetectorParams params;
+  double                rate = 10.0;
+
+  std::map<std::string, double*> param_names = {
+      {"--window", &params.window},
+      {"--cutoff_mass_factor", &params.cutoff_mass_factor},
+      {"--cutoff_timeout", &params.cutoff_timeout},
+      {"--max_vertical_speed", &params.max_vertical_speed},
+      {"--max_vertical_acceleration", &params.max_vertical_acceleration},
+      {"--max_height_std", &params.max_height_std},
+      {"--confidence_threshold", &params.confidence_threshold},
+      {"--confidence_duration", &params.confidence_duration},
+      {"--rate", &rate},
+  };
+
+  std::vector<Recording> recordings;
+
+  for (int i = 1; i < argc; i++) {
+
+    auto it = param_names.find(argv[i]);
+
+    if (it != param_names.end()) {
+
+      if (i + 1 >= argc) {
+        fprintf(stderr, "missing the value of %s\n", argv[i]);
+        return 1;
+      }
+
+      *it->second = std::atof(argv[++i]);
+      continue;
+    }
+
+    Recording recording;
+
+    if (!load(argv[i], recording)) {
+      fprintf(stderr, "could not load '%s'\n", argv[i]);
+      return 1;
+    }
+
+    recordings.push_back(recording);
+  }
+
+  if (recordings.empty() || !params.valid() || rate <= 0) {
+    fprintf(stderr, "usage: %s [--rate <Hz>] [--<param> <value>]... <recording.csv>...\n", argv[0]);
+    return 1;
+  }
+
+  // the fallback alone, as the managers used to detect the touchdown
+  LandingDetectorParams fallback_params = params;
+  fallback_params.confidence_threshold  = std::numeric_limits<double>::infinity();
+
+  Stats fused, fallback;
+
+  for (auto& recording : recordings) {
+
+    Result result_fused    = replay(recording, params, rate);
+    Result result_fallback = replay(recording, fallback_params, rate);
+
+    fused.add(recording, result_fused);
+    fallback.add(recording, result_fallback);
+
+    printf("%s: touchdown %.2f, fused %s %.2f, fallback %s %.2f\n", recording.name.c_str(), recording.touchdown, result_fused.detected ? "at" : "none",
+           result_fused.stamp, result_fallback.detected ? "at" : "none", result_fallback.stamp);
+  }
+
+  printf("\n");
+
+  fused.print("fused", int(recordings.size()));
+  fallback.print("fallback", int(recordings.size()));
+
+  return 0;
+}
+
+//}
@@ -0,0 +1,244 @@
+#ifndef MRS_UAV_ARRIVAL_WATCHDOG_H
+#define MRS_UAV_ARRIVAL_WATCHDOG_H
+
+/* includes //{ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <time.h>
+
+//}
+
+namespace mrs_uav_managers
+{
+
+namespace timing
+{
+
+// [ns], CLOCK_MONOTONIC, not affected by the ROS (simulated) time or by the wall clock adjustments
+inline int64_t monotonicNs(void) {
+
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return int64_t(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+/* InterArrivalStats //{ */
+
+// statistics of the time between consecutive messages
+// * the mean and the variance are exponentially weighted, so they follow slow changes of the rate
+// * constant-time and allocation-free, not thread-safe
+class InterArrivalStats {
+
+public:
+  InterArrivalStats(void) = default;
+
+  // smoothing: [-], the weight of a new sample in the mean and the variance
+  explicit InterArrivalStats(const double smoothing) : smoothing_(smoothing) {
+  }
+
+  void add(const int64_t stamp_ns) {
+
+    if (has_last_) {
+
+      const double dt = double(stamp_ns - last_ns_) * 1e-9;
+
+      if (count_ == 0) {
+        mean_     = dt;
+        variance_ = 0;
+        min_      = dt;
+        max_      = dt;
+      } else {
+        const double delta = dt - mean_;
+        mean_ += smoothing_ * delta;
+        variance_ = (1.0 - smoothing_) * (variance_ + smoothing_ * delta * delta);
+        min_      = std::min(min_, dt);
+        max_      = std::max(max_, dt);
+      }
+
+      last_dt_ = dt;
+      count_++;
+    }
+
+    has_last_ = true;
+    last_ns_  = stamp_ns;
+  }
+
+  void reset(void) {
+    *this = InterArrivalStats(smoothing_);
+  }
+
+  // the number of the inter-arrival samples (the number of the messages - 1)
+  uint64_t count(void) const {
+    return count_;
+  }
+
+  bool hasLast(void) const {
+    return has_last_;
+  }
+
+  int64_t lastNs(void) const {
+    return last_ns_;
+  }
+
+  // [s]
+  double mean(void) const {
+    return mean_;
+  }
+
+  // [s]
+  double stddev(void) const {
+    return std::sqrt(variance_);
+  }
+
+  // [s]
+  double min(void) const {
+    return min_;
+  }
+
+  // [s]
+  double max(void) const {
+    return max_;
+  }
+
+  // [s], the last inter-arrival time
+  double last(void) const {
+    return last_dt_;
+  }
+
+  // [Hz]
+  double rate(void) const {
+    return mean_ > 0 ? 1.0 / mean_ : 0.0;
+  }
+
+private:
+  double smoothing_ = 0.05;
+
+  bool     has_last_ = false;
+  int64_t  last_ns_  = 0;
+  uint64_t count_    = 0;
+
+  double mean_     = 0;
+  double variance_ = 0;
+  double min_      = 0;
+  double max_      = 0;
+  double last_dt_  = 0;
+};
+
+//}
+
+/* ArrivalWatchdogParams //{ */
+
+struct ArrivalWatchdogParams
+{
+  double   smoothing        = 0.05;   // [-], see InterArrivalStats
+  uint64_t min_samples      = 20;     // the learned deadline is used after this many samples, initial_deadline before
+  double   initial_deadline = 0.1;    // [s]
+  double   deadline_sigma   = 4.0;    // [-], deadline = mean + deadline_sigma * stddev
+  double   min_deadline     = 0.005;  // [s]
+  double   max_deadline     = 0.1;    // [s], the learned deadline is never shorter than the mean inter-arrival time
+
+  // the escalation ladder, step i is reached after ladder[i] deadlines without a message, has to be increasing
+  std::vector<double> ladder;
+
+  // the last step of the ladder ends the escalation (e.g., eland or failsafe), set by the owner who knows the actions,
+  // required, so the missing messages are never bridged (e.g., extrapolated) without a bound
+  bool ladder_terminal = false;
+
+  bool valid(void) const {
+
+    if (smoothing <= 0 || smoothing > 1 || initial_deadline <= 0 || deadline_sigma < 0 || min_deadline <= 0 || max_deadline < min_deadline) {
+      return false;
+    }
+
+    if (ladder.empty() || !ladder_terminal) {
+      return false;
+    }
+
+    for (size_t i = 0; i < ladder.size(); i++) {
+      if (ladder[i] <= 0 || (i > 0 && ladder[i] <= ladder[i - 1])) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+};
+
+//}
+
+/* ArrivalWatchdog //{ */
+
+// watches the arrivals of a periodic message against a deadline learned from its inter-arrival times
+// * check() returns the escalation level, 0 = ok, i + 1 = the step i of the ladder was reached
+// * nothing is reported before the first message
+// * not thread-safe, the owner serializes the calls
+class ArrivalWatchdog {
+
+public:
+  ArrivalWatchdog(void) = default;
+
+  explicit ArrivalWatchdog(const ArrivalWatchdogParams& params) : params_(params), stats_(params.smoothing) {
+  }
+
+  void arrived(const int64_t now_ns) {
+    stats_.add(now_ns);
+  }
+
+  int check(const int64_t now_ns) const {
+
+    if (!stats_.hasLast()) {
+      return 0;
+    }
+
+    const double missing = sinceLast(now_ns) / deadline();
+
+    int level = 0;
+
+    while (level < int(params_.ladder.size()) && missing > params_.ladder[level]) {
+      level++;
+    }
+
+    return level;
+  }
+
+  // [s]
+  double deadline(void) const {
+
+    if (stats_.count() < params_.min_samples) {
+      return params_.initial_deadline;
+    }
+
+    // a deadline shorter than the period would escalate on every regular gap
+    return std::max(std::clamp(stats_.mean() + params_.deadline_sigma * stats_.stddev(), params_.min_deadline, params_.max_deadline), stats_.mean());
+  }
+
+  // [s], the time since the last message
+  double sinceLast(const int64_t now_ns) const {
+    return stats_.hasLast() ? double(now_ns - stats_.lastNs()) * 1e-9 : 0.0;
+  }
+
+  const InterArrivalStats& stats(void) const {
+    return stats_;
+  }
+
+  void reset(void) {
+    stats_.reset();
+  }
+
+private:
+  ArrivalWatchdogParams params_;
+  InterArrivalStats     stats_;
+};
+
+//}
+
+}  // namespace timing
+
+}  // namespace mrs_uav_managers
+
+#endif  // MRS_UAV_ARRIVAL_WATCHDOG_H
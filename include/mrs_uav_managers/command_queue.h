@@ -0,0 +1,141 @@
+#ifndef MRS_UAV_COMMAND_QUEUE_H
+#define MRS_UAV_COMMAND_QUEUE_H
+
+/* includes //{ */
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+//}
+
+namespace mrs_uav_managers
+{
+
+namespace messaging
+{
+
+/* CommandQueue //{ */
+
+// multiple-producer, single-consumer queue of commands, which are executed by the consumer's thread
+// * post() is lock-free and can be called from any thread, the caller gets a future of the command's result
+// * drain() executes the pending commands in the order of posting, it has to be called by one thread at a time
+// * the queue is the intrusive MPSC list by D. Vyukov, a producer does one atomic exchange, the consumer does not wait for the producers,
+//   a command whose posting is still in progress is picked up by the next drain()
+class CommandQueue {
+
+public:
+  CommandQueue(void) : head_(&stub_), tail_(&stub_) {
+  }
+
+  ~CommandQueue(void) {
+
+    // the pending commands are dropped, their futures get broken_promise
+    Node* node = tail_->next.load(std::memory_order_acquire);
+
+    while (node) {
+      Node* next = node->next.load(std::memory_order_acquire);
+      delete node;
+      node = next;
+    }
+
+    if (tail_ != &stub_) {
+      delete tail_;
+    }
+  }
+
+  CommandQueue(const CommandQueue&) = delete;
+  CommandQueue& operator=(const CommandQueue&) = delete;
+
+  template <typename F>
+  std::future<std::invoke_result_t<F>> post(F&& command) {
+
+    using Result = std::invoke_result_t<F>;
+
+    // std::function needs a copyable target, the task is shared
+    auto task = std::make_shared<std::packaged_task<Result(void)>>(std::forward<F>(command));
+
+    std::future<Result> result = task->get_future();
+
+    Node* node    = new Node;
+    node->command = [task]() { (*task)(); };
+
+    posted_++;
+
+    Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+
+    return result;
+  }
+
+  // returns the number of the executed commands
+  size_t drain(const size_t max_commands = std::numeric_limits<size_t>::max()) {
+
+    size_t executed = 0;
+
+    while (executed < max_commands) {
+
+      Node* next = tail_->next.load(std::memory_order_acquire);
+
+      if (!next) {
+        break;
+      }
+
+      // next becomes the new dummy node, its command is moved out first
+      std::function<void(void)> command = std::move(next->command);
+
+      if (tail_ != &stub_) {
+        delete tail_;
+      }
+
+      tail_ = next;
+
+      command();
+
+      executed++;
+    }
+
+    executed_ += executed;
+
+    return executed;
+  }
+
+  // the commands which were posted, but not executed yet
+  uint64_t pending(void) const {
+    return posted_ - executed_;
+  }
+
+  uint64_t posted(void) const {
+    return posted_;
+  }
+
+  uint64_t executed(void) const {
+    return executed_;
+  }
+
+private:
+  struct Node
+  {
+    std::atomic<Node*>        next = nullptr;
+    std::function<void(void)> command;
+  };
+
+  Node               stub_;
+  std::atomic<Node*> head_;  // the last posted node, written by the producers
+  Node*              tail_;  // the dummy node in front of the next command, owned by the consumer
+
+  std::atomic<uint64_t> posted_   = 0;
+  std::atomic<uint64_t> executed_ = 0;
+};
+
+//}
+
+}  // namespace messaging
+
+}  // namespace mrs_uav_managers
+
+#endif  // MRS_UAV_COMMAND_QUEUE_H
@@ -0,0 +1,42 @@
+#ifndef MRS_UAV_CONTROL_MANAGER_COMMANDS_H
+#define MRS_UAV_CONTROL_MANAGER_COMMANDS_H
+
+/* includes //{ */
+
+#include <mrs_msgs/ReferenceStamped.h>
+
+#include <functional>
+#include <string>
+#include <tuple>
+
+//}
+
+namespace mrs_uav_managers
+{
+
+namespace state_board
+{
+
+/* ControlManagerCommands //{ */
+
+// typed in-process counterparts of the ControlManager services used by the other managers
+// * registered in the StateBoard by the ControlManager, when it runs in the same nodelet manager
+// * each command has the same semantics (including all the checks) as the corresponding service
+// * the commands return (success, message), just like the service response
+struct ControlManagerCommands
+{
+  std::function<std::tuple<bool, std::string>(const std::string& tracker)>             switch_tracker;
+  std::function<std::tuple<bool, std::string>(const std::string& controller)>          switch_controller;
+  std::function<std::tuple<bool, std::string>(const mrs_msgs::ReferenceStamped& goal)> emergency_reference;
+  std::function<std::tuple<bool, std::string>(const bool enable)>                      enable_callbacks;
+  std::function<std::tuple<bool, std::string>(void)>                                   eland;
+  std::function<std::tuple<bool, std::string>(void)>                                   ehover;
+};
+
+//}
+
+}  // namespace state_board
+
+}  // namespace mrs_uav_managers
+
+#endif  // MRS_UAV_CONTROL_MANAGER_COMMANDS_H
@@ -0,0 +1,256 @@
+#ifndef MRS_UAV_DEADLINE_LOOP_H
+#define MRS_UAV_DEADLINE_LOOP_H
+
+/* includes //{ */
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+//}
+
+namespace mrs_uav_managers
+{
+
+namespace timing
+{
+
+/* DeadlineLoopStats //{ */
+
+struct DeadlineLoopStats
+{
+  uint64_t cycles          = 0;
+  uint64_t deadline_misses = 0;  // woken up later than the tolerance after the deadline
+  uint64_t overruns        = 0;  // the callback did not finish before the next deadline, the missed periods were skipped
+  double   last_lateness   = 0;  // [s], wake-up time - deadline of the last cycle
+  double   max_lateness    = 0;  // [s]
+};
+
+//}
+
+/* setRealtimePriority() //{ */
+
+// sets the SCHED_FIFO priority (1-99) of the thread, requires the CAP_SYS_NICE capability, returns false when it could not be set
+inline bool setRealtimePriority(std::thread& thread, const int priority) {
+
+  sched_param param{};
+  param.sched_priority = priority;
+
+  return pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param) == 0;
+}
+
+//}
+
+/* DeadlineClock //{ */
+
+// the time base of a DeadlineLoop
+// * now() returns the time [ns], sleep_until() sleeps until the absolute deadline [ns] or shorter (e.g., when interrupted),
+//   it returns true when the deadline has passed
+// * monotonic() sleeps with clock_nanosleep() until absolute CLOCK_MONOTONIC deadlines, a simulated clock (e.g., ROS time
+//   with use_sim_time) is provided by the owner, its sleep_until() should poll in short wall-time steps, so the loop can be stopped
+struct DeadlineClock
+{
+  std::function<int64_t(void)>       now;
+  std::function<bool(const int64_t)> sleep_until;
+
+  static DeadlineClock monotonic(void) {
+
+    DeadlineClock clock;
+
+    clock.now = []() {
+      timespec t;
+      clock_gettime(CLOCK_MONOTONIC, &t);
+
+      return int64_t(t.tv_sec) * 1000000000 + t.tv_nsec;
+    };
+
+    clock.sleep_until = [](const int64_t deadline) {
+      timespec t;
+      t.tv_sec  = deadline / 1000000000;
+      t.tv_nsec = deadline % 1000000000;
+
+      return clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, nullptr) != EINTR;
+    };
+
+    return clock;
+  }
+};
+
+//}
+
+/* DeadlineLoop //{ */
+
+// calls the callback periodically from a dedicated thread, independently of any ROS callback queue
+// * the thread sleeps until absolute deadlines of the clock (CLOCK_MONOTONIC by default), so the period does not drift
+// * after an overrun, the missed periods are skipped instead of being run in a burst
+// * a stopped loop waits on a condition variable, start() and stop() can be called from any thread, including the callback
+// * optionally runs with the SCHED_FIFO priority, which requires the CAP_SYS_NICE capability
+class DeadlineLoop {
+
+public:
+  DeadlineLoop(std::function<void(void)> callback, const double rate, const double tolerance, const int priority = 0,
+               DeadlineClock clock = DeadlineClock::monotonic())
+      : callback_(std::move(callback)), clock_(std::move(clock)), period_ns_(int64_t(1e9 / rate)), tolerance_ns_(int64_t(tolerance * 1e9)) {
+
+    thread_ = std::thread(&DeadlineLoop::loop, this);
+
+    if (priority > 0) {
+      realtime_ = setRealtimePriority(thread_, priority);
+    }
+  }
+
+  ~DeadlineLoop(void) {
+
+    {
+      std::scoped_lock lock(mutex_);
+
+      shutdown_ = true;
+      running_  = false;
+    }
+
+    cv_.notify_all();
+
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  DeadlineLoop(const DeadlineLoop&) = delete;
+  DeadlineLoop& operator=(const DeadlineLoop&) = delete;
+
+  void start(void) {
+
+    {
+      std::scoped_lock lock(mutex_);
+
+      running_ = true;
+    }
+
+    cv_.notify_all();
+  }
+
+  // does not wait for the current cycle to finish
+  void stop(void) {
+
+    std::scoped_lock lock(mutex_);
+
+    running_ = false;
+  }
+
+  bool running(void) const {
+    return running_;
+  }
+
+  // false when the SCHED_FIFO priority was requested but could not be set
+  bool realtime(void) const {
+    return realtime_;
+  }
+
+  DeadlineLoopStats stats(void) const {
+
+    DeadlineLoopStats stats;
+
+    stats.cycles          = cycles_;
+    stats.deadline_misses = deadline_misses_;
+    stats.overruns        = overruns_;
+    stats.last_lateness   = double(last_lateness_ns_) * 1e-9;
+    stats.max_lateness    = double(max_lateness_ns_) * 1e-9;
+
+    return stats;
+  }
+
+private:
+  void loop(void) {
+
+    int64_t deadline = 0;
+
+    while (true) {
+
+      // wait while stopped, the deadlines are re-anchored to the moment of the start
+      {
+        std::unique_lock lock(mutex_);
+
+        if (!running_) {
+
+          cv_.wait(lock, [this] { return running_ || shutdown_; });
+
+          deadline = clock_.now() + period_ns_;
+        }
+
+        if (shutdown_) {
+          return;
+        }
+      }
+
+      while (!clock_.sleep_until(deadline) && running_) {
+      }
+
+      if (!running_) {
+        continue;
+      }
+
+      const int64_t lateness = clock_.now() - deadline;
+
+      last_lateness_ns_ = lateness;
+
+      if (lateness > max_lateness_ns_) {
+        max_lateness_ns_ = lateness;
+      }
+
+      if (lateness > tolerance_ns_) {
+        deadline_misses_++;
+      }
+
+      callback_();
+
+      cycles_++;
+
+      deadline += period_ns_;
+
+      // skip the periods which already passed
+      const int64_t now = clock_.now();
+
+      if (deadline <= now) {
+
+        overruns_++;
+
+        deadline += ((now - deadline) / period_ns_ + 1) * period_ns_;
+      }
+    }
+  }
+
+  std::function<void(void)> callback_;
+  DeadlineClock             clock_;
+
+  const int64_t period_ns_;
+  const int64_t tolerance_ns_;
+
+  std::thread             thread_;
+  std::mutex              mutex_;
+  std::condition_variable cv_;
+  std::atomic<bool>       running_  = false;
+  bool                    shutdown_ = false;
+  std::atomic<bool>       realtime_ = true;
+
+  std::atomic<uint64_t> cycles_           = 0;
+  std::atomic<uint64_t> deadline_misses_  = 0;
+  std::atomic<uint64_t> overruns_         = 0;
+  std::atomic<int64_t>  last_lateness_ns_ = 0;
+  std::atomic<int64_t>  max_lateness_ns_  = 0;
+};
+
+//}
+
+}  // namespace timing
+
+}  // namespace mrs_uav_managers
+
+#endif  // MRS_UAV_DEADLINE_LOOP_H
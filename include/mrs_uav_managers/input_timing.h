@@ -0,0 +1,240 @@
+#ifndef MRS_UAV_INPUT_TIMING_H
+#define MRS_UAV_INPUT_TIMING_H
+
+/* includes //{ */
+
+#include <mrs_uav_managers/arrival_watchdog.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+//}
+
+namespace mrs_uav_managers
+{
+
+namespace timing
+{
+
+/* LogHistogram //{ */
+
+// histogram of durations with logarithmically spaced bins, for streaming quantiles
+// * the bins span 10 us - 10 s with 16 bins per decade (~15 % resolution), the values outside are clamped to the edge bins
+// * constant memory and constant-time add(), not thread-safe
+class LogHistogram {
+
+public:
+  void add(const double value) {
+
+    int bin = 0;
+
+    if (value > MIN) {
+      bin = std::min(int(std::log10(value / MIN) * BINS_PER_DECADE), BINS - 1);
+    }
+
+    bins_[bin]++;
+    count_++;
+  }
+
+  // [s], the upper edge of the bin containing the quantile q in [0, 1], 0 when empty
+  double quantile(const double q) const {
+
+    if (count_ == 0) {
+      return 0;
+    }
+
+    const uint64_t rank = uint64_t(std::ceil(std::clamp(q, 0.0, 1.0) * double(count_)));
+
+    uint64_t sum = 0;
+
+    for (int i = 0; i < BINS; i++) {
+
+      sum += bins_[i];
+
+      if (sum >= rank && bins_[i] > 0) {
+        return MIN * std::pow(10.0, double(i + 1) / BINS_PER_DECADE);
+      }
+    }
+
+    return MAX;
+  }
+
+  uint64_t count(void) const {
+    return count_;
+  }
+
+  void reset(void) {
+    bins_.fill(0);
+    count_ = 0;
+  }
+
+private:
+  static constexpr double MIN             = 1e-5;  // [s]
+  static constexpr double MAX             = 10.0;  // [s]
+  static constexpr int    BINS_PER_DECADE = 16;
+  static constexpr int    BINS            = 6 * BINS_PER_DECADE;
+
+  std::array<uint64_t, BINS> bins_{};
+  uint64_t                   count_ = 0;
+};
+
+//}
+
+/* DurationStats //{ */
+
+// min/mean/max/p99 of the durations since the last reset, not thread-safe
+// * unlike the time-windowed landing::WindowStats, the window is restarted explicitly by reset()
+class DurationStats {
+
+public:
+  void add(const double value) {
+
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+    sum_ += value;
+
+    histogram_.add(value);
+  }
+
+  uint64_t count(void) const {
+    return histogram_.count();
+  }
+
+  double min(void) const {
+    return count() > 0 ? min_ : 0.0;
+  }
+
+  double max(void) const {
+    return count() > 0 ? max_ : 0.0;
+  }
+
+  double mean(void) const {
+    return count() > 0 ? sum_ / double(count()) : 0.0;
+  }
+
+  // the histogram gives the upper edge of the bin, it is bounded by the largest sample
+  double p99(void) const {
+    return std::min(histogram_.quantile(0.99), max());
+  }
+
+  void reset(void) {
+    *this = DurationStats();
+  }
+
+private:
+  double       min_ = std::numeric_limits<double>::infinity();
+  double       max_ = -std::numeric_limits<double>::infinity();
+  double       sum_ = 0;
+  LogHistogram histogram_;
+};
+
+//}
+
+/* InputTiming //{ */
+
+// timing of a subscribed input, the inter-arrival time of the messages and their age (the arrival time - the header stamp)
+// * the rate and the jitter are exponentially weighted (InterArrivalStats), min/mean/max/p99 are taken over a window,
+//   which is restarted by the snapshot() of the reporter
+// * thread-safe, the arrivals and the snapshots can come from different threads
+class InputTiming {
+
+public:
+  struct Snapshot
+  {
+    uint64_t messages = 0;  // since the start
+    double   rate     = 0;  // [Hz]
+    double   jitter   = 0;  // [s], the standard deviation of the inter-arrival time
+    double   since    = 0;  // [s], the time since the last message
+
+    // over the window
+    uint64_t window_messages = 0;
+    double   interval_min    = 0;  // [s]
+    double   interval_mean   = 0;  // [s]
+    double   interval_max    = 0;  // [s]
+    double   interval_p99    = 0;  // [s]
+    double   age_mean        = 0;  // [s]
+    double   age_max         = 0;  // [s]
+    double   age_p99         = 0;  // [s]
+  };
+
+  explicit InputTiming(const double smoothing = 0.05) : stats_(smoothing) {
+  }
+
+  // age: [s], a negative or NaN age (e.g., an unstamped message) is not counted
+  void arrived(const int64_t now_ns, const double age) {
+
+    std::scoped_lock lock(mutex_);
+
+    if (stats_.hasLast()) {
+      intervals_.add(double(now_ns - stats_.lastNs()) * 1e-9);
+    }
+
+    stats_.add(now_ns);
+
+    if (age >= 0) {
+      ages_.add(age);
+    }
+
+    messages_++;
+  }
+
+  Snapshot snapshot(const int64_t now_ns, const bool restart_window) {
+
+    std::scoped_lock lock(mutex_);
+
+    Snapshot snapshot;
+
+    snapshot.messages = messages_;
+    snapshot.rate     = stats_.rate();
+    snapshot.jitter   = stats_.stddev();
+    snapshot.since    = stats_.hasLast() ? double(now_ns - stats_.lastNs()) * 1e-9 : 0.0;
+
+    snapshot.window_messages = intervals_.count();
+    snapshot.interval_min    = intervals_.min();
+    snapshot.interval_mean   = intervals_.mean();
+    snapshot.interval_max    = intervals_.max();
+    snapshot.interval_p99    = intervals_.p99();
+    snapshot.age_mean        = ages_.mean();
+    snapshot.age_max         = ages_.max();
+    snapshot.age_p99         = ages_.p99();
+
+    if (restart_window) {
+      intervals_.reset();
+      ages_.reset();
+    }
+
+    return snapshot;
+  }
+
+  // the last inter-arrival time relative to the smoothed mean, 0 before the statistics settle
+  double lastIntervalRatio(const uint64_t min_samples) {
+
+    std::scoped_lock lock(mutex_);
+
+    if (stats_.count() < min_samples || stats_.mean() <= 0) {
+      return 0;
+    }
+
+    return stats_.last() / stats_.mean();
+  }
+
+private:
+  std::mutex mutex_;
+
+  InterArrivalStats stats_;
+  DurationStats     intervals_;
+  DurationStats     ages_;
+  uint64_t          messages_ = 0;
+};
+
+//}
+
+}  // namespace timing
+
+}  // namespace mrs_uav_managers
+
+#endif  // MRS_UAV_INPUT_TIMING_H
@@ -0,0 +1,359 @@
+#ifndef MRS_UAV_LANDING_DETECTOR_H
+#define MRS_UAV_LANDING_DETECTOR_H
+
+/* includes //{ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+//}
+
+namespace mrs_uav_managers
+{
+
+namespace landing
+{
+
+/* WindowStats //{ */
+
+// mean and variance of the samples from the last "window" seconds
+// * the buffer is allocated once, adding a sample is amortized O(1) and allocation-free
+// * samples are evicted when they fall out of the window or when the buffer is full
+// * the statistics are maintained incrementally (Welford's update and downdate)
+class WindowStats {
+
+public:
+  WindowStats(void) = default;
+
+  WindowStats(const double window, const size_t capacity) : window_(window), stamps_(capacity), values_(capacity) {
+  }
+
+  void add(const double stamp, const double value) {
+
+    if (stamps_.empty()) {
+      return;
+    }
+
+    while (count_ > 0 && (count_ == stamps_.size() || stamps_[head_] < stamp - window_)) {
+      evict();
+    }
+
+    const size_t tail = (head_ + count_) % stamps_.size();
+
+    stamps_[tail] = stamp;
+    values_[tail] = value;
+    count_++;
+
+    const double delta = value - mean_;
+    mean_ += delta / double(count_);
+    m2_ += delta * (value - mean_);
+  }
+
+  // drops the samples older than the window, without adding a new one
+  void update(const double now) {
+
+    while (count_ > 0 && stamps_[head_] < now - window_) {
+      evict();
+    }
+  }
+
+  void clear(void) {
+    head_  = 0;
+    count_ = 0;
+    mean_  = 0;
+    m2_    = 0;
+  }
+
+  size_t count(void) const {
+    return count_;
+  }
+
+  double mean(void) const {
+    return mean_;
+  }
+
+  double variance(void) const {
+    return count_ > 1 ? std::max(m2_ / double(count_ - 1), 0.0) : 0.0;
+  }
+
+  double stddev(void) const {
+    return std::sqrt(variance());
+  }
+
+  // [s], time span between the oldest and the newest sample
+  double span(void) const {
+
+    if (count_ == 0) {
+      return 0;
+    }
+
+    return stamps_[(head_ + count_ - 1) % stamps_.size()] - stamps_[head_];
+  }
+
+  double window(void) const {
+    return window_;
+  }
+
+private:
+  void evict(void) {
+
+    const double value = values_[head_];
+
+    head_ = (head_ + 1) % stamps_.size();
+    count_--;
+
+    if (count_ == 0) {
+      mean_ = 0;
+      m2_   = 0;
+      return;
+    }
+
+    const double mean_old = mean_;
+    mean_ -= (value - mean_) / double(count_);
+    m2_ -= (value - mean_old) * (value - mean_);
+  }
+
+  double              window_ = 0;
+  std::vector<double> stamps_;
+  std::vector<double> values_;
+
+  size_t head_  = 0;
+  size_t count_ = 0;
+  double mean_  = 0;
+  double m2_    = 0;
+};
+
+//}
+
+/* LandingDetectorParams //{ */
+
+// shared by the UavManager (landing) and the ControlManager (eland, failsafe),
+// loaded from config/default/landing_detector.yaml by loadParams()
+struct LandingDetectorParams
+{
+  double window   = 0.5;  // [s], length of the sliding window
+  size_t capacity = 256;  // max number of samples in each window
+
+  // fallback, the thrust alone has to stay below the cutoff for this long
+  double cutoff_mass_factor = 0.5;  // [-], the UAV appears this much lighter on the ground
+  double cutoff_timeout     = 2.0;  // [s]
+
+  // fused detection
+  double max_vertical_speed            = 0.2;   // [m/s], the mean + std of the vertical speed has to be below this
+  double max_vertical_acceleration     = 0.5;   // [m/s^2], mean over the window, has to be below this
+  double max_height_std                = 0.05;  // [m]
+  double confidence_threshold          = 0.8;   // [-]
+  double confidence_duration           = 0.3;   // [s], how long the confidence has to stay above the threshold
+
+  bool valid(void) const {
+    return window > 0 && capacity > 0 && cutoff_timeout >= 0 && max_vertical_speed > 0 && max_vertical_acceleration > 0 && max_height_std > 0;
+  }
+};
+
+// works with mrs_lib::ParamLoader, templated to keep this header free of ROS
+template <typename ParamLoader>
+void loadParams(ParamLoader& param_loader, LandingDetectorParams& params) {
+
+  param_loader.loadParam("landing_detector/cutoff_mass_factor", params.cutoff_mass_factor);
+  param_loader.loadParam("landing_detector/cutoff_timeout", params.cutoff_timeout);
+  param_loader.loadParam("landing_detector/window", params.window);
+  param_loader.loadParam("landing_detector/max_vertical_speed", params.max_vertical_speed);
+  param_loader.loadParam("landing_detector/max_vertical_acceleration", params.max_vertical_acceleration);
+  param_loader.loadParam("landing_detector/max_height_std", params.max_height_std);
+  param_loader.loadParam("landing_detector/confidence_threshold", params.confidence_threshold);
+  param_loader.loadParam("landing_detector/confidence_duration", params.confidence_duration);
+}
+
+//}
+
+/* LandingDetector //{ */
+
+// streaming touchdown detector
+// * fuses the thrust-based mass estimate with the vertical velocity, acceleration and height from the odometry
+// * the thrust cue is mandatory (hovering still has to never look like a touchdown), the motion cues scale it
+// * without odometry samples (e.g., during failsafe), only the thrust-based fallback can trigger
+// * not thread-safe, the owner serializes the calls
+class LandingDetector {
+
+public:
+  LandingDetector(void) = default;
+
+  explicit LandingDetector(const LandingDetectorParams& params)
+      : params_(params),
+        mass_ratio_(params.window, params.capacity),
+        vertical_speed_(params.window, params.capacity),
+        vertical_acceleration_(params.window, params.capacity),
+        height_(params.window, params.capacity) {
+  }
+
+  // starts a new detection, the expected mass is the mass of the UAV in the air [kg]
+  void reset(const double expected_mass) {
+
+    expected_mass_ = expected_mass;
+
+    mass_ratio_.clear();
+    vertical_speed_.clear();
+    vertical_acceleration_.clear();
+    height_.clear();
+
+    has_last_velocity_ = false;
+    under_cutoff_      = false;
+    above_threshold_   = false;
+    confidence_        = 0;
+    active_            = true;
+  }
+
+  void stop(void) {
+    active_ = false;
+  }
+
+  bool active(void) const {
+    return active_;
+  }
+
+  // the mass estimated from the desired thrust [kg]
+  void addThrust(const double stamp, const double mass_estimate, const bool thrust_zero) {
+
+    if (!active_ || expected_mass_ <= 0) {
+      return;
+    }
+
+    const double ratio = thrust_zero ? 0.0 : mass_estimate / expected_mass_;
+
+    mass_ratio_.add(stamp, ratio);
+
+    // the fallback reacts to the instantaneous value, as it always did
+    if (ratio < params_.cutoff_mass_factor) {
+
+      if (!under_cutoff_) {
+        under_cutoff_since_ = stamp;
+        under_cutoff_       = true;
+      }
+
+    } else {
+
+      under_cutoff_ = false;
+    }
+  }
+
+  // height [m] and vertical velocity [m/s] from the odometry
+  void addOdometry(const double stamp, const double height, const double vertical_speed) {
+
+    if (!active_) {
+      return;
+    }
+
+    height_.add(stamp, height);
+    vertical_speed_.add(stamp, vertical_speed);
+
+    if (has_last_velocity_ && stamp > last_velocity_stamp_) {
+      vertical_acceleration_.add(stamp, (vertical_speed - last_velocity_) / (stamp - last_velocity_stamp_));
+    }
+
+    has_last_velocity_   = true;
+    last_velocity_       = vertical_speed;
+    last_velocity_stamp_ = stamp;
+  }
+
+  // re-evaluates the confidence, returns true when the touchdown is detected
+  bool update(const double now) {
+
+    if (!active_) {
+      return false;
+    }
+
+    mass_ratio_.update(now);
+    vertical_speed_.update(now);
+    vertical_acceleration_.update(now);
+    height_.update(now);
+
+    confidence_ = computeConfidence();
+
+    if (confidence_ >= params_.confidence_threshold) {
+
+      if (!above_threshold_) {
+        above_threshold_since_ = now;
+        above_threshold_       = true;
+      }
+
+    } else {
+
+      above_threshold_ = false;
+    }
+
+    const bool fused    = above_threshold_ && (now - above_threshold_since_) >= params_.confidence_duration;
+    const bool fallback = under_cutoff_ && (now - under_cutoff_since_) > params_.cutoff_timeout;
+
+    return fused || fallback;
+  }
+
+  // [-], 0 = flying, 1 = certainly on the ground
+  double confidence(void) const {
+    return confidence_;
+  }
+
+  // [s], how long the thrust has been below the cutoff, 0 if it is not
+  double timeUnderCutoff(const double now) const {
+    return under_cutoff_ ? now - under_cutoff_since_ : 0.0;
+  }
+
+  double massRatio(void) const {
+    return mass_ratio_.mean();
+  }
+
+private:
+  static double ramp(const double x) {
+    return std::clamp(x, 0.0, 1.0);
+  }
+
+  double computeConfidence(void) const {
+
+    if (mass_ratio_.count() == 0 || vertical_speed_.count() < 2 || vertical_acceleration_.count() < 2) {
+      return 0;
+    }
+
+    // 0 when the thrust carries the whole UAV, 1 when the UAV appears lighter than the cutoff factor
+    const double thrust = ramp((1.0 - mass_ratio_.mean()) / std::max(1.0 - params_.cutoff_mass_factor, 1e-3));
+
+    const double speed        = ramp(1.0 - (std::fabs(vertical_speed_.mean()) + vertical_speed_.stddev()) / params_.max_vertical_speed);
+    const double acceleration = ramp(1.0 - std::fabs(vertical_acceleration_.mean()) / params_.max_vertical_acceleration);
+    const double height       = ramp(1.0 - height_.stddev() / params_.max_height_std);
+
+    // a partially filled window does not give the full confidence
+    const double coverage = ramp(std::min(mass_ratio_.span(), vertical_speed_.span()) / params_.window);
+
+    return thrust * ((speed + acceleration + height) / 3.0) * coverage;
+  }
+
+  LandingDetectorParams params_;
+
+  WindowStats mass_ratio_;
+  WindowStats vertical_speed_;
+  WindowStats vertical_acceleration_;
+  WindowStats height_;
+
+  double expected_mass_ = 0;
+  bool   active_        = false;
+
+  bool   has_last_velocity_   = false;
+  double last_velocity_       = 0;
+  double last_velocity_stamp_ = 0;
+
+  bool   under_cutoff_       = false;
+  double under_cutoff_since_ = 0;
+
+  bool   above_threshold_       = false;
+  double above_threshold_since_ = 0;
+
+  double confidence_ = 0;
+};
+
+//}
+
+}  // namespace landing
+
+}  // namespace mrs_uav_managers
+
+#endif  // MRS_UAV_LANDING_DETECTOR_H
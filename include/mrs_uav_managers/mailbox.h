@@ -0,0 +1,99 @@
+#ifndef MRS_UAV_MAILBOX_H
+#define MRS_UAV_MAILBOX_H
+
+/* includes //{ */
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+//}
+
+namespace mrs_uav_managers
+{
+
+namespace messaging
+{
+
+/* Mailbox //{ */
+
+// single-slot, latest-wins mailbox
+// * post() replaces the pending value, the replaced one is counted as coalesced and never delivered
+// * take() moves the pending value out, so each value is delivered at most once
+// * thread-safe, the critical sections only move the value
+template <typename T>
+class Mailbox {
+
+public:
+  // returns true if a pending value was replaced
+  bool post(T value) {
+
+    bool replaced;
+
+    {
+      std::scoped_lock lock(mutex_);
+
+      replaced = full_;
+      value_   = std::move(value);
+      full_    = true;
+    }
+
+    posted_++;
+
+    if (replaced) {
+      coalesced_++;
+    }
+
+    return replaced;
+  }
+
+  // returns false if nothing is pending
+  bool take(T& value) {
+
+    {
+      std::scoped_lock lock(mutex_);
+
+      if (!full_) {
+        return false;
+      }
+
+      value  = std::move(value_);
+      value_ = T();
+      full_  = false;
+    }
+
+    delivered_++;
+
+    return true;
+  }
+
+  uint64_t posted(void) const {
+    return posted_;
+  }
+
+  uint64_t coalesced(void) const {
+    return coalesced_;
+  }
+
+  uint64_t delivered(void) const {
+    return delivered_;
+  }
+
+private:
+  std::mutex mutex_;
+  T          value_{};
+  bool       full_ = false;
+
+  std::atomic<uint64_t> posted_    = 0;
+  std::atomic<uint64_t> coalesced_ = 0;
+  std::atomic<uint64_t> delivered_ = 0;
+};
+
+//}
+
+}  // namespace messaging
+
+}  // namespace mrs_uav_managers
+
+#endif  // MRS_UAV_MAILBOX_H
@@ -0,0 +1,104 @@
+#ifndef MRS_UAV_MESSAGE_POOL_H
+#define MRS_UAV_MESSAGE_POOL_H
+
+/* includes //{ */
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+//}
+
+namespace mrs_uav_managers
+{
+
+namespace messaging
+{
+
+/* MessagePool //{ */
+
+// recycles the messages published as shared pointers
+// * a published message is shared with the intra-process subscribers (no serialization, no copy), so it can not be modified afterwards,
+//   the pool hands it out again only when nobody else holds it (use_count() == 1, followed by an acquire fence)
+// * when all the messages are still held, a new one is allocated and replaces the oldest slot, the holders keep the old one
+// * Ptr is the message's shared pointer type, e.g., nav_msgs::Odometry::Ptr
+// * thread-safe
+template <typename Ptr>
+class MessagePool {
+
+public:
+  using Message = typename Ptr::element_type;
+
+  explicit MessagePool(const size_t size = 4) {
+
+    slots_.reserve(size);
+
+    for (size_t i = 0; i < size; i++) {
+      slots_.push_back(Ptr(new Message()));
+    }
+
+    allocations_ = size;
+  }
+
+  // returns a default-valued message, which is owned by the caller (and the pool) until it is published
+  Ptr acquire(void) {
+
+    std::scoped_lock lock(mutex_);
+
+    for (size_t i = 0; i < slots_.size(); i++) {
+
+      Ptr& slot = slots_[next_];
+
+      next_ = (next_ + 1) % slots_.size();
+
+      if (slot.use_count() == 1) {
+
+        // use_count() is a relaxed load, the fence orders it after the last holder's (release) decrement,
+        // so its reads of the message happen before we overwrite it
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        *slot = Message();
+
+        reuses_++;
+
+        return slot;
+      }
+    }
+
+    // all the messages are held by the subscribers
+    Ptr& slot = slots_[next_];
+
+    next_ = (next_ + 1) % slots_.size();
+
+    slot = Ptr(new Message());
+
+    allocations_++;
+
+    return slot;
+  }
+
+  uint64_t reuses(void) const {
+    return reuses_;
+  }
+
+  uint64_t allocations(void) const {
+    return allocations_;
+  }
+
+private:
+  std::mutex       mutex_;
+  std::vector<Ptr> slots_;
+  size_t           next_ = 0;
+
+  std::atomic<uint64_t> reuses_      = 0;
+  std::atomic<uint64_t> allocations_ = 0;
+};
+
+//}
+
+}  // namespace messaging
+
+}  // namespace mrs_uav_managers
+
+#endif  // MRS_UAV_MESSAGE_POOL_H
@@ -0,0 +1,115 @@
+#ifndef MRS_UAV_SAFETY_EVALUATOR_H
+#define MRS_UAV_SAFETY_EVALUATOR_H
+
+/* includes //{ */
+
+#include <cmath>
+#include <cstdint>
+
+//}
+
+namespace mrs_uav_managers
+{
+
+namespace safety
+{
+
+/* SafetyThresholds //{ */
+
+// per-controller thresholds, precomputed once and never modified afterwards
+struct SafetyThresholds
+{
+  double eland;                // [m], control error for triggering eland
+  double failsafe;             // [m], control error for triggering failsafe
+  double odometry_innovation;  // [m], innovation size for triggering eland
+};
+
+//}
+
+/* SafetyLimits //{ */
+
+// controller-independent limits, loaded from the config
+struct SafetyLimits
+{
+  bool   tilt_limit_eland_enabled  = false;
+  double tilt_limit_eland          = 0;  // [rad]
+  bool   tilt_limit_disarm_enabled = false;
+  double tilt_limit_disarm         = 0;  // [rad]
+  bool   yaw_error_eland_enabled   = false;
+  double yaw_error_eland           = 0;  // [rad]
+  bool   odometry_innovation_check = false;
+};
+
+//}
+
+/* SafetyInput //{ */
+
+// quantities measured by the ControlManager in a single safety check
+struct SafetyInput
+{
+  double control_error      = 0;  // [m]
+  double tilt_angle         = 0;  // [rad]
+  double yaw_error          = 0;  // [rad]
+  double innovation         = 0;  // [m]
+  double innovation_heading = 0;  // [rad], heading difference of the innovation from 0
+  double time_since_switch  = 0;  // [s], time since the last controller/tracker switch
+  bool   failsafe_triggered = false;
+  bool   eland_triggered    = false;
+};
+
+//}
+
+/* SafetyAction //{ */
+
+// bit flags of the actions requested by the evaluator, a single check can request several of them
+enum SafetyAction : uint32_t
+{
+  ACTION_NONE             = 0,
+  ACTION_FAILSAFE         = 1u << 0,
+  ACTION_ELAND_INNOVATION = 1u << 1,
+  ACTION_ELAND_TILT       = 1u << 2,
+  ACTION_UNGRIP_POSITION  = 1u << 3,
+  ACTION_ELAND_POSITION   = 1u << 4,
+  ACTION_UNGRIP_YAW       = 1u << 5,
+  ACTION_ELAND_YAW        = 1u << 6,
+  ACTION_DISARM_TILT      = 1u << 7,
+};
+
+//}
+
+/* evaluate() //{ */
+
+// pure, allocation-free evaluation of the safety conditions
+// * all the conditions are computed unconditionally and combined with bit operations
+// * actions are suppressed for 1 s after a controller/tracker switch, disarming on a large tilt is not
+// * eland actions are suppressed when failsafe or eland is already running, failsafe only when failsafe is running
+inline uint32_t evaluate(const SafetyThresholds& thresholds, const SafetyLimits& limits, const SafetyInput& in) {
+
+  const uint32_t settled     = in.time_since_switch > 1.0;
+  const uint32_t can_eland   = settled & !in.failsafe_triggered & !in.eland_triggered;
+  const uint32_t can_fsafe   = settled & !in.failsafe_triggered;
+  const uint32_t yaw_enabled = limits.yaw_error_eland_enabled;
+
+  const uint32_t innovation_bad = limits.odometry_innovation_check & ((in.innovation > thresholds.odometry_innovation) | (in.innovation_heading > M_PI_2));
+
+  uint32_t actions = ACTION_NONE;
+
+  actions |= (can_fsafe & (in.control_error > thresholds.failsafe)) * ACTION_FAILSAFE;
+  actions |= (can_eland & innovation_bad) * ACTION_ELAND_INNOVATION;
+  actions |= (can_eland & limits.tilt_limit_eland_enabled & (in.tilt_angle > limits.tilt_limit_eland)) * ACTION_ELAND_TILT;
+  actions |= (can_eland & (in.control_error > thresholds.eland / 2.0)) * ACTION_UNGRIP_POSITION;
+  actions |= (can_eland & (in.control_error > thresholds.eland)) * ACTION_ELAND_POSITION;
+  actions |= (can_eland & yaw_enabled & (in.yaw_error > limits.yaw_error_eland / 2.0)) * ACTION_UNGRIP_YAW;
+  actions |= (can_eland & yaw_enabled & (in.yaw_error > limits.yaw_error_eland)) * ACTION_ELAND_YAW;
+  actions |= (limits.tilt_limit_disarm_enabled & (in.tilt_angle > limits.tilt_limit_disarm)) * ACTION_DISARM_TILT;
+
+  return actions;
+}
+
+//}
+
+}  // namespace safety
+
+}  // namespace mrs_uav_managers
+
+#endif  // MRS_UAV_SAFETY_EVALUATOR_H
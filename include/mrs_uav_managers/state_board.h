@@ -0,0 +1,359 @@
+#ifndef MRS_UAV_STATE_BOARD_H
+#define MRS_UAV_STATE_BOARD_H
+
+/* includes //{ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+//}
+
+namespace mrs_uav_managers
+{
+
+namespace state_board
+{
+
+struct ControlManagerCommands;  // control_manager_commands.h
+
+/* SeqLock //{ */
+
+// single-writer, multiple-reader slot for trivially copyable data
+// * the writer never blocks, readers retry when they overlap with a write
+// * the payload is stored in atomic words, so concurrent access is race-free
+template <typename T>
+class SeqLock {
+
+  static_assert(std::is_trivially_copyable<T>::value, "the SeqLock payload has to be trivially copyable");
+
+public:
+  // has to be called from a single thread (the owner of the slot)
+  void store(const T& value) {
+
+    std::array<uint64_t, N> words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+
+    const uint64_t seq = seq_.load(std::memory_order_relaxed);
+
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < N; i++) {
+      data_[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // returns the version of the loaded data, 0 = nothing was stored yet
+  uint64_t load(T& value) const {
+
+    std::array<uint64_t, N> words;
+    uint64_t                seq_before, seq_after;
+
+    do {
+
+      seq_before = seq_.load(std::memory_order_acquire);
+
+      for (size_t i = 0; i < N; i++) {
+        words[i] = data_[i].load(std::memory_order_relaxed);
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      seq_after = seq_.load(std::memory_order_relaxed);
+
+    } while ((seq_before & 1) || seq_before != seq_after);
+
+    std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+
+    return seq_before / 2;
+  }
+
+  uint64_t version(void) const {
+    return seq_.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  static constexpr size_t N = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  std::atomic<uint64_t>                seq_{0};
+  std::array<std::atomic<uint64_t>, N> data_{};
+};
+
+//}
+
+/* NameRegistry //{ */
+
+// interns tracker/controller/estimator names to small integer IDs
+// * interning is meant for initialization and for rare events, the IDs are then compared on the hot paths
+// * the IDs are stable for the lifetime of the process and shared by all the managers
+class NameRegistry {
+
+public:
+  static constexpr int INVALID_ID = -1;
+
+  int intern(const std::string& name) {
+
+    std::scoped_lock lock(mutex_);
+
+    auto it = ids_.find(name);
+
+    if (it != ids_.end()) {
+      return it->second;
+    }
+
+    int id = int(names_.size());
+
+    names_.push_back(name);
+    ids_.insert({name, id});
+
+    return id;
+  }
+
+  int find(const std::string& name) const {
+
+    std::scoped_lock lock(mutex_);
+
+    auto it = ids_.find(name);
+
+    return it == ids_.end() ? INVALID_ID : it->second;
+  }
+
+  std::string name(const int id) const {
+
+    std::scoped_lock lock(mutex_);
+
+    if (id < 0 || id >= int(names_.size())) {
+      return "";
+    }
+
+    return names_[id];
+  }
+
+private:
+  mutable std::mutex                   mutex_;
+  std::vector<std::string>             names_;
+  std::unordered_map<std::string, int> ids_;
+};
+
+//}
+
+/* InternCache //{ */
+
+// the ID of a name which is read repeatedly (e.g., from a topic), the name is interned only when it changes
+// * thread-safe, the cached name and its ID are swapped atomically
+class InternCache {
+
+public:
+  int get(NameRegistry& registry, const std::string& name) {
+
+    std::shared_ptr<const Entry> entry = std::atomic_load(&entry_);
+
+    if (entry->name != name) {
+
+      auto interned  = std::make_shared<Entry>();
+      interned->name = name;
+      interned->id   = registry.intern(name);
+
+      entry = interned;
+      std::atomic_store(&entry_, entry);
+    }
+
+    return entry->id;
+  }
+
+private:
+  struct Entry
+  {
+    std::string name;
+    int         id = NameRegistry::INVALID_ID;
+  };
+
+  // starts with an empty name, which is never interned
+  std::shared_ptr<const Entry> entry_ = std::make_shared<const Entry>();
+};
+
+//}
+
+/* ControlManagerState //{ */
+
+// mirrors the relevant part of the ControlManager diagnostics
+struct ControlManagerState
+{
+  double stamp = 0;  // [s], ROS time of the update
+
+  int active_tracker    = NameRegistry::INVALID_ID;
+  int active_controller = NameRegistry::INVALID_ID;
+
+  // the horizontal estimator from the UAV state, INVALID_ID when the ControlManager runs from plain odometry
+  int estimator      = NameRegistry::INVALID_ID;
+  int estimator_type = -1;
+
+  bool motors             = false;
+  bool rc_mode            = false;
+  bool flying_normally    = false;
+  bool tracker_active     = false;
+  bool have_goal          = false;
+  bool controller_active  = false;
+  bool eland_triggered    = false;
+  bool failsafe_triggered = false;
+
+  double speed  = 0;  // [m/s], horizontal speed of the UAV
+  double height = 0;  // [m], z of the UAV in the current frame
+
+  double mass_nominal    = 0;  // [kg], the configured mass of the UAV
+  double mass_estimate   = 0;  // [kg], the nominal mass + the mass difference estimated by the controller
+  double thrust_headroom = 0;  // [-], 1 - (the hover thrust force / the maximum thrust force)
+};
+
+//}
+
+/* ControllerGains //{ */
+
+// gains of the Se3Controller, passed from the GainManager to the controller
+// * values always holds the complete set, changed marks the gains that differ from the previous version
+// * the names match the dynamic_reconfigure parameters of the controller
+struct ControllerGains
+{
+  enum Gain : uint8_t
+  {
+    KPXY = 0,
+    KVXY,
+    KAXY,
+    KQXY,
+    KIBXY,
+    KIWXY,
+    KIBXY_LIM,
+    KIWXY_LIM,
+    KPZ,
+    KVZ,
+    KAZ,
+    KQZ,
+    KM,
+    KM_LIM,
+    COUNT
+  };
+
+  static constexpr std::array<const char*, COUNT> names = {"kpxy", "kvxy", "kaxy", "kqxy", "kibxy", "kiwxy", "kibxy_lim",
+                                                           "kiwxy_lim", "kpz", "kvz", "kaz", "kqz", "km", "km_lim"};
+
+  std::array<double, COUNT> values{};
+  uint32_t                  changed = 0;  // bit (1 << Gain)
+
+  // bit mask of the gains which differ from the other set
+  uint32_t diff(const ControllerGains& other) const {
+
+    uint32_t mask = 0;
+
+    for (int i = 0; i < COUNT; i++) {
+      if (values[i] != other.values[i]) {
+        mask |= 1u << i;
+      }
+    }
+
+    return mask;
+  }
+
+  // the largest change of a gain relative to its value in the other set
+  double maxRelativeDiff(const ControllerGains& other) const {
+
+    double max_diff = 0;
+
+    for (int i = 0; i < COUNT; i++) {
+      max_diff = std::max(max_diff, std::fabs(values[i] - other.values[i]) / std::max(std::fabs(other.values[i]), 1e-6));
+    }
+
+    return max_diff;
+  }
+
+  // linear interpolation, alpha = 0 -> from, alpha = 1 -> to
+  static ControllerGains interpolate(const ControllerGains& from, const ControllerGains& to, const double alpha) {
+
+    ControllerGains result;
+
+    for (int i = 0; i < COUNT; i++) {
+      result.values[i] = (1.0 - alpha) * from.values[i] + alpha * to.values[i];
+    }
+
+    return result;
+  }
+};
+
+//}
+
+/* StateBoard //{ */
+
+// in-process state shared by the managers loaded in the same nodelet manager
+// * obtained with getStateBoard(), one board per UAV namespace
+// * each slot has exactly one writer (the owning manager)
+class StateBoard {
+
+public:
+  NameRegistry names;
+
+  SeqLock<ControlManagerState> control_manager;
+
+  // returns false if nothing was written yet or the data are older than max_age [s]
+  bool getControlManagerState(ControlManagerState& state, const double now, const double max_age) const {
+
+    if (control_manager.load(state) == 0) {
+      return false;
+    }
+
+    return (now - state.stamp) <= max_age;
+  }
+
+  // the in-process command interface of the ControlManager, nullptr if it does not run in this process
+  void setControlManagerCommands(const std::shared_ptr<const ControlManagerCommands>& commands) {
+    std::atomic_store(&control_manager_commands_, commands);
+  }
+
+  std::shared_ptr<const ControlManagerCommands> getControlManagerCommands(void) const {
+    return std::atomic_load(&control_manager_commands_);
+  }
+
+  // | -------------------- controller gains -------------------- |
+
+  // written by the GainManager, the controller polls version() in its update() and loads the new set
+  SeqLock<ControllerGains> controller_gains;
+
+  // the controller attaches when it reads the gains from the board, the GainManager (with state_board/gains_channel) then skips dynamic_reconfigure
+  // * TODO: the consumer side is not implemented by the controllers yet
+  void attachGainsConsumer(void) {
+    gains_consumers_++;
+  }
+
+  void detachGainsConsumer(void) {
+    gains_consumers_--;
+  }
+
+  bool hasGainsConsumer(void) const {
+    return gains_consumers_.load() > 0;
+  }
+
+private:
+  std::shared_ptr<const ControlManagerCommands> control_manager_commands_;
+
+  std::atomic<int> gains_consumers_{0};
+};
+
+// the board lives in a separate shared library, so all the nodelets in the process get the same instance
+StateBoard& getStateBoard(const std::string& uav_namespace);
+
+//}
+
+}  // namespace state_board
+
+}  // namespace mrs_uav_managers
+
+#endif  // MRS_UAV_STATE_BOARD_H
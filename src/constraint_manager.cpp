@@ -23,10 +23,16 @@
 #include <mrs_lib/service_client_handler.h>
 #include <mrs_lib/subscribe_handler.h>
 
+#include <mrs_uav_managers/state_board.h>
+
 #include <dynamic_reconfigure/ReconfigureRequest.h>
 #include <dynamic_reconfigure/Reconfigure.h>
 #include <dynamic_reconfigure/Config.h>
 
+#include <algorithm>
+#include <bitset>
+#include <unordered_map>
+
 //}
 
 namespace mrs_uav_managers
@@ -37,6 +43,11 @@ namespace constraint_manager
 
 /* //{ class ConstraintManager */
 
+// the constraints allowed for an estimator, indexed by the constraint ID
+const int MAX_CONSTRAINTS = 64;
+
+typedef std::bitset<MAX_CONSTRAINTS> ConstraintSet_t;
+
 class ConstraintManager : public nodelet::Nodelet {
 
 public:
@@ -51,11 +62,21 @@ private:
 
   std::vector<std::string> _estimator_type_names_;
 
-  std::vector<std::string>                                       _constraint_names_;
-  std::map<std::string, mrs_msgs::DynamicsConstraintsSrvRequest> _constraints_;
+  // the constraint ID is the index in _constraint_names_ and _constraints_
+  std::vector<std::string>                             _constraint_names_;
+  std::vector<mrs_msgs::DynamicsConstraintsSrvRequest> _constraints_;
+  std::unordered_map<std::string, int>                 _constraint_ids_;
+
+  // compiled in onInit(), indexed by the estimator index (in _estimator_type_names_)
+  std::vector<ConstraintSet_t>          _allowed_constraints_;
+  std::vector<int>                      _fallback_constraints_;
+  std::vector<std::vector<std::string>> _allowed_constraint_names_;  // for the diagnostics
+
+  // maps the state board's estimator IDs to the estimator index, -1 = not in the config
+  std::vector<int> _estimator_idx_by_id_;
 
-  std::map<std::string, std::vector<std::string>> _map_type_allowed_constraints_;
-  std::map<std::string, std::string>              _map_type_fallback_constraints_;
+  int estimatorIdx(const int estimator_id) const;
+  int constraintId(const std::string& name) const;
 
   // | --------------------- service clients -------------------- |
 
@@ -67,21 +88,24 @@ private:
 
   // | ------------- constraint management ------------- |
 
-  bool setConstraints(std::string constraints_names);
+  bool setConstraints(const int constraints_id);
 
   ros::ServiceServer service_server_set_constraints_;
   bool               callbackSetConstraints(mrs_msgs::String::Request& req, mrs_msgs::String::Response& res);
 
   mrs_msgs::EstimatorType::_type_type last_estimator_type_;
-  std::string                         last_estimator_name_;
+  int                                 last_estimator_idx_ = -1;
   std::mutex                          mutex_last_estimator_type_;
 
   void       timerConstraintManagement(const ros::TimerEvent& event);
   ros::Timer timer_constraint_management_;
   int        _constraint_management_rate_;
 
-  std::string current_constraints_;
-  std::mutex  mutex_current_constraints_;
+  std::atomic<int> current_constraints_ = -1;
+
+  // the values sent to the ControlManager, after the override and the dynamic scaling
+  mrs_msgs::DynamicsConstraintsSrvRequest::_constraints_type applied_constraints_;
+  std::mutex                                                 mutex_applied_constraints_;
 
   // | ------------------ constraints override ------------------ |
 
@@ -93,6 +117,27 @@ private:
   std::mutex                           mutex_constraints_override_;
   mrs_msgs::ConstraintsOverrideRequest constraints_override_;
 
+  // | ------------------- dynamic constraints ------------------ |
+
+  // the constraints are continuously tightened with the estimated mass and the thrust headroom
+  // reported by the ControlManager through the state board, never loosened beyond the named set
+
+  bool   _dynamic_constraints_enabled_ = false;
+  double _dynamic_constraints_rate_;
+  double _dynamic_constraints_change_threshold_;
+  double _dynamic_constraints_min_scale_;
+  double _dynamic_constraints_mass_ratio_start_;
+  double _dynamic_constraints_mass_ratio_end_;
+  double _dynamic_constraints_headroom_start_;
+  double _dynamic_constraints_headroom_end_;
+
+  std::atomic<double> dynamic_scale_ = 1.0;
+  ros::Time           dynamic_scale_last_push_;
+
+  void   updateDynamicScale(void);
+  double dynamicScale(const state_board::ControlManagerState& state);
+  void   scaleConstraints(mrs_msgs::DynamicsConstraintsSrvRequest::_constraints_type& constraints, const double scale);
+
   // | ------------------ diagnostics publisher ----------------- |
 
   mrs_lib::PublisherHandler<mrs_msgs::ConstraintManagerDiagnostics> ph_diagnostics_;
@@ -111,9 +156,16 @@ private:
   bool                                       scope_timer_enabled_ = false;
   std::shared_ptr<mrs_lib::ScopeTimerLogger> scope_timer_logger_;
 
-  // | ------------------------- helpers ------------------------ |
+  // | ----------------------- state board ---------------------- |
+
+  bool                     _state_board_enabled_ = false;
+  double                   _state_board_timeout_;
+  state_board::StateBoard* state_board_ = nullptr;
+
+  bool getEstimator(int& estimator_id, mrs_msgs::EstimatorType::_type_type& estimator_type);
 
-  bool stringInVector(const std::string& value, const std::vector<std::string>& vector);
+  // the estimator from the odometry diagnostics, interned only when its name changes
+  state_board::InternCache odometry_estimator_;
 };
 
 //}
@@ -149,11 +201,27 @@ void ConstraintManager::onInit() {
   param_loader.loadParam("rate", _constraint_management_rate_);
   param_loader.loadParam("diagnostics_rate", _diagnostics_rate_);
 
+  param_loader.loadParam("state_board/enabled", _state_board_enabled_);
+  param_loader.loadParam("state_board/timeout", _state_board_timeout_);
+
+  if (int(_constraint_names_.size()) > MAX_CONSTRAINTS) {
+    ROS_ERROR("[ConstraintManager]: too many constraints (%d), at most %d are supported", int(_constraint_names_.size()), MAX_CONSTRAINTS);
+    ros::shutdown();
+    return;
+  }
+
   std::vector<std::string>::iterator it;
 
   // loading constraint names
   for (it = _constraint_names_.begin(); it != _constraint_names_.end(); ++it) {
 
+    if (_constraint_ids_.count(*it) > 0) {
+      ROS_ERROR("[ConstraintManager]: the constraints '%s' are listed more than once!", it->c_str());
+      ros::shutdown();
+    }
+
+    _constraint_ids_.insert({*it, int(_constraints_.size())});
+
     ROS_INFO_STREAM("[ConstraintManager]: loading constraints '" << *it << "'");
 
     mrs_msgs::DynamicsConstraintsSrvRequest new_constraints;
@@ -184,45 +252,108 @@ void ConstraintManager::onInit() {
 
     param_loader.loadParam(*it + "/tilt", new_constraints.constraints.tilt);
 
-    _constraints_.insert(std::pair<std::string, mrs_msgs::DynamicsConstraintsSrvRequest>(*it, new_constraints));
+    _constraints_.push_back(new_constraints);
   }
 
-  // loading the allowed constraints lists
-  for (it = _estimator_type_names_.begin(); it != _estimator_type_names_.end(); ++it) {
+  // | ------- compile the estimator x constraints tables ------- |
+
+  state_board_ = &state_board::getStateBoard(ros::names::parentNamespace(nh_.getNamespace()));
 
+  for (int i = 0; i < int(_estimator_type_names_.size()); i++) {
+
+    const std::string& estimator_name = _estimator_type_names_[i];
+
+    // loading the allowed constraints list
     std::vector<std::string> temp_vector;
-    param_loader.loadParam("constraint_management/allowed_constraints/" + *it, temp_vector);
+    param_loader.loadParam("constraint_management/allowed_constraints/" + estimator_name, temp_vector);
+
+    ConstraintSet_t allowed;
 
-    std::vector<std::string>::iterator it2;
-    for (it2 = temp_vector.begin(); it2 != temp_vector.end(); ++it2) {
-      if (!stringInVector(*it2, _constraint_names_)) {
-        ROS_ERROR("[ConstraintManager]: the element '%s' of %s/allowed_constraints is not a valid constraint!", it2->c_str(), it->c_str());
+    for (auto& constraint_name : temp_vector) {
+
+      const int id = constraintId(constraint_name);
+
+      if (id < 0) {
+        ROS_ERROR("[ConstraintManager]: the element '%s' of %s/allowed_constraints is not a valid constraint!", constraint_name.c_str(),
+                  estimator_name.c_str());
         ros::shutdown();
+        continue;
       }
+
+      allowed.set(id);
     }
 
-    _map_type_allowed_constraints_.insert(std::pair<std::string, std::vector<std::string>>(*it, temp_vector));
-  }
+    // loading the fallback constraints
+    std::string temp_str;
+    param_loader.loadParam("constraint_management/fallback_constraints/" + estimator_name, temp_str);
 
-  // loading the fallback constraints
-  for (it = _estimator_type_names_.begin(); it != _estimator_type_names_.end(); ++it) {
+    const int fallback = constraintId(temp_str);
 
-    std::string temp_str;
-    param_loader.loadParam("constraint_management/fallback_constraints/" + *it, temp_str);
+    if (fallback < 0 || !allowed.test(fallback)) {
+      ROS_ERROR("[ConstraintManager]: the element '%s' of %s/allowed_constraints is not a valid constraint!", temp_str.c_str(), estimator_name.c_str());
+      ros::shutdown();
+    }
+
+    _allowed_constraints_.push_back(allowed);
+    _fallback_constraints_.push_back(fallback);
+    _allowed_constraint_names_.push_back(temp_vector);
+
+    // the IDs are shared through the state board, the same as the ones returned by getEstimator()
+    const int estimator_id = state_board_->names.intern(estimator_name);
 
-    if (!stringInVector(temp_str, _map_type_allowed_constraints_.at(*it))) {
-      ROS_ERROR("[ConstraintManager]: the element '%s' of %s/allowed_constraints is not a valid constraint!", temp_str.c_str(), it->c_str());
+    if (estimator_id >= int(_estimator_idx_by_id_.size())) {
+      _estimator_idx_by_id_.resize(estimator_id + 1, -1);
+    }
+
+    if (_estimator_idx_by_id_[estimator_id] != -1) {
+      ROS_ERROR("[ConstraintManager]: the estimator type '%s' is listed more than once!", estimator_name.c_str());
       ros::shutdown();
     }
 
-    _map_type_fallback_constraints_.insert(std::pair<std::string, std::string>(*it, temp_str));
+    _estimator_idx_by_id_[estimator_id] = i;
   }
 
   ROS_INFO("[ConstraintManager]: done loading dynamical params");
 
-  current_constraints_ = "";
+  // | ------------------- dynamic constraints ------------------ |
+
+  param_loader.loadParam("dynamic_constraints/enabled", _dynamic_constraints_enabled_);
+  param_loader.loadParam("dynamic_constraints/rate", _dynamic_constraints_rate_);
+  param_loader.loadParam("dynamic_constraints/change_threshold", _dynamic_constraints_change_threshold_);
+  param_loader.loadParam("dynamic_constraints/min_scale", _dynamic_constraints_min_scale_);
+  param_loader.loadParam("dynamic_constraints/mass_ratio/start", _dynamic_constraints_mass_ratio_start_);
+  param_loader.loadParam("dynamic_constraints/mass_ratio/end", _dynamic_constraints_mass_ratio_end_);
+  param_loader.loadParam("dynamic_constraints/thrust_headroom/start", _dynamic_constraints_headroom_start_);
+  param_loader.loadParam("dynamic_constraints/thrust_headroom/end", _dynamic_constraints_headroom_end_);
+
+  if (_dynamic_constraints_enabled_) {
+
+    if (_dynamic_constraints_rate_ <= 0 || _dynamic_constraints_change_threshold_ < 0) {
+      ROS_ERROR("[ConstraintManager]: dynamic_constraints/rate has to be > 0 and dynamic_constraints/change_threshold >= 0!");
+      ros::shutdown();
+    }
+
+    if (_dynamic_constraints_min_scale_ <= 0 || _dynamic_constraints_min_scale_ > 1) {
+      ROS_ERROR("[ConstraintManager]: dynamic_constraints/min_scale has to be in (0, 1]!");
+      ros::shutdown();
+    }
+
+    if (_dynamic_constraints_mass_ratio_end_ <= _dynamic_constraints_mass_ratio_start_) {
+      ROS_ERROR("[ConstraintManager]: dynamic_constraints/mass_ratio/end has to be > start!");
+      ros::shutdown();
+    }
+
+    if (_dynamic_constraints_headroom_end_ >= _dynamic_constraints_headroom_start_) {
+      ROS_ERROR("[ConstraintManager]: dynamic_constraints/thrust_headroom/end has to be < start!");
+      ros::shutdown();
+    }
+
+    if (!_state_board_enabled_) {
+      ROS_WARN("[ConstraintManager]: dynamic constraints need the state board, they will not be applied!");
+    }
+  }
+
   last_estimator_type_ = -1;
-  last_estimator_name_ = "";
 
   // | ------------------------ services ------------------------ |
 
@@ -286,19 +417,21 @@ void ConstraintManager::onInit() {
 
 /* setConstraints() //{ */
 
-bool ConstraintManager::setConstraints(std::string constraints_name) {
-
-  std::map<std::string, mrs_msgs::DynamicsConstraintsSrvRequest>::iterator it;
-  it = _constraints_.find(constraints_name);
+bool ConstraintManager::setConstraints(const int constraints_id) {
 
-  if (it == _constraints_.end()) {
-    ROS_ERROR("[ConstraintManager]: could not setConstraints(), the constraint name '%s' is not on the list", constraints_name.c_str());
+  if (constraints_id < 0 || constraints_id >= int(_constraints_.size())) {
+    ROS_ERROR("[ConstraintManager]: could not setConstraints(), the constraint ID %d is not valid", constraints_id);
     return false;
   }
 
   mrs_msgs::DynamicsConstraintsSrv srv_call;
 
-  srv_call.request = it->second;
+  srv_call.request = _constraints_[constraints_id];
+
+  // the override is applied after the scaling, it is checked against the scaled values
+  if (_dynamic_constraints_enabled_) {
+    scaleConstraints(srv_call.request.constraints, dynamic_scale_);
+  }
 
   if (override_constraints_) {
 
@@ -332,7 +465,10 @@ bool ConstraintManager::setConstraints(std::string constraints_name) {
 
     if (srv_call.response.success) {
 
-      mrs_lib::set_mutexed(mutex_current_constraints_, constraints_name, current_constraints_);
+      current_constraints_ = constraints_id;
+
+      mrs_lib::set_mutexed(mutex_applied_constraints_, srv_call.request.constraints, applied_constraints_);
+
       return true;
 
     } else {
@@ -361,7 +497,10 @@ bool ConstraintManager::callbackSetConstraints(mrs_msgs::String::Request& req, m
 
   std::stringstream ss;
 
-  if (!sh_odom_diag_.hasMsg()) {
+  int                                 estimator_id;
+  mrs_msgs::EstimatorType::_type_type estimator_type;
+
+  if (!getEstimator(estimator_id, estimator_type)) {
 
     ss << "missing odometry diagnostics";
 
@@ -372,9 +511,10 @@ bool ConstraintManager::callbackSetConstraints(mrs_msgs::String::Request& req, m
     return true;
   }
 
-  auto odometry_diagnostics = *sh_odom_diag_.getMsg();
+  const int estimator_idx  = estimatorIdx(estimator_id);
+  const int constraints_id = constraintId(req.value);
 
-  if (!stringInVector(req.value, _constraint_names_)) {
+  if (constraints_id < 0) {
 
     ss << "the constraints '" << req.value.c_str() << "' do not exist (in the ConstraintManager's config)";
 
@@ -385,7 +525,7 @@ bool ConstraintManager::callbackSetConstraints(mrs_msgs::String::Request& req, m
     return true;
   }
 
-  if (!stringInVector(req.value, _map_type_allowed_constraints_.at(odometry_diagnostics.estimator_type.name))) {
+  if (estimator_idx < 0 || !_allowed_constraints_[estimator_idx].test(constraints_id)) {
 
     ss << "the constraints '" << req.value.c_str() << "' are not allowed given the current odometry type";
 
@@ -399,7 +539,7 @@ bool ConstraintManager::callbackSetConstraints(mrs_msgs::String::Request& req, m
   override_constraints_ = false;
 
   // try to set the constraints
-  if (!setConstraints(req.value)) {
+  if (!setConstraints(constraints_id)) {
 
     ss << "the ControlManager could not set the constraints";
 
@@ -465,50 +605,53 @@ void ConstraintManager::timerConstraintManagement(const ros::TimerEvent& event)
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerConstraintManagement", _constraint_management_rate_, 0.01, event);
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ContraintManager::timerConstraintManagement", scope_timer_logger_, scope_timer_enabled_);
 
-  auto current_constraints = mrs_lib::get_mutexed(mutex_current_constraints_, current_constraints_);
-  auto last_estimator_type = mrs_lib::get_mutexed(mutex_last_estimator_type_, last_estimator_type_);
-  auto last_estimator_name = mrs_lib::get_mutexed(mutex_last_estimator_type_, last_estimator_name_);
+  const int current_constraints = current_constraints_;
 
-  if (!sh_odom_diag_.hasMsg()) {
+  auto [last_estimator_type, last_estimator_idx] = mrs_lib::get_mutexed(mutex_last_estimator_type_, last_estimator_type_, last_estimator_idx_);
+
+  int                                 estimator_id;
+  mrs_msgs::EstimatorType::_type_type estimator_type;
+
+  if (!getEstimator(estimator_id, estimator_type)) {
     ROS_WARN_THROTTLE(1.0, "[ConstraintManager]: can not do constraint management, missing odometry diagnostics!");
     return;
   }
 
-  auto odometry_diagnostics = *sh_odom_diag_.getMsg();
-
   // | --- automatically set constraints when odometry.type changes -- |
-  if (odometry_diagnostics.estimator_type.type != last_estimator_type) {
+  if (estimator_type != last_estimator_type) {
 
-    ROS_INFO_THROTTLE(1.0, "[ConstraintManager]: the odometry type has changed! %d -> %d", last_estimator_type, odometry_diagnostics.estimator_type.type);
+    ROS_INFO_THROTTLE(1.0, "[ConstraintManager]: the odometry type has changed! %d -> %d", last_estimator_type, estimator_type);
 
-    std::map<std::string, std::string>::iterator it;
-    it = _map_type_fallback_constraints_.find(odometry_diagnostics.estimator_type.name);
+    const int estimator_idx = estimatorIdx(estimator_id);
 
-    if (it == _map_type_fallback_constraints_.end()) {
+    if (estimator_idx < 0) {
 
       ROS_WARN_THROTTLE(1.0, "[ConstraintManager]: the odometry type '%s' was not specified in the constraint_manager's config!",
-                        odometry_diagnostics.estimator_type.name.c_str());
+                        state_board_->names.name(estimator_id).c_str());
 
     } else {
 
+      const int fallback = _fallback_constraints_[estimator_idx];
+
       // if the current constraints are within the allowed odometry types, do nothing
-      if (stringInVector(current_constraints, _map_type_allowed_constraints_.at(odometry_diagnostics.estimator_type.name))) {
+      if (current_constraints >= 0 && _allowed_constraints_[estimator_idx].test(current_constraints)) {
 
-        last_estimator_type = odometry_diagnostics.estimator_type.type;
-        last_estimator_name = odometry_diagnostics.estimator_type.name;
+        last_estimator_type = estimator_type;
+        last_estimator_idx  = estimator_idx;
 
         // else, try to set the fallback constraints
       } else {
 
-        ROS_WARN_THROTTLE(1.0, "[ConstraintManager]: the current constraints '%s' are not within the allowed constraints for '%s'", current_constraints.c_str(),
-                          odometry_diagnostics.estimator_type.name.c_str());
+        ROS_WARN_THROTTLE(1.0, "[ConstraintManager]: the current constraints '%s' are not within the allowed constraints for '%s'",
+                          current_constraints >= 0 ? _constraint_names_[current_constraints].c_str() : "",
+                          _estimator_type_names_[estimator_idx].c_str());
 
-        if (setConstraints(it->second)) {
+        if (setConstraints(fallback)) {
 
-          last_estimator_type = odometry_diagnostics.estimator_type.type;
-          last_estimator_name = odometry_diagnostics.estimator_type.name;
+          last_estimator_type = estimator_type;
+          last_estimator_idx  = estimator_idx;
 
-          ROS_INFO_THROTTLE(1.0, "[ConstraintManager]: constraints set to fallback: '%s'", it->second.c_str());
+          ROS_INFO_THROTTLE(1.0, "[ConstraintManager]: constraints set to fallback: '%s'", _constraint_names_[fallback].c_str());
 
         } else {
 
@@ -518,22 +661,29 @@ void ConstraintManager::timerConstraintManagement(const ros::TimerEvent& event)
     }
   }
 
-  if (constraints_override_updated_) {
-
-    std::map<std::string, std::string>::iterator it;
-    it = _map_type_fallback_constraints_.find(last_estimator_name_);
+  if (constraints_override_updated_ && last_estimator_idx >= 0) {
 
     ROS_INFO_THROTTLE(0.1, "[ConstraintManager]: re-setting constraints with user value override");
 
-    if (setConstraints(it->second)) {
+    if (setConstraints(_fallback_constraints_[last_estimator_idx])) {
       constraints_override_updated_ = false;
     } else {
       ROS_WARN_THROTTLE(1.0, "[ConstraintManager]: could not re-set the constraints!");
     }
   }
 
-  mrs_lib::set_mutexed(mutex_last_estimator_type_, last_estimator_type, last_estimator_type_);
-  mrs_lib::set_mutexed(mutex_last_estimator_type_, last_estimator_name, last_estimator_name_);
+  {
+    std::scoped_lock lock(mutex_last_estimator_type_);
+
+    last_estimator_type_ = last_estimator_type;
+    last_estimator_idx_  = last_estimator_idx;
+  }
+
+  // | ------------------- dynamic constraints ------------------ |
+
+  if (_dynamic_constraints_enabled_) {
+    updateDynamicScale();
+  }
 }
 
 //}
@@ -549,40 +699,34 @@ void ConstraintManager::timerDiagnostics(const ros::TimerEvent& event) {
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerDiagnostics", _diagnostics_rate_, 0.01, event);
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ContraintManager::timerDiagnostics", scope_timer_logger_, scope_timer_enabled_);
 
-  if (!sh_odom_diag_.hasMsg()) {
+  int                                 estimator_id;
+  mrs_msgs::EstimatorType::_type_type estimator_type;
+
+  if (!getEstimator(estimator_id, estimator_type)) {
     ROS_WARN_THROTTLE(1.0, "[ConstraintManager]: can not do constraint management, missing odometry diagnostics!");
     return;
   }
 
-  auto odometry_diagnostics = *sh_odom_diag_.getMsg();
-
-  auto current_constraints = mrs_lib::get_mutexed(mutex_current_constraints_, current_constraints_);
+  const int estimator_idx       = estimatorIdx(estimator_id);
+  const int current_constraints = current_constraints_;
 
   mrs_msgs::ConstraintManagerDiagnostics diagnostics;
 
-  diagnostics.stamp        = ros::Time::now();
-  diagnostics.current_name = current_constraints;
-  diagnostics.loaded       = _constraint_names_;
+  diagnostics.stamp  = ros::Time::now();
+  diagnostics.loaded = _constraint_names_;
 
   // get the available constraints
-  {
-    std::map<std::string, std::vector<std::string>>::iterator it;
-    it = _map_type_allowed_constraints_.find(odometry_diagnostics.estimator_type.name);
-
-    if (it == _map_type_allowed_constraints_.end()) {
-      ROS_WARN_THROTTLE(1.0, "[ConstraintManager]: the odometry.type '%s' was not specified in the constraint_manager's config!",
-                        odometry_diagnostics.estimator_type.name.c_str());
-    } else {
-      diagnostics.available = it->second;
-    }
+  if (estimator_idx < 0) {
+    ROS_WARN_THROTTLE(1.0, "[ConstraintManager]: the odometry.type '%s' was not specified in the constraint_manager's config!",
+                      state_board_->names.name(estimator_id).c_str());
+  } else {
+    diagnostics.available = _allowed_constraint_names_[estimator_idx];
   }
 
   // get the current constraint values
-  {
-    std::map<std::string, mrs_msgs::DynamicsConstraintsSrvRequest>::iterator it;
-    it = _constraints_.find(current_constraints);
-
-    diagnostics.current_values = it->second.constraints;
+  if (current_constraints >= 0) {
+    diagnostics.current_name   = _constraint_names_[current_constraints];
+    diagnostics.current_values = mrs_lib::get_mutexed(mutex_applied_constraints_, applied_constraints_);
   }
 
   ph_diagnostics_.publish(diagnostics);
@@ -594,19 +738,163 @@ void ConstraintManager::timerDiagnostics(const ros::TimerEvent& event) {
 // |                          routines                          |
 // --------------------------------------------------------------
 
-/* stringInVector() //{ */
+/* getEstimator() //{ */
+
+// the estimator is read from the state board when the ControlManager runs in the same nodelet manager,
+// otherwise from the odometry diagnostics
+bool ConstraintManager::getEstimator(int& estimator_id, mrs_msgs::EstimatorType::_type_type& estimator_type) {
+
+  state_board::ControlManagerState control_manager_state;
+
+  if (_state_board_enabled_ && state_board_->getControlManagerState(control_manager_state, ros::Time::now().toSec(), _state_board_timeout_) &&
+      control_manager_state.estimator != state_board::NameRegistry::INVALID_ID) {
 
-bool ConstraintManager::stringInVector(const std::string& value, const std::vector<std::string>& vector) {
+    estimator_id   = control_manager_state.estimator;
+    estimator_type = control_manager_state.estimator_type;
 
-  if (std::find(vector.begin(), vector.end(), value) == vector.end()) {
+    return true;
+  }
+
+  if (!sh_odom_diag_.hasMsg()) {
     return false;
+  }
+
+  auto odometry_diagnostics = sh_odom_diag_.getMsg();
+
+  estimator_id   = odometry_estimator_.get(state_board_->names, odometry_diagnostics->estimator_type.name);
+  estimator_type = odometry_diagnostics->estimator_type.type;
+
+  return true;
+}
+
+//}
+
+/* updateDynamicScale() //{ */
+
+// re-sends the current constraints when the scale changed by more than the threshold, at most at the configured rate
+void ConstraintManager::updateDynamicScale(void) {
+
+  const int current_constraints = current_constraints_;
+
+  if (current_constraints < 0 || !_state_board_enabled_) {
+    return;
+  }
+
+  const ros::Time now = ros::Time::now();
+
+  if ((now - dynamic_scale_last_push_).toSec() < (1.0 / _dynamic_constraints_rate_)) {
+    return;
+  }
+
+  state_board::ControlManagerState control_manager_state;
+
+  if (!state_board_->getControlManagerState(control_manager_state, now.toSec(), _state_board_timeout_)) {
+    ROS_WARN_THROTTLE(1.0, "[ConstraintManager]: can not scale the constraints, the ControlManager state is not available");
+    return;
+  }
+
+  // the mass estimate is only meaningful in the normal flight, the last scale is kept otherwise
+  if (!control_manager_state.flying_normally) {
+    return;
+  }
+
+  const double scale     = dynamicScale(control_manager_state);
+  const double old_scale = dynamic_scale_;
+
+  // the full scale is always restored, even when the change is below the threshold
+  const bool restore = scale >= 1.0 && old_scale < 1.0;
+
+  if (std::abs(scale - old_scale) <= _dynamic_constraints_change_threshold_ && !restore) {
+    return;
+  }
+
+  dynamic_scale_last_push_ = now;
+  dynamic_scale_           = scale;
+
+  if (setConstraints(current_constraints)) {
+
+    ROS_INFO_THROTTLE(1.0, "[ConstraintManager]: constraints scaled to %.2f (mass %.2f/%.2f kg, thrust headroom %.2f)", scale,
+                      control_manager_state.mass_estimate, control_manager_state.mass_nominal, control_manager_state.thrust_headroom);
+
   } else {
-    return true;
+
+    dynamic_scale_ = old_scale;
+
+    ROS_WARN_THROTTLE(1.0, "[ConstraintManager]: could not set the scaled constraints!");
   }
 }
 
 //}
 
+/* dynamicScale() //{ */
+
+// 1 = the named constraints, min_scale = the most tightened, the lower of the mass and the headroom scales is used
+double ConstraintManager::dynamicScale(const state_board::ControlManagerState& state) {
+
+  auto ramp = [this](const double value, const double start, const double end) {
+    const double progress = std::clamp((value - start) / (end - start), 0.0, 1.0);
+    return 1.0 - progress * (1.0 - _dynamic_constraints_min_scale_);
+  };
+
+  double scale = 1.0;
+
+  if (state.mass_nominal > 0) {
+    scale = std::min(scale, ramp(state.mass_estimate / state.mass_nominal, _dynamic_constraints_mass_ratio_start_, _dynamic_constraints_mass_ratio_end_));
+  }
+
+  scale = std::min(scale, ramp(state.thrust_headroom, _dynamic_constraints_headroom_start_, _dynamic_constraints_headroom_end_));
+
+  return scale;
+}
+
+//}
+
+/* scaleConstraints() //{ */
+
+// the translational speeds, accelerations and jerks and the tilt, the heading and the angular rates are left as they are
+void ConstraintManager::scaleConstraints(mrs_msgs::DynamicsConstraintsSrvRequest::_constraints_type& constraints, const double scale) {
+
+  constraints.horizontal_speed        *= scale;
+  constraints.horizontal_acceleration *= scale;
+  constraints.horizontal_jerk         *= scale;
+
+  constraints.vertical_ascending_speed        *= scale;
+  constraints.vertical_ascending_acceleration *= scale;
+  constraints.vertical_ascending_jerk         *= scale;
+
+  constraints.vertical_descending_speed        *= scale;
+  constraints.vertical_descending_acceleration *= scale;
+  constraints.vertical_descending_jerk         *= scale;
+
+  constraints.tilt *= scale;
+}
+
+//}
+
+/* estimatorIdx() //{ */
+
+int ConstraintManager::estimatorIdx(const int estimator_id) const {
+
+  if (estimator_id < 0 || estimator_id >= int(_estimator_idx_by_id_.size())) {
+    return -1;
+  }
+
+  return _estimator_idx_by_id_[estimator_id];
+}
+
+//}
+
+/* constraintId() //{ */
+
+int ConstraintManager::constraintId(const std::string& name) const {
+
+  auto it = _constraint_ids_.find(name);
+
+  return it == _constraint_ids_.end() ? -1 : it->second;
+}
+
+//}
+
 }  // namespace constraint_manager
 
 }  // namespace mrs_uav_managers
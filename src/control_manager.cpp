@@ -5,9 +5,20 @@
 #include <ros/ros.h>
 #include <ros/package.h>
 #include <nodelet/nodelet.h>
+#include <ros/callback_queue.h>
 
 #include <mrs_uav_managers/controller.h>
 #include <mrs_uav_managers/tracker.h>
+#include <mrs_uav_managers/state_board.h>
+#include <mrs_uav_managers/safety_evaluator.h>
+#include <mrs_uav_managers/control_manager_commands.h>
+#include <mrs_uav_managers/landing_detector.h>
+#include <mrs_uav_managers/deadline_loop.h>
+#include <mrs_uav_managers/arrival_watchdog.h>
+#include <mrs_uav_managers/input_timing.h>
+#include <mrs_uav_managers/message_pool.h>
+#include <mrs_uav_managers/command_queue.h>
+#include <mrs_uav_managers/mailbox.h>
 
 #include <mrs_msgs/String.h>
 #include <mrs_msgs/Float64Stamped.h>
@@ -50,10 +61,15 @@
 #include <mavros_msgs/CommandLong.h>
 #include <mavros_msgs/State.h>
 #include <mavros_msgs/RCIn.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 
 #include <std_msgs/Float64.h>
 
 #include <future>
+#include <shared_mutex>
+#include <algorithm>
+#include <array>
+#include <cstring>
 
 #include <pluginlib/class_loader.h>
 
@@ -140,6 +156,48 @@ namespace mrs_uav_managers
 namespace control_manager
 {
 
+/* finite value validation //{ */
+
+// checks the IEEE 754 exponent bits of all values in a single branchless pass,
+// which the compiler can vectorize, unlike a chain of std::isfinite() branches
+template <size_t N>
+bool allFinite(const std::array<double, N>& values) {
+
+  const uint64_t exponent_mask = 0x7FF0000000000000ULL;
+
+  uint64_t non_finite = 0;
+
+  for (size_t i = 0; i < N; i++) {
+
+    uint64_t bits;
+    std::memcpy(&bits, &values[i], sizeof(bits));
+
+    non_finite |= uint64_t((bits & exponent_mask) == exponent_mask);
+  }
+
+  return non_finite == 0;
+}
+
+// the per-field error message is only constructed when the fast check fails
+template <size_t N>
+bool validateFinite(const std::array<double, N>& values, const std::array<const char*, N>& names) {
+
+  if (allFinite(values)) {
+    return true;
+  }
+
+  for (size_t i = 0; i < N; i++) {
+    if (!std::isfinite(values[i])) {
+      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable '%s'!!!", names[i]);
+      break;
+    }
+  }
+
+  return false;
+}
+
+//}
+
 /* //{ class ControlManager */
 
 // state machine
@@ -177,6 +235,61 @@ typedef enum
 
 } EscalatingFailsafeStates_t;
 
+// the steps of the state watchdog's escalation ladder
+typedef enum
+{
+
+  WATCHDOG_EXTRAPOLATE = 0,
+  WATCHDOG_EHOVER      = 1,
+  WATCHDOG_ELAND       = 2,
+  WATCHDOG_FAILSAFE    = 3,
+
+} StateWatchdogAction_t;
+
+const char* state_watchdog_action_names[4] = {
+
+    "extrapolate", "ehover", "eland", "failsafe"};
+
+// the subscribed inputs, whose arrival timing is monitored
+typedef enum
+{
+
+  MONITORED_UAV_STATE = 0,
+  MONITORED_ODOMETRY,
+  MONITORED_PIXHAWK_ODOMETRY,
+  MONITORED_BUMPER,
+  MONITORED_RC,
+  MONITORED_JOYSTICK,
+  MONITORED_MAVROS_STATE,
+  MONITORED_MAVROS_GPS,
+  MONITORED_INPUT_COUNT,
+
+} MonitoredInput_t;
+
+// set on the thread which runs the control loop (asyncControl() or the fallback of the command queue),
+// a command issued from it (e.g., by a plugin) is executed directly, it would wait for itself otherwise
+thread_local bool in_control_loop = false;
+
+// the callback queues of the ControlManager
+typedef enum
+{
+
+  QUEUE_NODELET = 0,
+  QUEUE_STATE,
+  QUEUE_SERVICES,
+  QUEUE_STATUS,
+  QUEUE_COUNT,
+
+} CallbackQueue_t;
+
+const char* callback_queue_names[QUEUE_COUNT] = {
+
+    "nodelet", "state", "services", "status"};
+
+const char* monitored_input_names[MONITORED_INPUT_COUNT] = {
+
+    "uav_state", "odometry", "mavros_odometry", "bumper_sectors", "rc", "joystick", "mavros_state", "mavros_gps"};
+
 /* class ControllerParams() //{ */
 
 class ControllerParams {
@@ -227,11 +340,160 @@ TrackerParams::TrackerParams(std::string address, bool human_switchable) {
 
 //}
 
+/* class PluginRegistry() //{ */
+
+// dense, compile-once registry of the loaded plugins (trackers or controllers)
+// * plugins are added during onInit() in the order of their indices in tracker_list_/controller_list_,
+//   a duplicate name is rejected by add(), since no hash table can separate it
+// * compile() builds a collision-free (perfect) hash table over the names, name -> idx then costs
+//   one hash and one string comparison, idx -> params is a plain vector access
+// * the registry is immutable after compile(), so it can be read without locking
+template <typename Params>
+class PluginRegistry {
+
+public:
+  bool add(const std::string& name, const Params& params);  // returns false if the name is already registered
+  void compile(void);
+
+  int           find(const std::string& name) const;  // returns -1 if the plugin does not exist
+  const Params& params(const int idx) const;
+  int           size(void) const;
+
+private:
+  std::vector<std::string> names_;
+  std::vector<Params>      params_;
+
+  std::vector<int> table_;  // hash slot -> idx, -1 = empty
+  uint64_t         seed_ = 0;
+  uint64_t         mask_ = 0;
+
+  uint64_t hash(const std::string& name, const uint64_t seed) const;
+};
+
+template <typename Params>
+bool PluginRegistry<Params>::add(const std::string& name, const Params& params) {
+
+  if (std::find(names_.begin(), names_.end(), name) != names_.end()) {
+    return false;
+  }
+
+  names_.push_back(name);
+  params_.push_back(params);
+
+  return true;
+}
+
+template <typename Params>
+void PluginRegistry<Params>::compile(void) {
+
+  size_t table_size = 1;
+
+  while (table_size < 2 * names_.size()) {
+    table_size *= 2;
+  }
+
+  // search for a seed without collisions, grow the table if it takes too long
+  for (;;) {
+
+    mask_ = table_size - 1;
+
+    for (seed_ = 0; seed_ < 64; seed_++) {
+
+      table_.assign(table_size, -1);
+
+      bool collision = false;
+
+      for (size_t i = 0; i < names_.size(); i++) {
+
+        int& slot = table_[hash(names_[i], seed_) & mask_];
+
+        if (slot != -1) {
+          collision = true;
+          break;
+        }
+
+        slot = int(i);
+      }
+
+      if (!collision) {
+        return;
+      }
+    }
+
+    table_size *= 2;
+  }
+}
+
+template <typename Params>
+int PluginRegistry<Params>::find(const std::string& name) const {
+
+  if (table_.empty()) {
+    return -1;
+  }
+
+  const int idx = table_[hash(name, seed_) & mask_];
+
+  // the table is perfect for the registered names, unknown names have to be rejected
+  if (idx < 0 || names_[idx] != name) {
+    return -1;
+  }
+
+  return idx;
+}
+
+template <typename Params>
+const Params& PluginRegistry<Params>::params(const int idx) const {
+  return params_[idx];
+}
+
+template <typename Params>
+int PluginRegistry<Params>::size(void) const {
+  return int(names_.size());
+}
+
+// FNV-1a with the seed mixed into the offset basis
+template <typename Params>
+uint64_t PluginRegistry<Params>::hash(const std::string& name, const uint64_t seed) const {
+
+  uint64_t h = 14695981039346656037ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+
+  for (const char c : name) {
+    h ^= uint64_t(static_cast<unsigned char>(c));
+    h *= 1099511628211ULL;
+  }
+
+  return h;
+}
+
+//}
+
+/* class FunctionCallback //{ */
+
+// a plain function as a callback of a ros::CallbackQueue
+class FunctionCallback : public ros::CallbackInterface {
+
+public:
+  explicit FunctionCallback(const std::function<void(void)>& function) : function_(function) {
+  }
+
+  CallResult call(void) override {
+    function_();
+    return Success;
+  }
+
+private:
+  std::function<void(void)> function_;
+};
+
+//}
+
 class ControlManager : public nodelet::Nodelet {
 
 public:
   virtual void onInit();
 
+  ~ControlManager(void);
+
 private:
   ros::NodeHandle   nh_;
   std::string       _version_;
@@ -239,11 +501,49 @@ private:
   std::string       _uav_name_;
   std::string       _body_frame_;
 
+  // | --------------------- callback queues -------------------- |
+
+  // with callback_queues/enabled, the hot inputs, the services and the status timers are served by their own queues and threads,
+  // so a slow service call or a status timer can not delay the state
+  // * nh_state_:    uav_state/odometry, mavros odometry, mavros state, RC
+  // * nh_services_: the services and the reference topics
+  // * nh_status_:   the status, bumper, joystick and timing diagnostics timers
+  // * the rest stays in the nodelet's queue (nh_), the handles are copies of nh_ when disabled
+  // the queues are declared before the subscribers, services and timers, so they outlive them
+  bool            _callback_queues_enabled_ = false;
+  ros::NodeHandle nh_state_;
+  ros::NodeHandle nh_services_;
+  ros::NodeHandle nh_status_;
+
+  ros::CallbackQueue queue_state_;
+  ros::CallbackQueue queue_services_;
+  ros::CallbackQueue queue_status_;
+
+  // the services and the status queues are served by AsyncSpinners
+  std::vector<std::unique_ptr<ros::AsyncSpinner>> spinners_;
+
+  // the state queue is served by its own threads, optionally with the SCHED_FIFO priority (callback_queues/state_priority)
+  std::vector<std::thread> state_queue_threads_;
+  std::atomic<bool>        state_queue_running_ = false;
+  void                     stateQueueLoop(void);
+
+  // the latency of each queue, measured by a probe timer in the queue as the delay of its calls after the expected time
+  struct QueueProbe
+  {
+    ros::Timer            timer;
+    std::mutex            mutex;
+    timing::DurationStats latency;  // since the last timing diagnostics
+    double                max_latency = 0;
+  };
+
+  std::array<QueueProbe, QUEUE_COUNT> queue_probes_;
+  void                                timerQueueProbe(const ros::TimerEvent& event, const int queue);
+
   // | --------------- dynamic loading of trackers -------------- |
 
   std::unique_ptr<pluginlib::ClassLoader<mrs_uav_managers::Tracker>> tracker_loader_;  // pluginlib loader of dynamically loaded trackers
   std::vector<std::string>                                           _tracker_names_;  // list of tracker names
-  std::map<std::string, TrackerParams>                               trackers_;        // map between tracker names and tracker param
+  PluginRegistry<TrackerParams>                                      trackers_;        // tracker idx -> tracker params, tracker name -> tracker idx
   std::vector<boost::shared_ptr<mrs_uav_managers::Tracker>>          tracker_list_;    // list of trackers, routines are callable from this
   std::mutex                                                         mutex_tracker_list_;
 
@@ -251,7 +551,7 @@ private:
 
   std::unique_ptr<pluginlib::ClassLoader<mrs_uav_managers::Controller>> controller_loader_;  // pluginlib loader of dynamically loaded controllers
   std::vector<std::string>                                              _controller_names_;  // list of controller names
-  std::map<std::string, ControllerParams>                               controllers_;        // map between controller names and controller params
+  PluginRegistry<ControllerParams>                                      controllers_;        // controller idx -> params, controller name -> controller idx
   std::vector<boost::shared_ptr<mrs_uav_managers::Controller>>          controller_list_;    // list of controllers, routines are callable from this
   std::mutex                                                            mutex_controller_list_;
 
@@ -329,10 +629,46 @@ private:
   double             uav_heading_                 = 0;
   std::mutex         mutex_uav_state_;
 
-  // odometry hiccup detection
-  double uav_state_avg_dt_        = 1;
-  double uav_state_hiccup_factor_ = 1;
-  int    uav_state_count_         = 0;
+  mrs_msgs::UavState predictUavState(const mrs_msgs::UavState& uav_state, const double dt);
+
+  // | --------------------- state watchdog --------------------- |
+
+  // watches the arrivals of the uav_state/odometry against a deadline learned from their inter-arrival times
+  // * replaces the SubscribeHandler's timeout (odometry_max_missing_time) when enabled
+  // * the missing state escalates through the ladder, e.g., extrapolate -> ehover -> eland -> failsafe
+  // * extrapolation keeps the control loop running on the predicted state until the state arrives again,
+  //   the prediction is only the input of the control, uav_state_ keeps the last measured state and its stamp
+  bool                               _state_watchdog_enabled_ = false;
+  double                             _state_watchdog_rate_;
+  timing::ArrivalWatchdogParams      _state_watchdog_params_;
+  std::vector<StateWatchdogAction_t> _state_watchdog_actions_;
+  int                                _state_watchdog_extrapolate_step_ = -1;  // -1 = no extrapolation
+
+  timing::ArrivalWatchdog state_watchdog_;
+  std::mutex              mutex_state_watchdog_;
+
+  int                 state_watchdog_level_              = 0;  // only used by the watchdog loop
+  int64_t             state_watchdog_last_extrapolation_ = 0;  // [ns]
+  std::atomic<bool>   state_watchdog_extrapolating_      = false;
+  std::atomic<double> state_watchdog_extrapolation_max_  = 0;  // [s], the outage time to reach the terminal ladder step
+
+  std::unique_ptr<timing::DeadlineLoop> state_watchdog_loop_;
+  void                                  stateWatchdogLoop(void);
+  void                                  stateArrived(void);
+
+  // | ---------------------- input timing ---------------------- |
+
+  // the inter-arrival times and the ages of all the subscribed inputs, published in the timing diagnostics
+  // * the min/mean/max/p99 windows restart with each timing diagnostics message
+  std::array<std::unique_ptr<timing::InputTiming>, MONITORED_INPUT_COUNT> input_timing_;
+
+  double   _input_timing_hiccup_factor_;  // [-], warn when the state arrives later than this multiple of its mean period
+  uint64_t _input_timing_min_samples_;
+
+  void inputArrived(const MonitoredInput_t input, const ros::Time& stamp);
+
+  void callbackPixhawkOdometry(mrs_lib::SubscribeHandler<nav_msgs::Odometry>& wrp);
+  void callbackBumper(mrs_lib::SubscribeHandler<mrs_msgs::ObstacleSectors>& wrp);
 
   // | ------------------ Mavros GPS subscriber ----------------- |
 
@@ -372,6 +708,8 @@ private:
   int _joystick_fallback_tracker_idx_    = 0;
   int _null_tracker_idx_                 = 0;
   int _eland_controller_idx_             = 0;
+  int _bumper_tracker_idx_               = -1;  // -1 if not resolved (only checked when the joystick is enabled)
+  int _bumper_controller_idx_            = -1;
 
   // | -------------- enabling the output publisher ------------- |
 
@@ -401,6 +739,13 @@ private:
   mrs_lib::PublisherHandler<mrs_msgs::Float64Stamped>            ph_heading_;
   mrs_lib::PublisherHandler<mrs_msgs::Float64Stamped>            ph_speed_;
 
+  // the outputs of publish() are published as shared pointers from recycled pools,
+  // so the intra-process subscribers (mavros, UavManager) get them without serialization and copying
+  messaging::MessagePool<mavros_msgs::AttitudeTarget::Ptr> pool_control_output_;
+  messaging::MessagePool<mrs_msgs::Float64Stamped::Ptr>    pool_thrust_force_;
+  messaging::MessagePool<nav_msgs::Odometry::Ptr>          pool_cmd_odom_;
+  messaging::MessagePool<geometry_msgs::Twist::Ptr>        pool_cmd_twist_;
+
   // | --------------------- service servers -------------------- |
 
   ros::ServiceServer service_server_switch_tracker_;
@@ -491,10 +836,12 @@ private:
 
   // | --------------------- thrust and mass -------------------- |
 
-  // thrust mass estimation during eland
-  double    thrust_mass_estimate_   = 0;
-  bool      thrust_under_threshold_ = false;
-  ros::Time thrust_mass_estimate_first_time_;
+  // touchdown detection during eland and failsafe, fed from updateControllers()
+  landing::LandingDetectorParams _landing_detector_params_;
+  landing::LandingDetector       landing_detector_;
+  std::mutex                     mutex_landing_detector_;
+
+  void feedLandingDetector(const mrs_msgs::UavState& uav_state);
 
   // | ---------------------- safety params --------------------- |
 
@@ -527,12 +874,16 @@ private:
   std::mutex mutex_attitude_error_;
   std::mutex mutex_control_error_;
 
+  bool _odometry_innovation_check_enabled_ = false;
+
   // control error for triggering failsafe, eland, etc.
-  // this filled with the current controllers failsafe threshold
-  double _failsafe_threshold_                = 0;  // control error for triggering failsafe
-  double _eland_threshold_                   = 0;  // control error for triggering eland
-  bool   _odometry_innovation_check_enabled_ = false;
-  double _odometry_innovation_threshold_     = 0;  // innovation size for triggering eland
+  // * the thresholds of all controllers are precomputed in onInit(), the table is not modified afterwards
+  // * switching a controller installs the pointer to its record, timerSafety() only loads the pointer
+  std::vector<safety::SafetyThresholds>        safety_thresholds_table_;
+  std::atomic<const safety::SafetyThresholds*> safety_thresholds_ = nullptr;
+  safety::SafetyLimits                         safety_limits_;
+
+  void installSafetyThresholds(const int controller_idx);
 
   // are callbacks enabled to trackers?
   bool callbacks_enabled_ = true;
@@ -633,15 +984,48 @@ private:
   // sets constraints to all trackers
   bool callbackSetConstraints(mrs_msgs::DynamicsConstraintsSrv::Request& req, mrs_msgs::DynamicsConstraintsSrv::Response& res);
 
+  // the constraints limits reported by the active controller in its attitude command
+  struct ControllerConstraintsLimits
+  {
+    bool   enforcing                  = false;
+    double horizontal_speed           = 0;
+    double horizontal_acceleration    = 0;
+    double vertical_asc_speed         = 0;
+    double vertical_asc_acceleration  = 0;
+    double vertical_desc_speed        = 0;
+    double vertical_desc_acceleration = 0;
+
+    bool operator==(const ControllerConstraintsLimits& other) const {
+      return enforcing == other.enforcing && horizontal_speed == other.horizontal_speed && horizontal_acceleration == other.horizontal_acceleration &&
+             vertical_asc_speed == other.vertical_asc_speed && vertical_asc_acceleration == other.vertical_asc_acceleration &&
+             vertical_desc_speed == other.vertical_desc_speed && vertical_desc_acceleration == other.vertical_desc_acceleration;
+    }
+  };
+
+  ControllerConstraintsLimits getControllerConstraintsLimits(void);
+
   // constraints management
+  // * current_constraints_ come from the ConstraintManager, sanitized_constraints_ = current_constraints_ limited by the active controller
+  // * the sanitized constraints are recomputed only when the current constraints or the controller's limits change
+  // * each plugin gets the sanitized constraints only when its last received version differs
   bool       got_constraints_ = false;
   std::mutex mutex_constraints_;
-  void       setConstraints(mrs_msgs::DynamicsConstraintsSrvRequest constraints);
-  bool       enforceControllersConstraints(mrs_msgs::DynamicsConstraintsSrvRequest& constraints);
+  bool       updateSanitizedConstraints(const bool ignore_controller_limits);
+  void       setConstraints(void);
+  bool       enforceControllersConstraints(mrs_msgs::DynamicsConstraintsSrvRequest& constraints, const ControllerConstraintsLimits& limits);
 
   mrs_msgs::DynamicsConstraintsSrvRequest current_constraints_;
   mrs_msgs::DynamicsConstraintsSrvRequest sanitized_constraints_;
 
+  uint64_t                    current_constraints_version_   = 0;
+  uint64_t                    sanitized_constraints_version_ = 0;
+  uint64_t                    enforced_constraints_version_  = 0;  // the version of the current constraints the sanitized ones were computed from
+  ControllerConstraintsLimits enforced_constraints_limits_;
+
+  // the sanitized constraints version last sent to each plugin, guarded by the tracker and controller list mutexes
+  std::vector<uint64_t> tracker_constraints_version_;
+  std::vector<uint64_t> controller_constraints_version_;
+
   // | ------------------ emergency triggered? ------------------ |
 
   bool failsafe_triggered_ = false;
@@ -653,14 +1037,146 @@ private:
   ros::Timer timer_status_;
   void       timerStatus(const ros::TimerEvent& event);
 
-  // timer for issuing the failsafe landing
-  ros::Timer timer_failsafe_;
-  void       timerFailsafe(const ros::TimerEvent& event);
+  // loop for issuing the failsafe landing
+  // * runs on its own thread with absolute deadlines, so it can not be delayed by the callbacks in the nodelet's queue
+  std::unique_ptr<timing::DeadlineLoop> failsafe_loop_;
+  void                                  failsafeLoop(void);
+  double                                _failsafe_loop_deadline_tolerance_;
+  int                                   _failsafe_loop_priority_;
+
+  // the time base of the deadline loops and of the state watchdog, ROS time with use_sim_time, CLOCK_MONOTONIC otherwise
+  timing::DeadlineClock loop_clock_ = timing::DeadlineClock::monotonic();
+
+  // timer for publishing the timing diagnostics of the loops
+  ros::Timer timer_timing_diagnostics_;
+  void       timerTimingDiagnostics(const ros::TimerEvent& event);
+  double     _timing_diagnostics_rate_;
+
+  static void addDiagnosticValue(diagnostic_msgs::DiagnosticStatus& status, const std::string& key, const std::string& value);
+
+  mrs_lib::PublisherHandler<diagnostic_msgs::DiagnosticArray> ph_timing_diagnostics_;
+
+  // loop for running the control at a fixed rate, instead of once per the received state
+  // * the trackers and controllers are updated with the freshest state (predicted to the publish time when latency_compensation is enabled)
+  // * the jitter of the state's arrivals then does not reach the control output
+  std::unique_ptr<timing::DeadlineLoop> control_output_loop_;
+  void                                  controlOutputLoop(void);
+  bool                                  _fixed_rate_output_enabled_ = false;
+  double                                _fixed_rate_output_rate_;
+  double                                _fixed_rate_output_deadline_tolerance_;
+  int                                   _fixed_rate_output_priority_;
+  std::atomic<uint64_t>                 control_output_skips_ = 0;  // the control was still running from the previous cycle
+
+  // | ---------------------- command queue --------------------- |
+
+  // with command_queue/enabled, the commands of the services and the reference topics, which mutate the trackers and controllers,
+  // are posted to the queue and executed by the control loop between its cycles, the callers wait for the results
+  // * the control cycle then does not contend with the service callbacks for the plugin mutexes
+  // * when no cycle runs for command_queue/fallback_timeout (e.g., missing state), the waiting caller drains the queue itself,
+  //   while holding the control loop's running flag
+  // * the emergency services (ehover, eland, failsafe) bypass the queue, so they are never delayed
+  // * a cycle executes at most command_queue/max_per_cycle commands, the rest waits for the next cycle
+  bool                    _command_queue_enabled_ = false;
+  double                  _command_queue_fallback_timeout_;
+  int                     _command_queue_max_per_cycle_;
+  messaging::CommandQueue command_queue_;
+  std::atomic<uint64_t>   command_queue_fallbacks_ = 0;
+
+  template <typename F>
+  std::invoke_result_t<F> runCommand(F&& command);
+
+  // | ------------------- reference mailboxes ------------------ |
+
+  // with reference_mailbox/enabled, the reference topics only store their newest message (with its arrival time [ns]),
+  // which is applied once per control cycle, so the bursts of a high-rate stream are coalesced instead of being processed one by one
+  // * a message older than reference_mailbox/max_age (e.g., when the control loop stalled) is dropped instead of applied
+  bool   _reference_mailbox_enabled_ = false;
+  double _reference_mailbox_max_age_;
+
+  messaging::Mailbox<std::pair<mrs_msgs::ReferenceStampedConstPtr, int64_t>>         mailbox_reference_;
+  messaging::Mailbox<std::pair<mrs_msgs::VelocityReferenceStampedConstPtr, int64_t>> mailbox_velocity_reference_;
+
+  std::atomic<uint64_t> mailbox_reference_expired_          = 0;
+  std::atomic<uint64_t> mailbox_velocity_reference_expired_ = 0;
+
+  // the time between the arrival of a reference and its application, since the last timing diagnostics
+  std::mutex            mutex_reference_mailbox_latency_;
+  timing::DurationStats reference_mailbox_latency_;
+  timing::DurationStats velocity_reference_mailbox_latency_;
+
+  void applyReferenceMailboxes(void);
+
+  // | -------------- velocity reference fast path -------------- |
+
+  // with velocity_reference_fast_path/enabled, the velocity reference topic is applied by setVelocityReferenceFast()
+  // * the tf from the reference frame to the control frame is looked up once per control cycle (and on a change of the frames)
+  // * the safety area is checked analytically, the position command's distance to the nearest edge of the area (the clearance)
+  //   is computed once per cycle, a stopping point within the clearance is valid together with the straight path to it,
+  //   otherwise (or with the latlon_origin safety frame) the full check is used
+  // * the tracker requests come from a pool, the errors are logged without formatting strings
+  bool _velocity_reference_fast_path_enabled_ = false;
+
+  std::atomic<uint64_t> control_cycle_ = 1;  // incremented by each control cycle, the caches are valid within one cycle
+
+  struct VelocityReferenceCache
+  {
+    uint64_t          cycle = 0;  // 0 = not valid
+    std::string       frame_from;
+    std::string       frame_to;
+    ros::Time         stamp;
+    Eigen::Isometry3d to_control = Eigen::Isometry3d::Identity();
+
+    uint64_t          safety_cycle = 0;
+    bool              safety_valid = false;  // the position command was in the safety area, the clearance is valid
+    Eigen::Isometry3d to_safety    = Eigen::Isometry3d::Identity();
+    Eigen::Vector2d   safety_origin{0, 0};  // the position command in the safety area frame
+    double            clearance = 0;        // [m], horizontal, from the safety_origin
+  };
+
+  std::mutex             mutex_velocity_reference_fast_path_;
+  VelocityReferenceCache velocity_reference_cache_;
+
+  // the edges of the border and the polygon obstacles and the circles of the point obstacles, in the safety area frame
+  bool                                                     velocity_reference_analytic_safety_ = false;
+  std::vector<std::pair<Eigen::Vector2d, Eigen::Vector2d>> safety_area_edges_;
+  std::vector<std::pair<Eigen::Vector2d, double>>          safety_area_circles_;
+
+  messaging::MessagePool<mrs_msgs::VelocityReferenceSrvRequest::Ptr> pool_velocity_reference_request_;
+
+  std::atomic<uint64_t> velocity_reference_fast_path_applied_     = 0;
+  std::atomic<uint64_t> velocity_reference_fast_path_tf_lookups_  = 0;
+  std::atomic<uint64_t> velocity_reference_fast_path_full_checks_ = 0;  // the stopping point was not within the clearance
+
+  bool   setVelocityReferenceFast(const mrs_msgs::VelocityReferenceStamped& reference_in);
+  double safetyAreaClearance(const Eigen::Vector2d& point);
+
+  static Eigen::Isometry3d transformToIsometry(const geometry_msgs::TransformStamped& tf);
 
   // oneshot timer for running controllers and trackers
   void              asyncControl(void);
+  void              startAsyncControl(void);
   std::atomic<bool> running_async_control_ = false;
   std::future<void> async_control_result_;
+  std::mutex        mutex_async_control_result_;
+
+  // | ------------------ latency compensation ------------------ |
+
+  // the state is predicted from its stamp to the expected publish time of the control output
+  // * expected publish time = the start of asyncControl() + the measured processing time (the async spawn, the plugins, publish())
+  // * the latencies are measured regardless of the compensation being enabled
+  std::atomic<bool> latency_compensation_enabled_ = false;
+  double            _latency_compensation_max_;        // [s], the prediction horizon is clamped to this
+  double            _latency_compensation_smoothing_;  // [-]
+
+  ros::ServiceServer service_server_latency_compensation_;
+  bool               callbackLatencyCompensation(std_srvs::SetBool::Request& req, std_srvs::SetBool::Response& res);
+
+  std::mutex mutex_control_latency_;
+  double     control_processing_time_ = 0;  // [s], exponentially weighted, start of asyncControl() -> after publish()
+  double     control_state_age_       = 0;  // [s], exponentially weighted, state stamp -> start of asyncControl()
+  double     control_latency_max_     = 0;  // [s], state stamp -> after publish()
+  double     latency_compensation_dt_ = 0;  // [s], the last applied prediction horizon
+  uint64_t   control_latency_samples_ = 0;
 
   // timer for issuing emergancy landing
   ros::Timer timer_eland_;
@@ -732,9 +1248,7 @@ private:
   LandingStates_t previous_state_landing_ = IDLE_STATE;
   std::mutex      mutex_landing_state_machine_;
   void            changeLandingState(LandingStates_t new_state);
-  double          _uav_mass_ = 0;
-  double          _elanding_cutoff_mass_factor_;
-  double          _elanding_cutoff_timeout_;
+  double          _uav_mass_        = 0;
   double          landing_uav_mass_ = 0;
 
   // initial body disturbance loaded from params
@@ -749,9 +1263,41 @@ private:
   bool _automatic_pc_shutdown_enabled_ = false;
 
   // diagnostics publishing
-  void       publishDiagnostics(void);
+  void       publishDiagnostics(const bool forced);
   std::mutex mutex_diagnostics_;
 
+  // change-driven diagnostics: publish on state change, otherwise only with the heartbeat
+  bool   _diagnostics_change_driven_  = false;
+  double _diagnostics_heartbeat_rate_ = 1.0;
+
+  mrs_msgs::ControlManagerDiagnostics last_diagnostics_;
+  ros::Time                           last_diagnostics_time_;
+  bool                                got_last_diagnostics_ = false;
+
+  bool diagnosticsChanged(const mrs_msgs::ControlManagerDiagnostics& current, const mrs_msgs::ControlManagerDiagnostics& previous);
+
+  // | ----------------------- state board ---------------------- |
+
+  // in-process copy of the diagnostics for the managers loaded in the same nodelet manager
+  bool                     _state_board_enabled_ = false;
+  state_board::StateBoard* state_board_          = nullptr;
+  std::vector<int>         tracker_ids_;      // interned _tracker_names_
+  std::vector<int>         controller_ids_;   // interned _controller_names_
+  state_board::InternCache board_estimator_;  // the horizontal estimator of the UAV state, interned only when it changes
+
+  // the in-process counterparts of the services used by the UavManager
+  // * executed by the services' callback queue, the same as the service calls, the caller waits for the result
+  // * the commands hold the lifetime token, the destructor expires it (after the running commands finish), the expired commands fail
+  struct CommandsLifetime
+  {
+    std::shared_mutex mutex;
+    bool              alive = true;
+  };
+
+  std::shared_ptr<CommandsLifetime> commands_lifetime_ = std::make_shared<CommandsLifetime>();
+
+  std::shared_ptr<const state_board::ControlManagerCommands> createCommands(void);
+
   void                                             ungripSrv(void);
   mrs_lib::ServiceClientHandler<std_srvs::Trigger> sch_ungrip_;
 
@@ -829,7 +1375,7 @@ private:
   std::string resolveFrameName(const std::string in);
 
   // this is called to update the trackers and to receive position control command from the active one
-  void updateTrackers(void);
+  void updateTrackers(const mrs_msgs::UavState& uav_state);
 
   // this is called to update the controllers and to receive attitude control command from the active one
   void updateControllers(mrs_msgs::UavState uav_state_for_control);
@@ -887,6 +1433,53 @@ private:
 
 //}
 
+/* //{ ~ControlManager() */
+
+ControlManager::~ControlManager(void) {
+
+  // the other managers can not call the commands anymore, the running ones finish first
+  if (_state_board_enabled_) {
+    state_board_->setControlManagerCommands(nullptr);
+  }
+
+  {
+    std::unique_lock lock(commands_lifetime_->mutex);
+
+    commands_lifetime_->alive = false;
+  }
+
+  // the threads, which call the members, are stopped before any member is destroyed
+  is_initialized_ = false;
+
+  control_output_loop_.reset();
+  state_watchdog_loop_.reset();
+  failsafe_loop_.reset();
+
+  state_queue_running_ = false;
+
+  for (auto& thread : state_queue_threads_) {
+    thread.join();
+  }
+
+  state_queue_threads_.clear();
+
+  for (auto& spinner : spinners_) {
+    spinner->stop();
+  }
+
+  spinners_.clear();
+
+  {
+    std::scoped_lock lock(mutex_async_control_result_);
+
+    if (async_control_result_.valid()) {
+      async_control_result_.wait();
+    }
+  }
+}
+
+//}
+
 /* //{ onInit() */
 
 void ControlManager::onInit() {
@@ -895,6 +1488,23 @@ void ControlManager::onInit() {
 
   ros::Time::waitForValid();
 
+  // with use_sim_time, the loops follow the simulated clock (e.g., a paused simulation or a real-time factor other than 1)
+  if (ros::Time::isSimTime()) {
+
+    loop_clock_.now = []() { return int64_t(ros::Time::now().toNSec()); };
+
+    // polled as by ros::Time::sleepUntil(), but in single steps, so a stopped loop does not wait for a paused simulation
+    loop_clock_.sleep_until = [](const int64_t deadline) {
+      if (int64_t(ros::Time::now().toNSec()) >= deadline) {
+        return true;
+      }
+
+      ros::WallDuration(0.001).sleep();
+
+      return int64_t(ros::Time::now().toNSec()) >= deadline;
+    };
+  }
+
   joystick_start_press_time_      = ros::Time(0);
   joystick_failsafe_press_time_   = ros::Time(0);
   joystick_eland_press_time_      = ros::Time(0);
@@ -938,11 +1548,18 @@ void ControlManager::onInit() {
   param_loader.loadParam("safety/failsafe_controller", _failsafe_controller_name_);
 
   param_loader.loadParam("safety/eland/controller", _eland_controller_name_);
-  param_loader.loadParam("safety/eland/cutoff_mass_factor", _elanding_cutoff_mass_factor_);
-  param_loader.loadParam("safety/eland/cutoff_timeout", _elanding_cutoff_timeout_);
   param_loader.loadParam("safety/eland/timer_rate", _elanding_timer_rate_);
   param_loader.loadParam("safety/eland/disarm", _eland_disarm_enabled_);
 
+  landing::loadParams(param_loader, _landing_detector_params_);
+
+  if (!_landing_detector_params_.valid()) {
+    ROS_ERROR("[ControlManager]: the landing_detector parameters are not valid");
+    ros::shutdown();
+  }
+
+  landing_detector_ = landing::LandingDetector(_landing_detector_params_);
+
   param_loader.loadParam("safety/escalating_failsafe/service/enabled", _service_escalating_failsafe_enabled_);
   param_loader.loadParam("safety/escalating_failsafe/rc/enabled", _rc_escalating_failsafe_enabled_);
   param_loader.loadParam("safety/escalating_failsafe/rc/channel_number", _rc_escalating_failsafe_channel_);
@@ -977,62 +1594,207 @@ void ControlManager::onInit() {
   }
 
   param_loader.loadParam("status_timer_rate", _status_timer_rate_);
+  param_loader.loadParam("diagnostics/change_driven/enabled", _diagnostics_change_driven_);
+  param_loader.loadParam("diagnostics/change_driven/heartbeat_rate", _diagnostics_heartbeat_rate_);
+  param_loader.loadParam("state_board/enabled", _state_board_enabled_);
+
+  if (_diagnostics_change_driven_ && _diagnostics_heartbeat_rate_ <= 0) {
+    ROS_ERROR("[ControlManager]: diagnostics/change_driven/heartbeat_rate has to be > 0");
+    ros::shutdown();
+  }
   param_loader.loadParam("safety/safety_timer_rate", _safety_timer_rate_);
   param_loader.loadParam("safety/failsafe_timer_rate", _failsafe_timer_rate_);
-  param_loader.loadParam("safety/rc_emergency_handoff/enabled", _rc_emergency_handoff_);
+  param_loader.loadParam("safety/failsafe_loop/deadline_tolerance", _failsafe_loop_deadline_tolerance_);
+  param_loader.loadParam("safety/failsafe_loop/priority", _failsafe_loop_priority_);
+  param_loader.loadParam("timing_diagnostics/rate", _timing_diagnostics_rate_);
+
+  double input_timing_smoothing;
+  int    input_timing_min_samples;
+  param_loader.loadParam("input_timing/smoothing", input_timing_smoothing);
+  param_loader.loadParam("input_timing/min_samples", input_timing_min_samples);
+  param_loader.loadParam("input_timing/hiccup_factor", _input_timing_hiccup_factor_);
+
+  if (input_timing_smoothing <= 0 || input_timing_smoothing > 1 || input_timing_min_samples < 1) {
+    ROS_ERROR("[ControlManager]: input_timing/smoothing has to be in (0, 1] and input_timing/min_samples >= 1");
+    ros::shutdown();
+  }
 
-  param_loader.loadParam("uav_mass", _uav_mass_);
+  _input_timing_min_samples_ = uint64_t(input_timing_min_samples);
 
-  param_loader.loadParam("safety/odometry_max_missing_time", _uav_state_max_missing_time_);
-  param_loader.loadParam("safety/odometry_innovation_eland/enabled", _odometry_innovation_check_enabled_);
+  for (auto& input_timing : input_timing_) {
+    input_timing = std::make_unique<timing::InputTiming>(input_timing_smoothing);
+  }
 
-  param_loader.loadParam("safety/tilt_error_disarm/enabled", _tilt_error_disarm_enabled_);
-  param_loader.loadParam("safety/tilt_error_disarm/timeout", _tilt_error_disarm_timeout_);
-  param_loader.loadParam("safety/tilt_error_disarm/error_threshold", _tilt_error_disarm_threshold_);
+  param_loader.loadParam("reference_mailbox/enabled", _reference_mailbox_enabled_);
+  param_loader.loadParam("reference_mailbox/max_age", _reference_mailbox_max_age_);
 
-  if (_tilt_error_disarm_enabled_ && fabs(_tilt_error_disarm_threshold_) < 1e-3) {
-    ROS_ERROR("[ControlManager]: safety/tilt_error_disarm/enabled = 'TRUE' but the limit is too low");
+  if (_reference_mailbox_enabled_ && _reference_mailbox_max_age_ <= 0) {
+    ROS_ERROR("[ControlManager]: reference_mailbox/max_age has to be > 0");
     ros::shutdown();
   }
 
-  // default constraints
+  param_loader.loadParam("velocity_reference_fast_path/enabled", _velocity_reference_fast_path_enabled_);
 
-  param_loader.loadParam("default_constraints/horizontal/speed", current_constraints_.constraints.horizontal_speed);
-  param_loader.loadParam("default_constraints/horizontal/acceleration", current_constraints_.constraints.horizontal_acceleration);
-  param_loader.loadParam("default_constraints/horizontal/jerk", current_constraints_.constraints.horizontal_jerk);
-  param_loader.loadParam("default_constraints/horizontal/snap", current_constraints_.constraints.horizontal_snap);
+  param_loader.loadParam("command_queue/enabled", _command_queue_enabled_);
+  param_loader.loadParam("command_queue/fallback_timeout", _command_queue_fallback_timeout_);
+  param_loader.loadParam("command_queue/max_per_cycle", _command_queue_max_per_cycle_);
 
-  param_loader.loadParam("default_constraints/vertical/ascending/speed", current_constraints_.constraints.vertical_ascending_speed);
-  param_loader.loadParam("default_constraints/vertical/ascending/acceleration", current_constraints_.constraints.vertical_ascending_acceleration);
-  param_loader.loadParam("default_constraints/vertical/ascending/jerk", current_constraints_.constraints.vertical_ascending_jerk);
-  param_loader.loadParam("default_constraints/vertical/ascending/snap", current_constraints_.constraints.vertical_ascending_snap);
+  if (_command_queue_enabled_ && _command_queue_fallback_timeout_ <= 0) {
+    ROS_ERROR("[ControlManager]: command_queue/fallback_timeout has to be > 0");
+    ros::shutdown();
+  }
 
-  param_loader.loadParam("default_constraints/vertical/descending/speed", current_constraints_.constraints.vertical_descending_speed);
-  param_loader.loadParam("default_constraints/vertical/descending/acceleration", current_constraints_.constraints.vertical_descending_acceleration);
-  param_loader.loadParam("default_constraints/vertical/descending/jerk", current_constraints_.constraints.vertical_descending_jerk);
-  param_loader.loadParam("default_constraints/vertical/descending/snap", current_constraints_.constraints.vertical_descending_snap);
+  if (_command_queue_enabled_ && _command_queue_max_per_cycle_ <= 0) {
+    ROS_ERROR("[ControlManager]: command_queue/max_per_cycle has to be > 0");
+    ros::shutdown();
+  }
 
-  param_loader.loadParam("default_constraints/heading/speed", current_constraints_.constraints.heading_speed);
-  param_loader.loadParam("default_constraints/heading/acceleration", current_constraints_.constraints.heading_acceleration);
-  param_loader.loadParam("default_constraints/heading/jerk", current_constraints_.constraints.heading_jerk);
-  param_loader.loadParam("default_constraints/heading/snap", current_constraints_.constraints.heading_snap);
+  param_loader.loadParam("fixed_rate_output/enabled", _fixed_rate_output_enabled_);
+  param_loader.loadParam("fixed_rate_output/rate", _fixed_rate_output_rate_);
+  param_loader.loadParam("fixed_rate_output/deadline_tolerance", _fixed_rate_output_deadline_tolerance_);
+  param_loader.loadParam("fixed_rate_output/priority", _fixed_rate_output_priority_);
 
-  param_loader.loadParam("default_constraints/angular_speed/roll", current_constraints_.constraints.roll_rate);
-  param_loader.loadParam("default_constraints/angular_speed/pitch", current_constraints_.constraints.pitch_rate);
-  param_loader.loadParam("default_constraints/angular_speed/yaw", current_constraints_.constraints.yaw_rate);
+  if (_fixed_rate_output_enabled_ && _fixed_rate_output_rate_ <= 0) {
+    ROS_ERROR("[ControlManager]: fixed_rate_output/rate has to be > 0");
+    ros::shutdown();
+  }
+  param_loader.loadParam("safety/rc_emergency_handoff/enabled", _rc_emergency_handoff_);
 
-  param_loader.loadParam("default_constraints/tilt", current_constraints_.constraints.tilt);
+  param_loader.loadParam("uav_mass", _uav_mass_);
 
-  // joystick
+  param_loader.loadParam("safety/odometry_max_missing_time", _uav_state_max_missing_time_);
 
-  param_loader.loadParam("joystick/enabled", _joystick_enabled_);
-  param_loader.loadParam("joystick/mode", _joystick_mode_);
-  param_loader.loadParam("joystick/carrot_distance", _joystick_carrot_distance_);
-  param_loader.loadParam("joystick/joystick_timer_rate", _joystick_timer_rate_);
-  param_loader.loadParam("joystick/attitude_control/tracker", _joystick_tracker_name_);
-  param_loader.loadParam("joystick/attitude_control/controller", _joystick_controller_name_);
-  param_loader.loadParam("joystick/attitude_control/fallback/tracker", _joystick_fallback_tracker_name_);
-  param_loader.loadParam("joystick/attitude_control/fallback/controller", _joystick_fallback_controller_name_);
+  bool latency_compensation_enabled;
+  param_loader.loadParam("latency_compensation/enabled", latency_compensation_enabled);
+  param_loader.loadParam("latency_compensation/max_compensation", _latency_compensation_max_);
+  param_loader.loadParam("latency_compensation/smoothing", _latency_compensation_smoothing_);
+
+  latency_compensation_enabled_ = latency_compensation_enabled;
+
+  if (_latency_compensation_max_ < 0 || _latency_compensation_smoothing_ <= 0 || _latency_compensation_smoothing_ > 1) {
+    ROS_ERROR("[ControlManager]: latency_compensation/max_compensation has to be >= 0 and latency_compensation/smoothing in (0, 1]");
+    ros::shutdown();
+  }
+
+  param_loader.loadParam("safety/state_watchdog/enabled", _state_watchdog_enabled_);
+  param_loader.loadParam("safety/state_watchdog/rate", _state_watchdog_rate_);
+  param_loader.loadParam("safety/state_watchdog/smoothing", _state_watchdog_params_.smoothing);
+  param_loader.loadParam("safety/state_watchdog/deadline_sigma", _state_watchdog_params_.deadline_sigma);
+  param_loader.loadParam("safety/state_watchdog/min_deadline", _state_watchdog_params_.min_deadline);
+  param_loader.loadParam("safety/state_watchdog/max_deadline", _state_watchdog_params_.max_deadline);
+
+  {
+    int min_samples;
+    param_loader.loadParam("safety/state_watchdog/min_samples", min_samples);
+    _state_watchdog_params_.min_samples = std::max(min_samples, 0);
+  }
+
+  std::vector<std::string> state_watchdog_actions;
+  param_loader.loadParam("safety/state_watchdog/ladder/actions", state_watchdog_actions);
+  param_loader.loadParam("safety/state_watchdog/ladder/deadlines", _state_watchdog_params_.ladder);
+
+  if (_state_watchdog_enabled_) {
+
+    if (state_watchdog_actions.empty() || state_watchdog_actions.size() != _state_watchdog_params_.ladder.size()) {
+      ROS_ERROR("[ControlManager]: safety/state_watchdog/ladder: the actions and the deadlines have to be non-empty lists of the same length");
+      ros::shutdown();
+    }
+
+    for (size_t i = 0; i < state_watchdog_actions.size(); i++) {
+
+      int action = -1;
+
+      for (int j = 0; j <= WATCHDOG_FAILSAFE; j++) {
+        if (state_watchdog_actions[i] == state_watchdog_action_names[j]) {
+          action = j;
+        }
+      }
+
+      if (action == -1) {
+        ROS_ERROR("[ControlManager]: safety/state_watchdog/ladder: unknown action '%s'", state_watchdog_actions[i].c_str());
+        ros::shutdown();
+      }
+
+      if (action == WATCHDOG_EXTRAPOLATE && _state_watchdog_extrapolate_step_ == -1) {
+        _state_watchdog_extrapolate_step_ = int(i);
+      }
+
+      _state_watchdog_actions_.push_back(StateWatchdogAction_t(action));
+    }
+
+    // the escalation has to end by eland or failsafe
+    _state_watchdog_params_.ladder_terminal =
+        !_state_watchdog_actions_.empty() && (_state_watchdog_actions_.back() == WATCHDOG_ELAND || _state_watchdog_actions_.back() == WATCHDOG_FAILSAFE);
+
+    // before the deadline is learned, the last step is reached after odometry_max_missing_time
+    if (!_state_watchdog_params_.ladder.empty()) {
+      _state_watchdog_params_.initial_deadline = _uav_state_max_missing_time_ / _state_watchdog_params_.ladder.back();
+    }
+
+    if (!_state_watchdog_params_.valid() || _state_watchdog_rate_ <= 0) {
+      ROS_ERROR("[ControlManager]: safety/state_watchdog: invalid params (increasing ladder deadlines and a final eland or failsafe action are required)");
+      ros::shutdown();
+    }
+
+    state_watchdog_ = timing::ArrivalWatchdog(_state_watchdog_params_);
+  }
+  param_loader.loadParam("safety/odometry_innovation_eland/enabled", _odometry_innovation_check_enabled_);
+
+  safety_limits_.tilt_limit_eland_enabled  = _tilt_limit_eland_enabled_;
+  safety_limits_.tilt_limit_eland          = _tilt_limit_eland_;
+  safety_limits_.tilt_limit_disarm_enabled = _tilt_limit_disarm_enabled_;
+  safety_limits_.tilt_limit_disarm         = _tilt_limit_disarm_;
+  safety_limits_.yaw_error_eland_enabled   = _yaw_error_eland_enabled_;
+  safety_limits_.yaw_error_eland           = _yaw_error_eland_;
+  safety_limits_.odometry_innovation_check = _odometry_innovation_check_enabled_;
+
+  param_loader.loadParam("safety/tilt_error_disarm/enabled", _tilt_error_disarm_enabled_);
+  param_loader.loadParam("safety/tilt_error_disarm/timeout", _tilt_error_disarm_timeout_);
+  param_loader.loadParam("safety/tilt_error_disarm/error_threshold", _tilt_error_disarm_threshold_);
+
+  if (_tilt_error_disarm_enabled_ && fabs(_tilt_error_disarm_threshold_) < 1e-3) {
+    ROS_ERROR("[ControlManager]: safety/tilt_error_disarm/enabled = 'TRUE' but the limit is too low");
+    ros::shutdown();
+  }
+
+  // default constraints
+
+  param_loader.loadParam("default_constraints/horizontal/speed", current_constraints_.constraints.horizontal_speed);
+  param_loader.loadParam("default_constraints/horizontal/acceleration", current_constraints_.constraints.horizontal_acceleration);
+  param_loader.loadParam("default_constraints/horizontal/jerk", current_constraints_.constraints.horizontal_jerk);
+  param_loader.loadParam("default_constraints/horizontal/snap", current_constraints_.constraints.horizontal_snap);
+
+  param_loader.loadParam("default_constraints/vertical/ascending/speed", current_constraints_.constraints.vertical_ascending_speed);
+  param_loader.loadParam("default_constraints/vertical/ascending/acceleration", current_constraints_.constraints.vertical_ascending_acceleration);
+  param_loader.loadParam("default_constraints/vertical/ascending/jerk", current_constraints_.constraints.vertical_ascending_jerk);
+  param_loader.loadParam("default_constraints/vertical/ascending/snap", current_constraints_.constraints.vertical_ascending_snap);
+
+  param_loader.loadParam("default_constraints/vertical/descending/speed", current_constraints_.constraints.vertical_descending_speed);
+  param_loader.loadParam("default_constraints/vertical/descending/acceleration", current_constraints_.constraints.vertical_descending_acceleration);
+  param_loader.loadParam("default_constraints/vertical/descending/jerk", current_constraints_.constraints.vertical_descending_jerk);
+  param_loader.loadParam("default_constraints/vertical/descending/snap", current_constraints_.constraints.vertical_descending_snap);
+
+  param_loader.loadParam("default_constraints/heading/speed", current_constraints_.constraints.heading_speed);
+  param_loader.loadParam("default_constraints/heading/acceleration", current_constraints_.constraints.heading_acceleration);
+  param_loader.loadParam("default_constraints/heading/jerk", current_constraints_.constraints.heading_jerk);
+  param_loader.loadParam("default_constraints/heading/snap", current_constraints_.constraints.heading_snap);
+
+  param_loader.loadParam("default_constraints/angular_speed/roll", current_constraints_.constraints.roll_rate);
+  param_loader.loadParam("default_constraints/angular_speed/pitch", current_constraints_.constraints.pitch_rate);
+  param_loader.loadParam("default_constraints/angular_speed/yaw", current_constraints_.constraints.yaw_rate);
+
+  param_loader.loadParam("default_constraints/tilt", current_constraints_.constraints.tilt);
+
+  // joystick
+
+  param_loader.loadParam("joystick/enabled", _joystick_enabled_);
+  param_loader.loadParam("joystick/mode", _joystick_mode_);
+  param_loader.loadParam("joystick/carrot_distance", _joystick_carrot_distance_);
+  param_loader.loadParam("joystick/joystick_timer_rate", _joystick_timer_rate_);
+  param_loader.loadParam("joystick/attitude_control/tracker", _joystick_tracker_name_);
+  param_loader.loadParam("joystick/attitude_control/controller", _joystick_controller_name_);
+  param_loader.loadParam("joystick/attitude_control/fallback/tracker", _joystick_fallback_tracker_name_);
+  param_loader.loadParam("joystick/attitude_control/fallback/controller", _joystick_fallback_controller_name_);
 
   param_loader.loadParam("joystick/channels/A", _channel_A_);
   param_loader.loadParam("joystick/channels/B", _channel_B_);
@@ -1219,6 +1981,52 @@ void ControlManager::onInit() {
       ros::shutdown();
     }
 
+    // the geometry for the analytic check of the velocity references, the distances are not metric in the latlon_origin frame
+    if (safety_zone_ && _safety_area_frame_ != "latlon_origin") {
+
+      auto add_edges = [&](const std::vector<geometry_msgs::Point>& points) {
+        for (size_t i = 0; i < points.size(); i++) {
+          const geometry_msgs::Point& a = points[i];
+          const geometry_msgs::Point& b = points[(i + 1) % points.size()];
+          safety_area_edges_.push_back({Eigen::Vector2d(a.x, a.y), Eigen::Vector2d(b.x, b.y)});
+        }
+      };
+
+      add_edges(safety_zone_->getBorder().getPointMessageVector(0));
+
+      for (auto& polygon : safety_zone_->getObstacles()) {
+        add_edges(polygon.getPointMessageVector(0));
+      }
+
+      // a point obstacle is a cylinder, it is treated as infinitely high
+      for (auto& point : safety_zone_->getPointObstacles()) {
+
+        std::vector<geometry_msgs::Point> points = point.getPointMessageVector(0);
+
+        if (points.empty()) {
+          continue;
+        }
+
+        Eigen::Vector2d center(0, 0);
+
+        for (auto& p : points) {
+          center += Eigen::Vector2d(p.x, p.y);
+        }
+
+        center /= double(points.size());
+
+        double radius = 0;
+
+        for (auto& p : points) {
+          radius = std::max(radius, (Eigen::Vector2d(p.x, p.y) - center).norm());
+        }
+
+        safety_area_circles_.push_back({center, radius});
+      }
+
+      velocity_reference_analytic_safety_ = true;
+    }
+
     ROS_INFO("[ControlManager]: safety area initialized");
   }
 
@@ -1260,7 +2068,12 @@ void ControlManager::onInit() {
     param_loader.loadParam(tracker_name + "/human_switchable", human_switchable, false);
 
     TrackerParams new_tracker(address, human_switchable);
-    trackers_.insert(std::pair<std::string, TrackerParams>(tracker_name, new_tracker));
+
+    if (!trackers_.add(tracker_name, new_tracker)) {
+      ROS_ERROR("[ControlManager]: the tracker '%s' is listed more than once", tracker_name.c_str());
+      ros::shutdown();
+      continue;
+    }
 
     try {
       ROS_INFO("[ControlManager]: loading the tracker '%s'", new_tracker.address.c_str());
@@ -1278,15 +2091,14 @@ void ControlManager::onInit() {
     }
   }
 
+  trackers_.compile();
+
   ROS_INFO("[ControlManager]: trackers were loaded");
 
   for (int i = 0; i < int(tracker_list_.size()); i++) {
 
-    std::map<std::string, TrackerParams>::iterator it;
-    it = trackers_.find(_tracker_names_[i]);
-
     try {
-      ROS_INFO("[ControlManager]: initializing the tracker '%s'", it->second.address.c_str());
+      ROS_INFO("[ControlManager]: initializing the tracker '%s'", trackers_.params(i).address.c_str());
       tracker_list_[i]->initialize(nh_, _uav_name_, common_handlers_);
     }
     catch (std::runtime_error& ex) {
@@ -1334,7 +2146,12 @@ void ControlManager::onInit() {
     }
 
     ControllerParams new_controller(address, name_space, eland_threshold, failsafe_threshold, odometry_innovation_threshold, human_switchable);
-    controllers_.insert(std::pair<std::string, ControllerParams>(controller_name, new_controller));
+
+    if (!controllers_.add(controller_name, new_controller)) {
+      ROS_ERROR("[ControlManager]: the controller '%s' is listed more than once", controller_name.c_str());
+      ros::shutdown();
+      continue;
+    }
 
     try {
       ROS_INFO("[ControlManager]: loading the controller '%s'", new_controller.address.c_str());
@@ -1352,16 +2169,22 @@ void ControlManager::onInit() {
     }
   }
 
+  controllers_.compile();
+
+  for (int i = 0; i < controllers_.size(); i++) {
+
+    const ControllerParams& params = controllers_.params(i);
+
+    safety_thresholds_table_.push_back(safety::SafetyThresholds{params.eland_threshold, params.failsafe_threshold, params.odometry_innovation_threshold});
+  }
+
   ROS_INFO("[ControlManager]: controllers were loaded");
 
   for (int i = 0; i < int(controller_list_.size()); i++) {
 
     try {
-      std::map<std::string, ControllerParams>::iterator it;
-      it = controllers_.find(_controller_names_[i]);
-
-      ROS_INFO("[ControlManager]: initializing the controller '%s'", it->second.address.c_str());
-      controller_list_[i]->initialize(nh_, _controller_names_[i], it->second.name_space, _uav_mass_, common_handlers_);
+      ROS_INFO("[ControlManager]: initializing the controller '%s'", controllers_.params(i).address.c_str());
+      controller_list_[i]->initialize(nh_, _controller_names_[i], controllers_.params(i).name_space, _uav_mass_, common_handlers_);
     }
     catch (std::runtime_error& ex) {
       ROS_ERROR("[ControlManager]: exception caught during controller initialization: '%s'", ex.what());
@@ -1375,55 +2198,25 @@ void ControlManager::onInit() {
   // --------------------------------------------------------------
 
   // check if the hover_tracker is within the loaded trackers
-  bool hover_tracker_check = false;
-
-  for (int i = 0; i < int(_tracker_names_.size()); i++) {
-
-    std::string tracker_name = _tracker_names_[i];
+  _ehover_tracker_idx_ = trackers_.find(_ehover_tracker_name_);
 
-    if (tracker_name == _ehover_tracker_name_) {
-      hover_tracker_check  = true;
-      _ehover_tracker_idx_ = i;
-      break;
-    }
-  }
-  if (!hover_tracker_check) {
+  if (_ehover_tracker_idx_ < 0) {
     ROS_ERROR("[ControlManager]: the safety/hover_tracker (%s) is not within the loaded trackers", _ehover_tracker_name_.c_str());
     ros::shutdown();
   }
 
   // check if the failsafe controller is within the loaded controllers
-  bool failsafe_controller_check = false;
+  _failsafe_controller_idx_ = controllers_.find(_failsafe_controller_name_);
 
-  for (int i = 0; i < int(_controller_names_.size()); i++) {
-
-    std::string controller_name = _controller_names_[i];
-
-    if (controller_name == _failsafe_controller_name_) {
-      failsafe_controller_check = true;
-      _failsafe_controller_idx_ = i;
-      break;
-    }
-  }
-  if (!failsafe_controller_check) {
+  if (_failsafe_controller_idx_ < 0) {
     ROS_ERROR("[ControlManager]: the failsafe controller (%s) is not within the loaded controllers", _failsafe_controller_name_.c_str());
     ros::shutdown();
   }
 
   // check if the eland controller is within the loaded controllers
-  bool eland_controller_check = false;
-
-  for (int i = 0; i < int(_controller_names_.size()); i++) {
-
-    std::string controller_name = _controller_names_[i];
+  _eland_controller_idx_ = controllers_.find(_eland_controller_name_);
 
-    if (controller_name == _eland_controller_name_) {
-      eland_controller_check = true;
-      _eland_controller_idx_ = i;
-      break;
-    }
-  }
-  if (!eland_controller_check) {
+  if (_eland_controller_idx_ < 0) {
     ROS_ERROR("[ControlManager]: the eland controller (%s) is not within the loaded controllers", _eland_controller_name_.c_str());
     ros::shutdown();
   }
@@ -1433,19 +2226,9 @@ void ControlManager::onInit() {
   // --------------------------------------------------------------
 
   // check if the landoff_tracker is within the loaded trackers
-  bool landoff_tracker_check = false;
-
-  for (int i = 0; i < int(_tracker_names_.size()); i++) {
+  _landoff_tracker_idx_ = trackers_.find(_landoff_tracker_name_);
 
-    std::string tracker_name = _tracker_names_[i];
-
-    if (tracker_name == _landoff_tracker_name_) {
-      landoff_tracker_check = true;
-      _landoff_tracker_idx_ = i;
-      break;
-    }
-  }
-  if (!landoff_tracker_check) {
+  if (_landoff_tracker_idx_ < 0) {
     ROS_ERROR("[ControlManager]: the landoff tracker (%s) is not within the loaded trackers", _landoff_tracker_name_.c_str());
     ros::shutdown();
   }
@@ -1455,19 +2238,9 @@ void ControlManager::onInit() {
   // --------------------------------------------------------------
 
   // check if the hover_tracker is within the loaded trackers
-  bool null_tracker_check = false;
-
-  for (int i = 0; i < int(_tracker_names_.size()); i++) {
-
-    std::string tracker_name = _tracker_names_[i];
+  _null_tracker_idx_ = trackers_.find(_null_tracker_name_);
 
-    if (tracker_name == _null_tracker_name_) {
-      null_tracker_check = true;
-      _null_tracker_idx_ = i;
-      break;
-    }
-  }
-  if (!null_tracker_check) {
+  if (_null_tracker_idx_ < 0) {
     ROS_ERROR("[ControlManager]: the null tracker (%s) is not within the loaded trackers", _null_tracker_name_.c_str());
     ros::shutdown();
   }
@@ -1479,37 +2252,17 @@ void ControlManager::onInit() {
   if (_joystick_enabled_) {
 
     // check if the tracker for joystick control exists
-    bool joystick_tracker_check = false;
+    _joystick_tracker_idx_ = trackers_.find(_joystick_tracker_name_);
 
-    for (int i = 0; i < int(_tracker_names_.size()); i++) {
-
-      std::string tracker_name = _tracker_names_[i];
-
-      if (tracker_name == _joystick_tracker_name_) {
-        joystick_tracker_check = true;
-        _joystick_tracker_idx_ = i;
-        break;
-      }
-    }
-    if (!joystick_tracker_check) {
+    if (_joystick_tracker_idx_ < 0) {
       ROS_ERROR("[ControlManager]: the joystick tracker (%s) is not within the loaded trackers", _joystick_tracker_name_.c_str());
       ros::shutdown();
     }
 
     // check if the controller for joystick control exists
-    bool joystick_controller_check = false;
-
-    for (int i = 0; i < int(_controller_names_.size()); i++) {
+    _joystick_controller_idx_ = controllers_.find(_joystick_controller_name_);
 
-      std::string controller_name = _controller_names_[i];
-
-      if (controller_name == _joystick_controller_name_) {
-        joystick_controller_check = true;
-        _joystick_controller_idx_ = i;
-        break;
-      }
-    }
-    if (!joystick_controller_check) {
+    if (_joystick_controller_idx_ < 0) {
       ROS_ERROR("[ControlManager]: the joystick controller (%s) is not within the loaded controllers", _joystick_controller_name_.c_str());
       ros::shutdown();
     }
@@ -1517,18 +2270,9 @@ void ControlManager::onInit() {
     if (_bumper_switch_tracker_) {
 
       // check if the tracker for bumper exists
-      bool bumper_tracker_check = false;
+      _bumper_tracker_idx_ = trackers_.find(_bumper_tracker_name_);
 
-      for (int i = 0; i < int(_tracker_names_.size()); i++) {
-
-        std::string tracker_name = _tracker_names_[i];
-
-        if (tracker_name == _bumper_tracker_name_) {
-          bumper_tracker_check = true;
-          break;
-        }
-      }
-      if (!bumper_tracker_check) {
+      if (_bumper_tracker_idx_ < 0) {
         ROS_ERROR("[ControlManager]: the bumper tracker (%s) is not within the loaded trackers", _bumper_tracker_name_.c_str());
         ros::shutdown();
       }
@@ -1537,55 +2281,26 @@ void ControlManager::onInit() {
     if (_bumper_switch_controller_) {
 
       // check if the controller for bumper exists
-      bool bumper_controller_check = false;
-
-      for (int i = 0; i < int(_controller_names_.size()); i++) {
+      _bumper_controller_idx_ = controllers_.find(_bumper_controller_name_);
 
-        std::string controller_name = _controller_names_[i];
-
-        if (controller_name == _bumper_controller_name_) {
-          bumper_controller_check = true;
-          break;
-        }
-      }
-      if (!bumper_controller_check) {
+      if (_bumper_controller_idx_ < 0) {
         ROS_ERROR("[ControlManager]: the bumper controller (%s) is not within the loaded controllers", _bumper_controller_name_.c_str());
         ros::shutdown();
       }
     }
 
     // check if the fallback tracker for joystick control exists
-    bool joystick_fallback_tracker_check = false;
-
-    for (int i = 0; i < int(_tracker_names_.size()); i++) {
+    _joystick_fallback_tracker_idx_ = trackers_.find(_joystick_fallback_tracker_name_);
 
-      std::string tracker_name = _tracker_names_[i];
-
-      if (tracker_name == _joystick_fallback_tracker_name_) {
-        joystick_fallback_tracker_check = true;
-        _joystick_fallback_tracker_idx_ = i;
-        break;
-      }
-    }
-    if (!joystick_fallback_tracker_check) {
+    if (_joystick_fallback_tracker_idx_ < 0) {
       ROS_ERROR("[ControlManager]: the joystick fallback tracker (%s) is not within the loaded trackers", _joystick_fallback_tracker_name_.c_str());
       ros::shutdown();
     }
 
     // check if the fallback controller for joystick control exists
-    bool joystick_fallback_controller_check = false;
+    _joystick_fallback_controller_idx_ = controllers_.find(_joystick_fallback_controller_name_);
 
-    for (int i = 0; i < int(_controller_names_.size()); i++) {
-
-      std::string controller_name = _controller_names_[i];
-
-      if (controller_name == _joystick_fallback_controller_name_) {
-        joystick_fallback_controller_check = true;
-        _joystick_fallback_controller_idx_ = i;
-        break;
-      }
-    }
-    if (!joystick_fallback_controller_check) {
+    if (_joystick_fallback_controller_idx_ < 0) {
       ROS_ERROR("[ControlManager]: the joystick fallback controller (%s) is not within the loaded controllers", _joystick_fallback_controller_name_.c_str());
       ros::shutdown();
     }
@@ -1608,6 +2323,7 @@ void ControlManager::onInit() {
 
   controller_list_[_eland_controller_idx_]->activate(last_attitude_cmd_);
   active_controller_idx_ = _eland_controller_idx_;
+  installSafetyThresholds(active_controller_idx_);
 
   // update the time
   {
@@ -1620,8 +2336,12 @@ void ControlManager::onInit() {
 
   // | --------------- set the default constraints -------------- |
 
-  sanitized_constraints_ = current_constraints_;
-  setConstraints(current_constraints_);
+  tracker_constraints_version_.resize(tracker_list_.size(), 0);
+  controller_constraints_version_.resize(controller_list_.size(), 0);
+
+  current_constraints_version_ = 1;
+  updateSanitizedConstraints(true);
+  setConstraints();
 
   // | ------------------------ profiler ------------------------ |
 
@@ -1636,6 +2356,7 @@ void ControlManager::onInit() {
   ph_cmd_odom_                           = mrs_lib::PublisherHandler<nav_msgs::Odometry>(nh_, "cmd_odom_out", 1);
   ph_cmd_twist_                          = mrs_lib::PublisherHandler<geometry_msgs::Twist>(nh_, "cmd_twist_out", 1);
   ph_diagnostics_                        = mrs_lib::PublisherHandler<mrs_msgs::ControlManagerDiagnostics>(nh_, "diagnostics_out", 1);
+  ph_timing_diagnostics_                 = mrs_lib::PublisherHandler<diagnostic_msgs::DiagnosticArray>(nh_, "timing_diagnostics_out", 1);
   ph_motors_                             = mrs_lib::PublisherHandler<mrs_msgs::BoolStamped>(nh_, "motors_out", 1);
   ph_offboard_on_                        = mrs_lib::PublisherHandler<std_msgs::Empty>(nh_, "offboard_on_out", 1);
   ph_tilt_error_                         = mrs_lib::PublisherHandler<mrs_msgs::Float64Stamped>(nh_, "tilt_error_out", 1);
@@ -1651,6 +2372,70 @@ void ControlManager::onInit() {
   pub_debug_original_trajectory_poses_   = mrs_lib::PublisherHandler<geometry_msgs::PoseArray>(nh_, "trajectory_original/poses_out", 1, true);
   pub_debug_original_trajectory_markers_ = mrs_lib::PublisherHandler<visualization_msgs::MarkerArray>(nh_, "trajectory_original/markers_out", 1, true);
 
+  // | --------------------- callback queues -------------------- |
+
+  int    callback_queues_state_threads, callback_queues_services_threads, callback_queues_status_threads, callback_queues_state_priority;
+  double callback_queues_probe_rate;
+
+  param_loader.loadParam("callback_queues/enabled", _callback_queues_enabled_);
+  param_loader.loadParam("callback_queues/state_threads", callback_queues_state_threads);
+  param_loader.loadParam("callback_queues/state_priority", callback_queues_state_priority);
+  param_loader.loadParam("callback_queues/services_threads", callback_queues_services_threads);
+  param_loader.loadParam("callback_queues/status_threads", callback_queues_status_threads);
+  param_loader.loadParam("callback_queues/probe_rate", callback_queues_probe_rate);
+
+  if (callback_queues_state_threads < 1 || callback_queues_services_threads < 1 || callback_queues_status_threads < 1 || callback_queues_probe_rate <= 0) {
+    ROS_ERROR("[ControlManager]: callback_queues/*_threads have to be >= 1 and callback_queues/probe_rate > 0");
+    ros::shutdown();
+  }
+
+  if (callback_queues_state_priority < 0 || callback_queues_state_priority > 99) {
+    ROS_ERROR("[ControlManager]: callback_queues/state_priority has to be in [0, 99]");
+    ros::shutdown();
+  }
+
+  nh_state_    = nh_;
+  nh_services_ = nh_;
+  nh_status_   = nh_;
+
+  if (_callback_queues_enabled_) {
+
+    nh_state_.setCallbackQueue(&queue_state_);
+    nh_services_.setCallbackQueue(&queue_services_);
+    nh_status_.setCallbackQueue(&queue_status_);
+
+    state_queue_running_ = true;
+
+    for (int i = 0; i < callback_queues_state_threads; i++) {
+
+      state_queue_threads_.push_back(std::thread(&ControlManager::stateQueueLoop, this));
+
+      if (callback_queues_state_priority > 0 && !timing::setRealtimePriority(state_queue_threads_.back(), callback_queues_state_priority)) {
+        ROS_WARN("[ControlManager]: could not set the real-time priority %d of the state queue (missing CAP_SYS_NICE?), running with the default one",
+                 callback_queues_state_priority);
+      }
+    }
+
+    spinners_.push_back(std::make_unique<ros::AsyncSpinner>(callback_queues_services_threads, &queue_services_));
+    spinners_.push_back(std::make_unique<ros::AsyncSpinner>(callback_queues_status_threads, &queue_status_));
+
+    for (auto& spinner : spinners_) {
+      spinner->start();
+    }
+  }
+
+  {
+    std::array<ros::NodeHandle*, QUEUE_COUNT> queue_handles = {&nh_, &nh_state_, &nh_services_, &nh_status_};
+
+    // without the separate queues, all the handles share the nodelet's queue, which is probed once
+    const int n_probes = _callback_queues_enabled_ ? QUEUE_COUNT : 1;
+
+    for (int i = 0; i < n_probes; i++) {
+      queue_probes_[i].timer = queue_handles[i]->createTimer(ros::Rate(callback_queues_probe_rate),
+                                                             [this, i](const ros::TimerEvent& event) { timerQueueProbe(event, i); });
+    }
+  }
+
   // | ----------------------- subscribers ---------------------- |
 
   ros::Duration uav_state_timeout(_uav_state_max_missing_time_);
@@ -1664,60 +2449,81 @@ void ControlManager::onInit() {
   shopts.queue_size         = 10;
   shopts.transport_hints    = ros::TransportHints().tcpNoDelay();
 
-  if (_state_input_ == INPUT_UAV_STATE) {
-    sh_uav_state_ = mrs_lib::SubscribeHandler<mrs_msgs::UavState>(shopts, "uav_state_in", uav_state_timeout, &ControlManager::timeoutUavState, this,
-                                                                  &ControlManager::callbackUavState, this);
-  } else if (_state_input_ == INPUT_ODOMETRY) {
-    sh_odometry_ = mrs_lib::SubscribeHandler<nav_msgs::Odometry>(shopts, "odometry_in", uav_state_timeout, &ControlManager::timeoutUavState, this,
-                                                                 &ControlManager::callbackOdometry, this);
+  // the hot inputs, served by the state queue
+  mrs_lib::SubscribeHandlerOptions shopts_state = shopts;
+  shopts_state.nh                               = nh_state_;
+
+  // the state watchdog replaces the timeout
+  if (_state_watchdog_enabled_) {
+
+    if (_state_input_ == INPUT_UAV_STATE) {
+      sh_uav_state_ = mrs_lib::SubscribeHandler<mrs_msgs::UavState>(shopts_state, "uav_state_in", &ControlManager::callbackUavState, this);
+    } else if (_state_input_ == INPUT_ODOMETRY) {
+      sh_odometry_ = mrs_lib::SubscribeHandler<nav_msgs::Odometry>(shopts_state, "odometry_in", &ControlManager::callbackOdometry, this);
+    }
+
+  } else {
+
+    if (_state_input_ == INPUT_UAV_STATE) {
+      sh_uav_state_ = mrs_lib::SubscribeHandler<mrs_msgs::UavState>(shopts_state, "uav_state_in", uav_state_timeout, &ControlManager::timeoutUavState, this,
+                                                                    &ControlManager::callbackUavState, this);
+    } else if (_state_input_ == INPUT_ODOMETRY) {
+      sh_odometry_ = mrs_lib::SubscribeHandler<nav_msgs::Odometry>(shopts_state, "odometry_in", uav_state_timeout, &ControlManager::timeoutUavState, this,
+                                                                   &ControlManager::callbackOdometry, this);
+    }
   }
 
   if (_odometry_innovation_check_enabled_) {
     sh_odometry_innovation_ = mrs_lib::SubscribeHandler<nav_msgs::Odometry>(shopts, "odometry_innovation_in");
   }
 
-  sh_pixhawk_odometry_ = mrs_lib::SubscribeHandler<nav_msgs::Odometry>(shopts, "mavros_odometry_in");
-  sh_bumper_           = mrs_lib::SubscribeHandler<mrs_msgs::ObstacleSectors>(shopts, "bumper_sectors_in");
+  sh_pixhawk_odometry_ = mrs_lib::SubscribeHandler<nav_msgs::Odometry>(shopts_state, "mavros_odometry_in", &ControlManager::callbackPixhawkOdometry, this);
+  sh_bumper_           = mrs_lib::SubscribeHandler<mrs_msgs::ObstacleSectors>(shopts, "bumper_sectors_in", &ControlManager::callbackBumper, this);
   sh_max_height_       = mrs_lib::SubscribeHandler<mrs_msgs::Float64Stamped>(shopts, "max_height_in");
   sh_joystick_         = mrs_lib::SubscribeHandler<sensor_msgs::Joy>(shopts, "joystick_in", &ControlManager::callbackJoystick, this);
   sh_mavros_gps_       = mrs_lib::SubscribeHandler<sensor_msgs::NavSatFix>(shopts, "mavros_gps_in", &ControlManager::callbackMavrosGps, this);
-  sh_rc_               = mrs_lib::SubscribeHandler<mavros_msgs::RCIn>(shopts, "rc_in", &ControlManager::callbackRC, this);
+  sh_rc_               = mrs_lib::SubscribeHandler<mavros_msgs::RCIn>(shopts_state, "rc_in", &ControlManager::callbackRC, this);
 
-  sh_mavros_state_ = mrs_lib::SubscribeHandler<mavros_msgs::State>(shopts, "mavros_state_in", ros::Duration(0.05), &ControlManager::timeoutMavrosState, this,
-                                                                   &ControlManager::callbackMavrosState, this);
+  sh_mavros_state_ = mrs_lib::SubscribeHandler<mavros_msgs::State>(shopts_state, "mavros_state_in", ros::Duration(0.05), &ControlManager::timeoutMavrosState,
+                                                                   this, &ControlManager::callbackMavrosState, this);
 
   // | -------------------- general services -------------------- |
 
-  service_server_switch_tracker_             = nh_.advertiseService("switch_tracker_in", &ControlManager::callbackSwitchTracker, this);
-  service_server_switch_controller_          = nh_.advertiseService("switch_controller_in", &ControlManager::callbackSwitchController, this);
-  service_server_reset_tracker_              = nh_.advertiseService("tracker_reset_static_in", &ControlManager::callbackTrackerResetStatic, this);
-  service_server_hover_                      = nh_.advertiseService("hover_in", &ControlManager::callbackHover, this);
-  service_server_ehover_                     = nh_.advertiseService("ehover_in", &ControlManager::callbackEHover, this);
-  service_server_failsafe_                   = nh_.advertiseService("failsafe_in", &ControlManager::callbackFailsafe, this);
-  service_server_failsafe_escalating_        = nh_.advertiseService("failsafe_escalating_in", &ControlManager::callbackFailsafeEscalating, this);
-  service_server_motors_                     = nh_.advertiseService("motors_in", &ControlManager::callbackMotors, this);
-  service_server_arm_                        = nh_.advertiseService("arm_in", &ControlManager::callbackArm, this);
-  service_server_enable_callbacks_           = nh_.advertiseService("enable_callbacks_in", &ControlManager::callbackEnableCallbacks, this);
-  service_server_set_constraints_            = nh_.advertiseService("set_constraints_in", &ControlManager::callbackSetConstraints, this);
-  service_server_use_joystick_               = nh_.advertiseService("use_joystick_in", &ControlManager::callbackUseJoystick, this);
-  service_server_use_safety_area_            = nh_.advertiseService("use_safety_area_in", &ControlManager::callbackUseSafetyArea, this);
-  service_server_eland_                      = nh_.advertiseService("eland_in", &ControlManager::callbackEland, this);
-  service_server_parachute_                  = nh_.advertiseService("parachute_in", &ControlManager::callbackParachute, this);
-  service_server_transform_reference_        = nh_.advertiseService("transform_reference_in", &ControlManager::callbackTransformReference, this);
-  service_server_transform_pose_             = nh_.advertiseService("transform_pose_in", &ControlManager::callbackTransformPose, this);
-  service_server_transform_vector3_          = nh_.advertiseService("transform_vector3_in", &ControlManager::callbackTransformVector3, this);
-  service_server_bumper_enabler_             = nh_.advertiseService("bumper_in", &ControlManager::callbackEnableBumper, this);
-  service_server_bumper_set_params_          = nh_.advertiseService("bumper_set_params_in", &ControlManager::callbackBumperSetParams, this);
-  service_server_bumper_repulsion_enabler_   = nh_.advertiseService("bumper_repulsion_in", &ControlManager::callbackBumperEnableRepulsion, this);
-  service_server_set_min_height_             = nh_.advertiseService("set_min_height_in", &ControlManager::callbackSetMinHeight, this);
-  service_server_get_min_height_             = nh_.advertiseService("get_min_height_in", &ControlManager::callbackGetMinHeight, this);
-  service_server_validate_reference_         = nh_.advertiseService("validate_reference_in", &ControlManager::callbackValidateReference, this);
-  service_server_validate_reference_2d_      = nh_.advertiseService("validate_reference_2d_in", &ControlManager::callbackValidateReference2d, this);
-  service_server_validate_reference_list_    = nh_.advertiseService("validate_reference_list_in", &ControlManager::callbackValidateReferenceList, this);
-  service_server_start_trajectory_tracking_  = nh_.advertiseService("start_trajectory_tracking_in", &ControlManager::callbackStartTrajectoryTracking, this);
-  service_server_stop_trajectory_tracking_   = nh_.advertiseService("stop_trajectory_tracking_in", &ControlManager::callbackStopTrajectoryTracking, this);
-  service_server_resume_trajectory_tracking_ = nh_.advertiseService("resume_trajectory_tracking_in", &ControlManager::callbackResumeTrajectoryTracking, this);
-  service_server_goto_trajectory_start_      = nh_.advertiseService("goto_trajectory_start_in", &ControlManager::callbackGotoTrajectoryStart, this);
+  service_server_switch_tracker_             = nh_services_.advertiseService("switch_tracker_in", &ControlManager::callbackSwitchTracker, this);
+  service_server_switch_controller_          = nh_services_.advertiseService("switch_controller_in", &ControlManager::callbackSwitchController, this);
+  service_server_reset_tracker_              = nh_services_.advertiseService("tracker_reset_static_in", &ControlManager::callbackTrackerResetStatic, this);
+  service_server_hover_                      = nh_services_.advertiseService("hover_in", &ControlManager::callbackHover, this);
+  service_server_ehover_                     = nh_services_.advertiseService("ehover_in", &ControlManager::callbackEHover, this);
+  service_server_failsafe_                   = nh_services_.advertiseService("failsafe_in", &ControlManager::callbackFailsafe, this);
+  service_server_failsafe_escalating_        = nh_services_.advertiseService("failsafe_escalating_in", &ControlManager::callbackFailsafeEscalating, this);
+  service_server_motors_                     = nh_services_.advertiseService("motors_in", &ControlManager::callbackMotors, this);
+  service_server_arm_                        = nh_services_.advertiseService("arm_in", &ControlManager::callbackArm, this);
+  service_server_enable_callbacks_           = nh_services_.advertiseService("enable_callbacks_in", &ControlManager::callbackEnableCallbacks, this);
+  service_server_set_constraints_            = nh_services_.advertiseService("set_constraints_in", &ControlManager::callbackSetConstraints, this);
+  service_server_use_joystick_               = nh_services_.advertiseService("use_joystick_in", &ControlManager::callbackUseJoystick, this);
+  service_server_use_safety_area_            = nh_services_.advertiseService("use_safety_area_in", &ControlManager::callbackUseSafetyArea, this);
+  service_server_eland_                      = nh_services_.advertiseService("eland_in", &ControlManager::callbackEland, this);
+  service_server_parachute_                  = nh_services_.advertiseService("parachute_in", &ControlManager::callbackParachute, this);
+  service_server_transform_reference_        = nh_services_.advertiseService("transform_reference_in", &ControlManager::callbackTransformReference, this);
+  service_server_transform_pose_             = nh_services_.advertiseService("transform_pose_in", &ControlManager::callbackTransformPose, this);
+  service_server_transform_vector3_          = nh_services_.advertiseService("transform_vector3_in", &ControlManager::callbackTransformVector3, this);
+  service_server_bumper_enabler_             = nh_services_.advertiseService("bumper_in", &ControlManager::callbackEnableBumper, this);
+  service_server_latency_compensation_       = nh_services_.advertiseService("latency_compensation_in", &ControlManager::callbackLatencyCompensation, this);
+  service_server_bumper_set_params_          = nh_services_.advertiseService("bumper_set_params_in", &ControlManager::callbackBumperSetParams, this);
+  service_server_bumper_repulsion_enabler_   = nh_services_.advertiseService("bumper_repulsion_in", &ControlManager::callbackBumperEnableRepulsion, this);
+  service_server_set_min_height_             = nh_services_.advertiseService("set_min_height_in", &ControlManager::callbackSetMinHeight, this);
+  service_server_get_min_height_             = nh_services_.advertiseService("get_min_height_in", &ControlManager::callbackGetMinHeight, this);
+  service_server_validate_reference_         = nh_services_.advertiseService("validate_reference_in", &ControlManager::callbackValidateReference, this);
+  service_server_validate_reference_2d_      = nh_services_.advertiseService("validate_reference_2d_in", &ControlManager::callbackValidateReference2d, this);
+  service_server_validate_reference_list_    =
+      nh_services_.advertiseService("validate_reference_list_in", &ControlManager::callbackValidateReferenceList, this);
+  service_server_start_trajectory_tracking_  =
+      nh_services_.advertiseService("start_trajectory_tracking_in", &ControlManager::callbackStartTrajectoryTracking, this);
+  service_server_stop_trajectory_tracking_   =
+      nh_services_.advertiseService("stop_trajectory_tracking_in", &ControlManager::callbackStopTrajectoryTracking, this);
+  service_server_resume_trajectory_tracking_ =
+      nh_services_.advertiseService("resume_trajectory_tracking_in", &ControlManager::callbackResumeTrajectoryTracking, this);
+  service_server_goto_trajectory_start_      = nh_services_.advertiseService("goto_trajectory_start_in", &ControlManager::callbackGotoTrajectoryStart, this);
 
   sch_mavros_command_long_    = mrs_lib::ServiceClientHandler<mavros_msgs::CommandLong>(nh_, "mavros_command_long_out");
   sch_eland_                  = mrs_lib::ServiceClientHandler<std_srvs::Trigger>(nh_, "eland_out");
@@ -1729,38 +2535,85 @@ void ControlManager::onInit() {
   // | ---------------- setpoint command services --------------- |
 
   // human callable
-  service_server_goto_                 = nh_.advertiseService("goto_in", &ControlManager::callbackGoto, this);
-  service_server_goto_fcu_             = nh_.advertiseService("goto_fcu_in", &ControlManager::callbackGotoFcu, this);
-  service_server_goto_relative_        = nh_.advertiseService("goto_relative_in", &ControlManager::callbackGotoRelative, this);
-  service_server_goto_altitude_        = nh_.advertiseService("goto_altitude_in", &ControlManager::callbackGotoAltitude, this);
-  service_server_set_heading_          = nh_.advertiseService("set_heading_in", &ControlManager::callbackSetHeading, this);
-  service_server_set_heading_relative_ = nh_.advertiseService("set_heading_relative_in", &ControlManager::callbackSetHeadingRelative, this);
+  service_server_goto_                 = nh_services_.advertiseService("goto_in", &ControlManager::callbackGoto, this);
+  service_server_goto_fcu_             = nh_services_.advertiseService("goto_fcu_in", &ControlManager::callbackGotoFcu, this);
+  service_server_goto_relative_        = nh_services_.advertiseService("goto_relative_in", &ControlManager::callbackGotoRelative, this);
+  service_server_goto_altitude_        = nh_services_.advertiseService("goto_altitude_in", &ControlManager::callbackGotoAltitude, this);
+  service_server_set_heading_          = nh_services_.advertiseService("set_heading_in", &ControlManager::callbackSetHeading, this);
+  service_server_set_heading_relative_ = nh_services_.advertiseService("set_heading_relative_in", &ControlManager::callbackSetHeadingRelative, this);
 
-  service_server_reference_ = nh_.advertiseService("reference_in", &ControlManager::callbackReferenceService, this);
-  subscriber_reference_     = nh_.subscribe("reference_in", 1, &ControlManager::callbackReferenceTopic, this, ros::TransportHints().tcpNoDelay());
+  service_server_reference_ = nh_services_.advertiseService("reference_in", &ControlManager::callbackReferenceService, this);
+  subscriber_reference_     = nh_services_.subscribe("reference_in", 1, &ControlManager::callbackReferenceTopic, this, ros::TransportHints().tcpNoDelay());
 
-  service_server_velocity_reference_ = nh_.advertiseService("velocity_reference_in", &ControlManager::callbackVelocityReferenceService, this);
+  service_server_velocity_reference_ = nh_services_.advertiseService("velocity_reference_in", &ControlManager::callbackVelocityReferenceService, this);
   subscriber_velocity_reference_ =
-      nh_.subscribe("velocity_reference_in", 1, &ControlManager::callbackVelocityReferenceTopic, this, ros::TransportHints().tcpNoDelay());
+      nh_services_.subscribe("velocity_reference_in", 1, &ControlManager::callbackVelocityReferenceTopic, this, ros::TransportHints().tcpNoDelay());
 
-  service_server_trajectory_reference_ = nh_.advertiseService("trajectory_reference_in", &ControlManager::callbackTrajectoryReferenceService, this);
+  service_server_trajectory_reference_ = nh_services_.advertiseService("trajectory_reference_in", &ControlManager::callbackTrajectoryReferenceService, this);
   subscriber_trajectory_reference_ =
-      nh_.subscribe("trajectory_reference_in", 1, &ControlManager::callbackTrajectoryReferenceTopic, this, ros::TransportHints().tcpNoDelay());
+      nh_services_.subscribe("trajectory_reference_in", 1, &ControlManager::callbackTrajectoryReferenceTopic, this, ros::TransportHints().tcpNoDelay());
 
   // | --------------------- other services --------------------- |
 
-  service_server_emergency_reference_ = nh_.advertiseService("emergency_reference_in", &ControlManager::callbackEmergencyReference, this);
-  service_server_pirouette_           = nh_.advertiseService("pirouette_in", &ControlManager::callbackPirouette, this);
+  service_server_emergency_reference_ = nh_services_.advertiseService("emergency_reference_in", &ControlManager::callbackEmergencyReference, this);
+  service_server_pirouette_           = nh_services_.advertiseService("pirouette_in", &ControlManager::callbackPirouette, this);
 
   // | ------------------------- timers ------------------------- |
 
-  timer_status_    = nh_.createTimer(ros::Rate(_status_timer_rate_), &ControlManager::timerStatus, this);
+  timer_status_    = nh_status_.createTimer(ros::Rate(_status_timer_rate_), &ControlManager::timerStatus, this);
   timer_safety_    = nh_.createTimer(ros::Rate(_safety_timer_rate_), &ControlManager::timerSafety, this);
-  timer_bumper_    = nh_.createTimer(ros::Rate(_bumper_timer_rate_), &ControlManager::timerBumper, this);
+  timer_bumper_    = nh_status_.createTimer(ros::Rate(_bumper_timer_rate_), &ControlManager::timerBumper, this);
   timer_eland_     = nh_.createTimer(ros::Rate(_elanding_timer_rate_), &ControlManager::timerEland, this, false, false);
-  timer_failsafe_  = nh_.createTimer(ros::Rate(_failsafe_timer_rate_), &ControlManager::timerFailsafe, this, false, false);
   timer_pirouette_ = nh_.createTimer(ros::Rate(_pirouette_timer_rate_), &ControlManager::timerPirouette, this, false, false);
-  timer_joystick_  = nh_.createTimer(ros::Rate(_joystick_timer_rate_), &ControlManager::timerJoystick, this);
+  timer_joystick_  = nh_status_.createTimer(ros::Rate(_joystick_timer_rate_), &ControlManager::timerJoystick, this);
+
+  timer_timing_diagnostics_ = nh_status_.createTimer(ros::Rate(_timing_diagnostics_rate_), &ControlManager::timerTimingDiagnostics, this);
+
+  failsafe_loop_ = std::make_unique<timing::DeadlineLoop>([this]() { failsafeLoop(); }, _failsafe_timer_rate_, _failsafe_loop_deadline_tolerance_,
+                                                          _failsafe_loop_priority_, loop_clock_);
+
+  if (!failsafe_loop_->realtime()) {
+    ROS_WARN("[ControlManager]: could not set the real-time priority %d of the failsafe loop (missing CAP_SYS_NICE?), running with the default one",
+             _failsafe_loop_priority_);
+  }
+
+  if (_state_watchdog_enabled_) {
+
+    state_watchdog_loop_ =
+        std::make_unique<timing::DeadlineLoop>([this]() { stateWatchdogLoop(); }, _state_watchdog_rate_, 0.5 / _state_watchdog_rate_, 0, loop_clock_);
+
+    state_watchdog_loop_->start();
+  }
+
+  if (_fixed_rate_output_enabled_) {
+
+    control_output_loop_ = std::make_unique<timing::DeadlineLoop>([this]() { controlOutputLoop(); }, _fixed_rate_output_rate_,
+                                                                  _fixed_rate_output_deadline_tolerance_, _fixed_rate_output_priority_, loop_clock_);
+
+    if (!control_output_loop_->realtime()) {
+      ROS_WARN("[ControlManager]: could not set the real-time priority %d of the control output loop (missing CAP_SYS_NICE?), running with the default one",
+               _fixed_rate_output_priority_);
+    }
+
+    control_output_loop_->start();
+
+    ROS_INFO("[ControlManager]: the control output runs at a fixed rate of %.1f Hz", _fixed_rate_output_rate_);
+  }
+
+  // | ----------------------- state board ---------------------- |
+
+  if (_state_board_enabled_) {
+
+    state_board_ = &state_board::getStateBoard(ros::names::parentNamespace(nh_.getNamespace()));
+
+    for (int i = 0; i < int(_tracker_names_.size()); i++) {
+      tracker_ids_.push_back(state_board_->names.intern(_tracker_names_[i]));
+    }
+
+    for (int i = 0; i < int(_controller_names_.size()); i++) {
+      controller_ids_.push_back(state_board_->names.intern(_controller_names_[i]));
+    }
+  }
 
   // | ----------------------- finish init ---------------------- |
 
@@ -1771,6 +2624,11 @@ void ControlManager::onInit() {
 
   is_initialized_ = true;
 
+  // offer the in-process command interface to the other managers
+  if (_state_board_enabled_) {
+    state_board_->setControlManagerCommands(createCommands());
+  }
+
   ROS_INFO("[ControlManager]: initialized, version %s", VERSION);
 }
 
@@ -1826,7 +2684,7 @@ void ControlManager::timerStatus(const ros::TimerEvent& event) {
   // |                   publish the diagnostics                  |
   // --------------------------------------------------------------
 
-  publishDiagnostics();
+  publishDiagnostics(false);
 
   // --------------------------------------------------------------
   // |                 publishing the motors state                |
@@ -1880,10 +2738,9 @@ void ControlManager::timerStatus(const ros::TimerEvent& event) {
     msg_out.total_position_error = sqrt(pow(position_error_x, 2) + pow(position_error_y, 2) + pow(position_error_z, 2));
     msg_out.yaw_error            = yaw_error;
 
-    std::map<std::string, ControllerParams>::iterator it;
-    it                                  = controllers_.find(_controller_names_[active_controller_idx]);
-    msg_out.position_eland_threshold    = it->second.eland_threshold;
-    msg_out.position_failsafe_threshold = it->second.failsafe_threshold;
+    const safety::SafetyThresholds* thresholds = safety_thresholds_.load(std::memory_order_acquire);
+    msg_out.position_eland_threshold           = thresholds->eland;
+    msg_out.position_failsafe_threshold        = thresholds->failsafe;
 
     ph_control_error_.publish(msg_out);
   }
@@ -2445,11 +3302,10 @@ void ControlManager::timerSafety(const ros::TimerEvent& event) {
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::timerSafety", scope_timer_logger_, scope_timer_enabled_);
 
   // copy member variables
-  auto last_attitude_cmd     = mrs_lib::get_mutexed(mutex_last_attitude_cmd_, last_attitude_cmd_);
-  auto last_position_cmd     = mrs_lib::get_mutexed(mutex_last_position_cmd_, last_position_cmd_);
-  auto [uav_state, uav_yaw]  = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_, uav_yaw_);
-  auto active_controller_idx = mrs_lib::get_mutexed(mutex_controller_list_, active_controller_idx_);
-  auto active_tracker_idx    = mrs_lib::get_mutexed(mutex_tracker_list_, active_tracker_idx_);
+  auto last_attitude_cmd    = mrs_lib::get_mutexed(mutex_last_attitude_cmd_, last_attitude_cmd_);
+  auto last_position_cmd    = mrs_lib::get_mutexed(mutex_last_position_cmd_, last_position_cmd_);
+  auto [uav_state, uav_yaw] = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_, uav_yaw_);
+  auto active_tracker_idx   = mrs_lib::get_mutexed(mutex_tracker_list_, active_tracker_idx_);
 
   if (!got_uav_state_ || (_state_input_ == INPUT_UAV_STATE && _odometry_innovation_check_enabled_ && !sh_odometry_innovation_.hasMsg()) ||
       !sh_pixhawk_odometry_.hasMsg() || active_tracker_idx == _null_tracker_idx_) {
@@ -2463,16 +3319,11 @@ void ControlManager::timerSafety(const ros::TimerEvent& event) {
 
   // | -------------- eland and failsafe thresholds ------------- |
 
-  std::map<std::string, ControllerParams>::iterator it;
-  it = controllers_.find(_controller_names_[active_controller_idx]);
-
-  _eland_threshold_               = it->second.eland_threshold;
-  _failsafe_threshold_            = it->second.failsafe_threshold;
-  _odometry_innovation_threshold_ = it->second.odometry_innovation_threshold;
+  const safety::SafetyThresholds& thresholds = *safety_thresholds_.load(std::memory_order_acquire);
 
   // | --------- calculate control errors and tilt angle -------- |
 
-  // This means that the timerFailsafe only does its work when Controllers and Trackers produce valid output.
+  // This means that the failsafeLoop only does its work when Controllers and Trackers produce valid output.
   // Cases when the commands are not valid should be handle in updateControllers() and updateTrackers() methods.
   if (last_position_cmd == mrs_msgs::PositionCommand::Ptr() || last_attitude_cmd == mrs_msgs::AttitudeCommand::Ptr()) {
     return;
@@ -2535,159 +3386,101 @@ void ControlManager::timerSafety(const ros::TimerEvent& event) {
     control_error = fabs(position_error_z);
   }
 
-  // --------------------------------------------------------------
-  // |   activate the failsafe controller in case of large error  |
-  // --------------------------------------------------------------
-
-  if (control_error > _failsafe_threshold_ && !failsafe_triggered_) {
-
-    auto controller_tracker_switch_time = mrs_lib::get_mutexed(mutex_controller_tracker_switch_time_, controller_tracker_switch_time_);
-
-    if ((ros::Time::now() - controller_tracker_switch_time).toSec() > 1.0) {
+  // | ------------------- odometry innovation ------------------ |
 
-      if (!failsafe_triggered_) {
+  safety::SafetyInput safety_input;
 
-        ROS_ERROR("[ControlManager]: activating failsafe land: control_error=%.2f/%.2f m (x: %.2f, y: %.2f, z: %.2f)", control_error, _failsafe_threshold_,
-                  position_error_x, position_error_y, position_error_z);
-
-        failsafe();
-      }
-    }
-  }
-
-  // --------------------------------------------------------------
-  // |     activate emergency land in case of large innovation    |
-  // --------------------------------------------------------------
+  double innovation_x = 0, innovation_y = 0, innovation_z = 0;
 
   if (_odometry_innovation_check_enabled_) {
-    {
-      auto [x, y, z] = mrs_lib::getPosition(sh_odometry_innovation_.getMsg());
-
-      double heading = 0;
-      try {
-        heading = mrs_lib::getHeading(sh_odometry_innovation_.getMsg());
-      }
-      catch (mrs_lib::AttitudeConverter::GetHeadingException& e) {
-        ROS_ERROR_THROTTLE(1.0, "[ControlManager]: exception caught: '%s'", e.what());
-      }
-
-      double last_innovation = mrs_lib::geometry::dist(vec3_t(x, y, z), vec3_t(0, 0, 0));
-
-      if (last_innovation > _odometry_innovation_threshold_ || radians::diff(heading, 0) > M_PI_2) {
-
-        auto controller_tracker_switch_time = mrs_lib::get_mutexed(mutex_controller_tracker_switch_time_, controller_tracker_switch_time_);
 
-        if ((ros::Time::now() - controller_tracker_switch_time).toSec() > 1.0) {
+    std::tie(innovation_x, innovation_y, innovation_z) = mrs_lib::getPosition(sh_odometry_innovation_.getMsg());
 
-          if (!failsafe_triggered_ && !eland_triggered_) {
-
-            ROS_ERROR("[ControlManager]: activating emergency land: odometry innovation too large: %.2f/%.2f (x: %.2f, y: %.2f, z: %.2f, heading: %.2f)",
-                      last_innovation, _odometry_innovation_threshold_, x, y, z, heading);
-
-            eland();
-          }
-        }
-      }
+    try {
+      safety_input.innovation_heading = radians::diff(mrs_lib::getHeading(sh_odometry_innovation_.getMsg()), 0);
+    }
+    catch (mrs_lib::AttitudeConverter::GetHeadingException& e) {
+      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: exception caught: '%s'", e.what());
     }
+
+    safety_input.innovation = mrs_lib::geometry::dist(vec3_t(innovation_x, innovation_y, innovation_z), vec3_t(0, 0, 0));
   }
 
   // --------------------------------------------------------------
-  // |   activate emergency land in case of medium control error  |
+  // |                 evaluate the safety checks                 |
   // --------------------------------------------------------------
 
-  // | ------------------- tilt control error ------------------- |
+  auto controller_tracker_switch_time = mrs_lib::get_mutexed(mutex_controller_tracker_switch_time_, controller_tracker_switch_time_);
 
-  if (_tilt_limit_eland_enabled_ && tilt_angle > _tilt_limit_eland_) {
+  safety_input.control_error      = control_error;
+  safety_input.tilt_angle         = tilt_angle;
+  safety_input.yaw_error          = yaw_error_;  // do not have to mutex the yaw_error_ here since I am filling it in this function
+  safety_input.time_since_switch  = (ros::Time::now() - controller_tracker_switch_time).toSec();
+  safety_input.failsafe_triggered = failsafe_triggered_;
+  safety_input.eland_triggered    = eland_triggered_;
 
-    auto controller_tracker_switch_time = mrs_lib::get_mutexed(mutex_controller_tracker_switch_time_, controller_tracker_switch_time_);
+  const uint32_t actions = safety::evaluate(thresholds, safety_limits_, safety_input);
 
-    if ((ros::Time::now() - controller_tracker_switch_time).toSec() > 1.0) {
+  // the actions are executed in the order of their priority, the triggered flags are re-checked
+  // since an earlier action in this cycle (failsafe, eland) suppresses the later ones
 
-      if (!failsafe_triggered_ && !eland_triggered_) {
+  if (actions & safety::ACTION_FAILSAFE) {
 
-        ROS_ERROR("[ControlManager]: activating emergency land: tilt angle too large (%.2f/%.2f deg)", (180.0 / M_PI) * tilt_angle,
-                  (180.0 / M_PI) * _tilt_limit_eland_);
+    ROS_ERROR("[ControlManager]: activating failsafe land: control_error=%.2f/%.2f m (x: %.2f, y: %.2f, z: %.2f)", control_error, thresholds.failsafe,
+              position_error_x, position_error_y, position_error_z);
 
-        eland();
-      }
-    }
+    failsafe();
   }
 
-  // | ----------------- position control error ----------------- |
-
-  if (control_error > _eland_threshold_ / 2.0) {
-
-    auto controller_tracker_switch_time = mrs_lib::get_mutexed(mutex_controller_tracker_switch_time_, controller_tracker_switch_time_);
-
-    if ((ros::Time::now() - controller_tracker_switch_time).toSec() > 1.0) {
+  if ((actions & safety::ACTION_ELAND_INNOVATION) && !failsafe_triggered_ && !eland_triggered_) {
 
-      if (!failsafe_triggered_ && !eland_triggered_) {
+    ROS_ERROR("[ControlManager]: activating emergency land: odometry innovation too large: %.2f/%.2f (x: %.2f, y: %.2f, z: %.2f, heading: %.2f)",
+              safety_input.innovation, thresholds.odometry_innovation, innovation_x, innovation_y, innovation_z, safety_input.innovation_heading);
 
-        ROS_DEBUG_THROTTLE(1.0, "[ControlManager]: releasing payload: position error %.2f/%.2f m (x: %.2f, y: %.2f, z: %.2f)", control_error,
-                           _eland_threshold_ / 2.0, position_error_x, position_error_y, position_error_z);
-
-        ungripSrv();
-      }
-    }
+    eland();
   }
 
-  if (control_error > _eland_threshold_) {
-
-    auto controller_tracker_switch_time = mrs_lib::get_mutexed(mutex_controller_tracker_switch_time_, controller_tracker_switch_time_);
-
-    if ((ros::Time::now() - controller_tracker_switch_time).toSec() > 1.0) {
-
-      if (!failsafe_triggered_ && !eland_triggered_) {
+  if ((actions & safety::ACTION_ELAND_TILT) && !failsafe_triggered_ && !eland_triggered_) {
 
-        ROS_ERROR("[ControlManager]: activating emergency land: position error %.2f/%.2f m (x: %.2f, y: %.2f, z: %.2f)", control_error, _eland_threshold_,
-                  position_error_x, position_error_y, position_error_z);
+    ROS_ERROR("[ControlManager]: activating emergency land: tilt angle too large (%.2f/%.2f deg)", (180.0 / M_PI) * tilt_angle,
+              (180.0 / M_PI) * _tilt_limit_eland_);
 
-        eland();
-      }
-    }
+    eland();
   }
 
-  // | -------------------- yaw control error ------------------- |
-  // do not have to mutex the yaw_error_ here since I am filling it in this function
-
-  if (_yaw_error_eland_enabled_) {
-
-    if (yaw_error_ > (_yaw_error_eland_ / 2.0)) {
+  if ((actions & safety::ACTION_UNGRIP_POSITION) && !failsafe_triggered_ && !eland_triggered_) {
 
-      auto controller_tracker_switch_time = mrs_lib::get_mutexed(mutex_controller_tracker_switch_time_, controller_tracker_switch_time_);
+    ROS_DEBUG_THROTTLE(1.0, "[ControlManager]: releasing payload: position error %.2f/%.2f m (x: %.2f, y: %.2f, z: %.2f)", control_error,
+                       thresholds.eland / 2.0, position_error_x, position_error_y, position_error_z);
 
-      if ((ros::Time::now() - controller_tracker_switch_time).toSec() > 1.0) {
+    ungripSrv();
+  }
 
-        if (!failsafe_triggered_ && !eland_triggered_) {
+  if ((actions & safety::ACTION_ELAND_POSITION) && !failsafe_triggered_ && !eland_triggered_) {
 
-          ROS_DEBUG_THROTTLE(1.0, "[ControlManager]: releasing payload: yaw error %.2f/%.2f deg", (180.0 / M_PI) * yaw_error_,
-                             (180.0 / M_PI) * _yaw_error_eland_ / 2.0);
+    ROS_ERROR("[ControlManager]: activating emergency land: position error %.2f/%.2f m (x: %.2f, y: %.2f, z: %.2f)", control_error, thresholds.eland,
+              position_error_x, position_error_y, position_error_z);
 
-          ungripSrv();
-        }
-      }
-    }
+    eland();
+  }
 
-    if (yaw_error_ > _yaw_error_eland_) {
+  if ((actions & safety::ACTION_UNGRIP_YAW) && !failsafe_triggered_ && !eland_triggered_) {
 
-      auto controller_tracker_switch_time = mrs_lib::get_mutexed(mutex_controller_tracker_switch_time_, controller_tracker_switch_time_);
+    ROS_DEBUG_THROTTLE(1.0, "[ControlManager]: releasing payload: yaw error %.2f/%.2f deg", (180.0 / M_PI) * yaw_error_,
+                       (180.0 / M_PI) * _yaw_error_eland_ / 2.0);
 
-      if ((ros::Time::now() - controller_tracker_switch_time).toSec() > 1.0) {
+    ungripSrv();
+  }
 
-        if (!failsafe_triggered_ && !eland_triggered_) {
+  if ((actions & safety::ACTION_ELAND_YAW) && !failsafe_triggered_ && !eland_triggered_) {
 
-          ROS_ERROR("[ControlManager]: activating emergency land: yaw error %.2f/%.2f deg", (180.0 / M_PI) * yaw_error_, (180.0 / M_PI) * _yaw_error_eland_);
+    ROS_ERROR("[ControlManager]: activating emergency land: yaw error %.2f/%.2f deg", (180.0 / M_PI) * yaw_error_, (180.0 / M_PI) * _yaw_error_eland_);
 
-          eland();
-        }
-      }
-    }
+    eland();
   }
 
-  // --------------------------------------------------------------
-  // |      disarm the drone when the tilt exceeds the limit      |
-  // --------------------------------------------------------------
-  if (_tilt_limit_disarm_enabled_ && tilt_angle > _tilt_limit_disarm_) {
+  // disarm the drone when the tilt exceeds the limit
+  if (actions & safety::ACTION_DISARM_TILT) {
 
     ROS_ERROR("[ControlManager]: tilt angle too large, disarming: tilt angle=%.2f/%.2f deg", (180.0 / M_PI) * tilt_angle, (180.0 / M_PI) * _tilt_limit_disarm_);
 
@@ -2802,26 +3595,29 @@ void ControlManager::timerEland(const ros::TimerEvent& event) {
       return;
     }
 
-    // recalculate the mass based on the thrust
-    thrust_mass_estimate_ = mrs_lib::quadratic_thrust_model::thrustToForce(common_handlers_->motor_params, last_attitude_cmd->thrust) / common_handlers_->g;
-    ROS_INFO_THROTTLE(1.0, "[ControlManager]: landing: initial mass: %.2f thrust mass estimate: %.2f", landing_uav_mass_, thrust_mass_estimate_);
+    const double now = ros::Time::now().toSec();
 
-    // condition for automatic motor turn off
-    if (((thrust_mass_estimate_ < _elanding_cutoff_mass_factor_ * landing_uav_mass_) || last_attitude_cmd->thrust < 0.01)) {
-      if (!thrust_under_threshold_) {
+    bool   touchdown;
+    double confidence, mass_ratio, time_under_cutoff;
 
-        thrust_mass_estimate_first_time_ = ros::Time::now();
-        thrust_under_threshold_          = true;
-      }
+    {
+      std::scoped_lock lock(mutex_landing_detector_);
+
+      touchdown         = landing_detector_.update(now);
+      confidence        = landing_detector_.confidence();
+      mass_ratio        = landing_detector_.massRatio();
+      time_under_cutoff = landing_detector_.timeUnderCutoff(now);
+    }
 
-      ROS_INFO_THROTTLE(0.1, "[ControlManager]: thrust is under cutoff factor for %.2f s", (ros::Time::now() - thrust_mass_estimate_first_time_).toSec());
+    ROS_INFO_THROTTLE(1.0, "[ControlManager]: landing: initial mass: %.2f thrust mass estimate: %.2f, touchdown confidence: %.2f", landing_uav_mass_,
+                      mass_ratio * landing_uav_mass_, confidence);
 
-    } else {
-      thrust_mass_estimate_first_time_ = ros::Time::now();
-      thrust_under_threshold_          = false;
+    if (time_under_cutoff > 0) {
+      ROS_INFO_THROTTLE(0.1, "[ControlManager]: thrust is under cutoff factor for %.2f s", time_under_cutoff);
     }
 
-    if (thrust_under_threshold_ && ((ros::Time::now() - thrust_mass_estimate_first_time_).toSec() > _elanding_cutoff_timeout_)) {
+    // condition for automatic motor turn off
+    if (touchdown) {
       // enable callbacks? ... NO
 
       ROS_INFO("[ControlManager]: reached cutoff thrust, setting motors OFF");
@@ -2851,15 +3647,15 @@ void ControlManager::timerEland(const ros::TimerEvent& event) {
 
 //}
 
-/* //{ timerFailsafe() */
+/* //{ failsafeLoop() */
 
-void ControlManager::timerFailsafe(const ros::TimerEvent& event) {
+void ControlManager::failsafeLoop(void) {
 
   if (!is_initialized_)
     return;
 
-  mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerFailsafe", _failsafe_timer_rate_, 0.01, event);
-  mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::timerFailsafe", scope_timer_logger_, scope_timer_enabled_);
+  mrs_lib::Routine    profiler_routine = profiler_.createRoutine("failsafeLoop");
+  mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::failsafeLoop", scope_timer_logger_, scope_timer_enabled_);
 
   // copy member variables
   auto last_attitude_cmd = mrs_lib::get_mutexed(mutex_last_attitude_cmd_, last_attitude_cmd_);
@@ -2870,34 +3666,33 @@ void ControlManager::timerFailsafe(const ros::TimerEvent& event) {
   publish();
 
   if (last_attitude_cmd == mrs_msgs::AttitudeCommand::Ptr()) {
-    ROS_WARN_THROTTLE(1.0, "[ControlManager]: timerFailsafe: last_attitude_cmd has not been initialized, returning");
+    ROS_WARN_THROTTLE(1.0, "[ControlManager]: failsafeLoop: last_attitude_cmd has not been initialized, returning");
     ROS_WARN_THROTTLE(1.0, "[ControlManager]: tip: the RC eland is probably triggered");
     return;
   }
 
-  double thrust_mass_estimate_ =
-      mrs_lib::quadratic_thrust_model::thrustToForce(common_handlers_->motor_params, last_attitude_cmd_->thrust) / common_handlers_->g;
-  ROS_INFO_THROTTLE(1.0, "[ControlManager]: failsafe: initial mass: %.2f thrust_mass_estimate: %.2f", landing_uav_mass_, thrust_mass_estimate_);
-
-  // condition for automatic motor turn off
-  if (((thrust_mass_estimate_ < _elanding_cutoff_mass_factor_ * landing_uav_mass_))) {
+  // the detector gets only the thrust during failsafe, so only its thrust-based fallback can trigger
+  const double now = ros::Time::now().toSec();
 
-    if (!thrust_under_threshold_) {
+  bool   touchdown;
+  double mass_ratio, time_under_cutoff;
 
-      thrust_mass_estimate_first_time_ = ros::Time::now();
-      thrust_under_threshold_          = true;
-    }
+  {
+    std::scoped_lock lock(mutex_landing_detector_);
 
-    ROS_INFO_THROTTLE(0.1, "[ControlManager]: thrust is under cutoff factor for %.2f s", (ros::Time::now() - thrust_mass_estimate_first_time_).toSec());
+    touchdown         = landing_detector_.update(now);
+    mass_ratio        = landing_detector_.massRatio();
+    time_under_cutoff = landing_detector_.timeUnderCutoff(now);
+  }
 
-  } else {
+  ROS_INFO_THROTTLE(1.0, "[ControlManager]: failsafe: initial mass: %.2f thrust_mass_estimate: %.2f", landing_uav_mass_, mass_ratio * landing_uav_mass_);
 
-    thrust_mass_estimate_first_time_ = ros::Time::now();
-    thrust_under_threshold_          = false;
+  if (time_under_cutoff > 0) {
+    ROS_INFO_THROTTLE(0.1, "[ControlManager]: thrust is under cutoff factor for %.2f s", time_under_cutoff);
   }
 
   // condition for automatic motor turn off
-  if (thrust_under_threshold_ && ((ros::Time::now() - thrust_mass_estimate_first_time_).toSec() > _elanding_cutoff_timeout_)) {
+  if (touchdown) {
 
     ROS_INFO_THROTTLE(1.0, "[ControlManager]: detecting zero thrust, disarming");
 
@@ -2907,6 +3702,389 @@ void ControlManager::timerFailsafe(const ros::TimerEvent& event) {
 
 //}
 
+/* //{ stateQueueLoop() */
+
+// serves the state queue, the timeout bounds the time to notice the stop
+void ControlManager::stateQueueLoop(void) {
+
+  while (state_queue_running_) {
+    queue_state_.callAvailable(ros::WallDuration(0.01));
+  }
+}
+
+//}
+
+/* //{ timerQueueProbe() */
+
+// the probe is called from the probed queue, its delay after the expected time is the queue's latency
+void ControlManager::timerQueueProbe(const ros::TimerEvent& event, const int queue) {
+
+  const double latency = std::max((event.current_real - event.current_expected).toSec(), 0.0);
+
+  QueueProbe& probe = queue_probes_[queue];
+
+  std::scoped_lock lock(probe.mutex);
+
+  probe.latency.add(latency);
+  probe.max_latency = std::max(probe.max_latency, latency);
+}
+
+//}
+
+/* //{ timerTimingDiagnostics() */
+
+void ControlManager::timerTimingDiagnostics(const ros::TimerEvent& event) {
+
+  if (!is_initialized_) {
+    return;
+  }
+
+  mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerTimingDiagnostics", _timing_diagnostics_rate_, 0.01, event);
+  mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::timerTimingDiagnostics", scope_timer_logger_, scope_timer_enabled_);
+
+  diagnostic_msgs::DiagnosticArray diagnostics;
+
+  diagnostics.header.stamp = ros::Time::now();
+
+  // | ---------------------- failsafe loop --------------------- |
+
+  {
+    const timing::DeadlineLoopStats stats = failsafe_loop_->stats();
+
+    diagnostic_msgs::DiagnosticStatus status;
+
+    status.name        = "ControlManager: failsafe loop";
+    status.hardware_id = _uav_name_;
+
+    if (stats.deadline_misses > 0 || stats.overruns > 0) {
+      status.level   = diagnostic_msgs::DiagnosticStatus::WARN;
+      status.message = "deadlines missed";
+    } else {
+      status.level   = diagnostic_msgs::DiagnosticStatus::OK;
+      status.message = failsafe_loop_->running() ? "running" : "idle";
+    }
+
+    addDiagnosticValue(status, "running", failsafe_loop_->running() ? "true" : "false");
+    addDiagnosticValue(status, "realtime", failsafe_loop_->realtime() ? "true" : "false");
+    addDiagnosticValue(status, "cycles", std::to_string(stats.cycles));
+    addDiagnosticValue(status, "deadline_misses", std::to_string(stats.deadline_misses));
+    addDiagnosticValue(status, "overruns", std::to_string(stats.overruns));
+    addDiagnosticValue(status, "last_lateness", std::to_string(stats.last_lateness));
+    addDiagnosticValue(status, "max_lateness", std::to_string(stats.max_lateness));
+
+    diagnostics.status.push_back(status);
+  }
+
+  // | ------------------- control output loop ------------------ |
+
+  if (_fixed_rate_output_enabled_) {
+
+    const timing::DeadlineLoopStats stats = control_output_loop_->stats();
+    const uint64_t                  skips = control_output_skips_;
+
+    diagnostic_msgs::DiagnosticStatus status;
+
+    status.name        = "ControlManager: control output loop";
+    status.hardware_id = _uav_name_;
+
+    if (stats.deadline_misses > 0 || stats.overruns > 0 || skips > 0) {
+      status.level   = diagnostic_msgs::DiagnosticStatus::WARN;
+      status.message = "deadlines missed";
+    } else {
+      status.level   = diagnostic_msgs::DiagnosticStatus::OK;
+      status.message = "running";
+    }
+
+    addDiagnosticValue(status, "rate", std::to_string(_fixed_rate_output_rate_));
+    addDiagnosticValue(status, "realtime", control_output_loop_->realtime() ? "true" : "false");
+    addDiagnosticValue(status, "cycles", std::to_string(stats.cycles));
+    addDiagnosticValue(status, "skipped", std::to_string(skips));
+    addDiagnosticValue(status, "deadline_misses", std::to_string(stats.deadline_misses));
+    addDiagnosticValue(status, "overruns", std::to_string(stats.overruns));
+    addDiagnosticValue(status, "last_lateness", std::to_string(stats.last_lateness));
+    addDiagnosticValue(status, "max_lateness", std::to_string(stats.max_lateness));
+
+    diagnostics.status.push_back(status);
+  }
+
+  // | --------------------- state watchdog --------------------- |
+
+  if (_state_watchdog_enabled_) {
+
+    const int64_t now = loop_clock_.now();
+
+    timing::InterArrivalStats stats;
+    double                    deadline, since_last;
+    int                       level;
+
+    {
+      std::scoped_lock lock(mutex_state_watchdog_);
+
+      stats      = state_watchdog_.stats();
+      deadline   = state_watchdog_.deadline();
+      since_last = state_watchdog_.sinceLast(now);
+      level      = state_watchdog_.check(now);
+    }
+
+    diagnostic_msgs::DiagnosticStatus status;
+
+    status.name        = "ControlManager: state watchdog";
+    status.hardware_id = _uav_name_;
+
+    if (level > 0) {
+      status.level   = diagnostic_msgs::DiagnosticStatus::ERROR;
+      status.message = std::string("missing state, ") + state_watchdog_action_names[_state_watchdog_actions_[level - 1]];
+    } else {
+      status.level   = diagnostic_msgs::DiagnosticStatus::OK;
+      status.message = stats.count() >= _state_watchdog_params_.min_samples ? "ok" : "learning";
+    }
+
+    addDiagnosticValue(status, "topic", _state_input_ == INPUT_UAV_STATE ? sh_uav_state_.topicName() : sh_odometry_.topicName());
+    addDiagnosticValue(status, "samples", std::to_string(stats.count()));
+    addDiagnosticValue(status, "rate", std::to_string(stats.rate()));
+    addDiagnosticValue(status, "mean", std::to_string(stats.mean()));
+    addDiagnosticValue(status, "stddev", std::to_string(stats.stddev()));
+    addDiagnosticValue(status, "min", std::to_string(stats.min()));
+    addDiagnosticValue(status, "max", std::to_string(stats.max()));
+    addDiagnosticValue(status, "last", std::to_string(stats.last()));
+    addDiagnosticValue(status, "deadline", std::to_string(deadline));
+    addDiagnosticValue(status, "since_last", std::to_string(since_last));
+    addDiagnosticValue(status, "level", std::to_string(level));
+
+    diagnostics.status.push_back(status);
+  }
+
+  // | ------------------ latency compensation ------------------ |
+
+  {
+    double   processing_time, state_age, latency_max, compensation_dt;
+    uint64_t samples;
+
+    {
+      std::scoped_lock lock(mutex_control_latency_);
+
+      processing_time = control_processing_time_;
+      state_age       = control_state_age_;
+      latency_max     = control_latency_max_;
+      compensation_dt = latency_compensation_dt_;
+      samples         = control_latency_samples_;
+    }
+
+    diagnostic_msgs::DiagnosticStatus status;
+
+    status.name        = "ControlManager: control latency";
+    status.hardware_id = _uav_name_;
+    status.level       = diagnostic_msgs::DiagnosticStatus::OK;
+    status.message     = latency_compensation_enabled_ ? "compensated" : "not compensated";
+
+    addDiagnosticValue(status, "compensation_enabled", latency_compensation_enabled_ ? "true" : "false");
+    addDiagnosticValue(status, "samples", std::to_string(samples));
+    addDiagnosticValue(status, "state_age", std::to_string(state_age));
+    addDiagnosticValue(status, "processing_time", std::to_string(processing_time));
+    addDiagnosticValue(status, "latency", std::to_string(state_age + processing_time));
+    addDiagnosticValue(status, "latency_max", std::to_string(latency_max));
+    addDiagnosticValue(status, "compensation", std::to_string(compensation_dt));
+
+    diagnostics.status.push_back(status);
+  }
+
+  // | --------------------- callback queues -------------------- |
+
+  for (int i = 0; i < QUEUE_COUNT; i++) {
+
+    QueueProbe& probe = queue_probes_[i];
+
+    if (!probe.timer) {
+      continue;
+    }
+
+    timing::DurationStats latency;
+    double              max_latency;
+
+    {
+      std::scoped_lock lock(probe.mutex);
+
+      latency     = probe.latency;
+      max_latency = probe.max_latency;
+
+      probe.latency.reset();
+    }
+
+    diagnostic_msgs::DiagnosticStatus status;
+
+    status.name        = std::string("ControlManager: callback queue ") + callback_queue_names[i];
+    status.hardware_id = _uav_name_;
+
+    // the probes of a blocked queue do not get called at all
+    if (latency.count() == 0) {
+      status.level   = diagnostic_msgs::DiagnosticStatus::WARN;
+      status.message = "blocked";
+    } else {
+      status.level   = diagnostic_msgs::DiagnosticStatus::OK;
+      status.message = "ok";
+    }
+
+    addDiagnosticValue(status, "probes", std::to_string(latency.count()));
+    addDiagnosticValue(status, "latency_mean", std::to_string(latency.mean()));
+    addDiagnosticValue(status, "latency_max", std::to_string(latency.max()));
+    addDiagnosticValue(status, "latency_p99", std::to_string(latency.p99()));
+    addDiagnosticValue(status, "latency_max_total", std::to_string(max_latency));
+
+    diagnostics.status.push_back(status);
+  }
+
+  // | ------------------- reference mailboxes ------------------ |
+
+  if (_reference_mailbox_enabled_) {
+
+    timing::DurationStats reference_latency, velocity_reference_latency;
+
+    {
+      std::scoped_lock lock(mutex_reference_mailbox_latency_);
+
+      reference_latency          = reference_mailbox_latency_;
+      velocity_reference_latency = velocity_reference_mailbox_latency_;
+
+      reference_mailbox_latency_.reset();
+      velocity_reference_mailbox_latency_.reset();
+    }
+
+    auto report = [&](const std::string& name, const uint64_t posted, const uint64_t coalesced, const uint64_t delivered, const uint64_t expired,
+                      const timing::DurationStats& latency) {
+      diagnostic_msgs::DiagnosticStatus status;
+
+      status.name        = "ControlManager: reference mailbox " + name;
+      status.hardware_id = _uav_name_;
+      status.level       = diagnostic_msgs::DiagnosticStatus::OK;
+      status.message     = "ok";
+
+      addDiagnosticValue(status, "posted", std::to_string(posted));
+      addDiagnosticValue(status, "coalesced", std::to_string(coalesced));
+      addDiagnosticValue(status, "applied", std::to_string(delivered >= expired ? delivered - expired : 0));
+      addDiagnosticValue(status, "expired", std::to_string(expired));
+      addDiagnosticValue(status, "latency_mean", std::to_string(latency.mean()));
+      addDiagnosticValue(status, "latency_max", std::to_string(latency.max()));
+      addDiagnosticValue(status, "latency_p99", std::to_string(latency.p99()));
+
+      diagnostics.status.push_back(status);
+    };
+
+    report("reference", mailbox_reference_.posted(), mailbox_reference_.coalesced(), mailbox_reference_.delivered(), mailbox_reference_expired_,
+           reference_latency);
+    report("velocity_reference", mailbox_velocity_reference_.posted(), mailbox_velocity_reference_.coalesced(), mailbox_velocity_reference_.delivered(),
+           mailbox_velocity_reference_expired_, velocity_reference_latency);
+  }
+
+  // | -------------- velocity reference fast path -------------- |
+
+  if (_velocity_reference_fast_path_enabled_) {
+
+    diagnostic_msgs::DiagnosticStatus status;
+
+    status.name        = "ControlManager: velocity reference fast path";
+    status.hardware_id = _uav_name_;
+    status.level       = diagnostic_msgs::DiagnosticStatus::OK;
+    status.message     = velocity_reference_analytic_safety_ ? "ok" : "ok, without the analytic safety area check";
+
+    addDiagnosticValue(status, "applied", std::to_string(velocity_reference_fast_path_applied_));
+    addDiagnosticValue(status, "tf_lookups", std::to_string(velocity_reference_fast_path_tf_lookups_));
+    addDiagnosticValue(status, "full_safety_checks", std::to_string(velocity_reference_fast_path_full_checks_));
+    addDiagnosticValue(status, "requests_reused/allocated",
+        std::to_string(pool_velocity_reference_request_.reuses()) + "/" + std::to_string(pool_velocity_reference_request_.allocations()));
+
+    diagnostics.status.push_back(status);
+  }
+
+  // | ---------------------- command queue --------------------- |
+
+  if (_command_queue_enabled_) {
+
+    diagnostic_msgs::DiagnosticStatus status;
+
+    status.name        = "ControlManager: command queue";
+    status.hardware_id = _uav_name_;
+    status.level       = diagnostic_msgs::DiagnosticStatus::OK;
+    status.message     = "ok";
+
+    addDiagnosticValue(status, "posted", std::to_string(command_queue_.posted()));
+    addDiagnosticValue(status, "executed", std::to_string(command_queue_.executed()));
+    addDiagnosticValue(status, "pending", std::to_string(command_queue_.pending()));
+    addDiagnosticValue(status, "fallbacks", std::to_string(command_queue_fallbacks_));
+
+    diagnostics.status.push_back(status);
+  }
+
+  // | ---------------------- output pools ---------------------- |
+
+  {
+    diagnostic_msgs::DiagnosticStatus status;
+
+    status.name        = "ControlManager: output pools";
+    status.hardware_id = _uav_name_;
+    status.level       = diagnostic_msgs::DiagnosticStatus::OK;
+    status.message     = "messages reused/allocated";
+
+    auto add = [&status](const std::string& key, const uint64_t reuses, const uint64_t allocations) {
+      addDiagnosticValue(status, key, std::to_string(reuses) + "/" + std::to_string(allocations));
+    };
+
+    add("control_output", pool_control_output_.reuses(), pool_control_output_.allocations());
+    add("thrust_force", pool_thrust_force_.reuses(), pool_thrust_force_.allocations());
+    add("cmd_odom", pool_cmd_odom_.reuses(), pool_cmd_odom_.allocations());
+    add("cmd_twist", pool_cmd_twist_.reuses(), pool_cmd_twist_.allocations());
+
+    diagnostics.status.push_back(status);
+  }
+
+  // | ---------------------- input timing ---------------------- |
+
+  {
+    const int64_t now = timing::monotonicNs();
+
+    for (int i = 0; i < MONITORED_INPUT_COUNT; i++) {
+
+      const timing::InputTiming::Snapshot snapshot = input_timing_[i]->snapshot(now, true);
+
+      // the inputs which were never received are not reported, e.g., the unused state input
+      if (snapshot.messages == 0) {
+        continue;
+      }
+
+      diagnostic_msgs::DiagnosticStatus status;
+
+      status.name        = std::string("ControlManager: input ") + monitored_input_names[i];
+      status.hardware_id = _uav_name_;
+
+      if (snapshot.window_messages == 0) {
+        status.level   = diagnostic_msgs::DiagnosticStatus::WARN;
+        status.message = "not receiving";
+      } else {
+        status.level   = diagnostic_msgs::DiagnosticStatus::OK;
+        status.message = "receiving";
+      }
+
+      addDiagnosticValue(status, "messages", std::to_string(snapshot.messages));
+      addDiagnosticValue(status, "rate", std::to_string(snapshot.rate));
+      addDiagnosticValue(status, "jitter", std::to_string(snapshot.jitter));
+      addDiagnosticValue(status, "since_last", std::to_string(snapshot.since));
+      addDiagnosticValue(status, "window_messages", std::to_string(snapshot.window_messages));
+      addDiagnosticValue(status, "interval_min", std::to_string(snapshot.interval_min));
+      addDiagnosticValue(status, "interval_mean", std::to_string(snapshot.interval_mean));
+      addDiagnosticValue(status, "interval_max", std::to_string(snapshot.interval_max));
+      addDiagnosticValue(status, "interval_p99", std::to_string(snapshot.interval_p99));
+      addDiagnosticValue(status, "age_mean", std::to_string(snapshot.age_mean));
+      addDiagnosticValue(status, "age_max", std::to_string(snapshot.age_max));
+      addDiagnosticValue(status, "age_p99", std::to_string(snapshot.age_p99));
+
+      diagnostics.status.push_back(status);
+    }
+  }
+
+  ph_timing_diagnostics_.publish(diagnostics);
+}
+
+//}
+
 /* //{ timerJoystick() */
 
 void ControlManager::timerJoystick(const ros::TimerEvent& event) {
@@ -3244,11 +4422,27 @@ void ControlManager::asyncControl(void) {
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("asyncControl");
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::asyncControl", scope_timer_logger_, scope_timer_enabled_);
 
+  in_control_loop = true;
+
+  // invalidates the per-cycle caches
+  control_cycle_++;
+
+  // the commands of the services are executed between the cycles, a burst is spread over several cycles
+  if (_command_queue_enabled_) {
+    command_queue_.drain(size_t(_command_queue_max_per_cycle_));
+  }
+
+  // the newest pending references
+  if (_reference_mailbox_enabled_) {
+    applyReferenceMailboxes();
+  }
+
   // copy member variables
-  auto uav_state             = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
-  auto sanitized_constraints = mrs_lib::get_mutexed(mutex_constraints_, sanitized_constraints_);
+  auto uav_state = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
 
-  if (!failsafe_triggered_) {  // when failsafe is triggered, updateControllers() and publish() is called in timerFailsafe()
+  const ros::Time start_time = ros::Time::now();
+
+  if (!failsafe_triggered_) {  // when failsafe is triggered, updateControllers() and publish() is called in failsafeLoop()
 
     // run the safety timer
     // in the case of large control errors, the safety mechanisms will be triggered before the controllers and trackers are updated...
@@ -3267,31 +4461,68 @@ void ControlManager::asyncControl(void) {
     ros::TimerEvent safety_timer_event;
     timerSafety(safety_timer_event);
 
-    updateTrackers();
+    // | ------------------ latency compensation ------------------ |
 
-    updateControllers(uav_state);
+    const double state_age = (start_time - uav_state.header.stamp).toSec();
 
-    if (got_constraints_) {
+    mrs_msgs::UavState uav_state_for_control = uav_state;
 
-      // update the constraints to trackers, if need to
-      if (enforceControllersConstraints(sanitized_constraints)) {
-        setConstraints(sanitized_constraints);
+    // the state watchdog's extrapolation predicts over the outage, at most until the terminal ladder step
+    const bool extrapolating = state_watchdog_extrapolating_;
 
-        {
-          std::scoped_lock lock(mutex_constraints_);
+    if (latency_compensation_enabled_ || extrapolating) {
 
-          sanitized_constraints_ = sanitized_constraints;
-        }
+      const double processing_time = latency_compensation_enabled_ ? mrs_lib::get_mutexed(mutex_control_latency_, control_processing_time_) : 0.0;
+
+      const double max_dt = extrapolating ? state_watchdog_extrapolation_max_.load() : _latency_compensation_max_;
+      const double dt     = std::clamp(state_age + processing_time, 0.0, max_dt);
+
+      uav_state_for_control = predictUavState(uav_state, dt);
+      uav_state_for_control.header.stamp += ros::Duration(dt);
+
+      if (latency_compensation_enabled_) {
+        mrs_lib::set_mutexed(mutex_control_latency_, dt, latency_compensation_dt_);
       }
     }
 
+    updateTrackers(uav_state_for_control);
+
+    updateControllers(uav_state_for_control);
+
+    // update the constraints to trackers, if they changed
+    if (got_constraints_ && updateSanitizedConstraints(false)) {
+      setConstraints();
+    }
+
     publish();
-  }
 
-  // if odometry switch happened, we finish it here and turn the safety timer back on
-  if (odometry_switch_in_progress_) {
+    // | ------------------ measure the latencies ----------------- |
 
-    ROS_DEBUG("[ControlManager]: starting safety timer");
+    const ros::Time end_time = ros::Time::now();
+
+    {
+      std::scoped_lock lock(mutex_control_latency_);
+
+      const double processing_time = (end_time - start_time).toSec();
+      const double latency         = (end_time - uav_state.header.stamp).toSec();
+
+      if (control_latency_samples_ == 0) {
+        control_processing_time_ = processing_time;
+        control_state_age_       = state_age;
+      } else {
+        control_processing_time_ += _latency_compensation_smoothing_ * (processing_time - control_processing_time_);
+        control_state_age_ += _latency_compensation_smoothing_ * (state_age - control_state_age_);
+      }
+
+      control_latency_max_ = std::max(control_latency_max_, latency);
+      control_latency_samples_++;
+    }
+  }
+
+  // if odometry switch happened, we finish it here and turn the safety timer back on
+  if (odometry_switch_in_progress_) {
+
+    ROS_DEBUG("[ControlManager]: starting safety timer");
     timer_safety_.start();
     ROS_DEBUG("[ControlManager]: safety timer started");
     odometry_switch_in_progress_ = false;
@@ -3303,6 +4534,8 @@ void ControlManager::asyncControl(void) {
                uav_state.pose.position.z, uav_heading_);
     }
   }
+
+  in_control_loop = false;
 }
 
 //}
@@ -3325,6 +4558,8 @@ void ControlManager::callbackOdometry(mrs_lib::SubscribeHandler<nav_msgs::Odomet
 
   nav_msgs::OdometryConstPtr odom = wrp.getMsg();
 
+  inputArrived(MONITORED_ODOMETRY, odom->header.stamp);
+
   // | --------------------- check for nans --------------------- |
 
   if (!validateOdometry(*odom)) {
@@ -3332,6 +4567,8 @@ void ControlManager::callbackOdometry(mrs_lib::SubscribeHandler<nav_msgs::Odomet
     return;
   }
 
+  stateArrived();
+
   // | ---------------------- frame switch ---------------------- |
 
   /* Odometry frame switch //{ */
@@ -3380,20 +4617,21 @@ void ControlManager::callbackOdometry(mrs_lib::SubscribeHandler<nav_msgs::Odomet
         }
       }
 
-      // we have to also for the oneshot control timer to finish
-      while (running_async_control_) {
+      // we have to also for the oneshot control timer to finish, and keep it from starting until the source is switched
+      bool expected = false;
+
+      while (!running_async_control_.compare_exchange_strong(expected, true)) {
+
+        expected = false;
 
         ROS_DEBUG("[ControlManager]: waiting for control timer to finish");
         ros::Duration wait(0.001);
         wait.sleep();
-
-        if (!running_async_control_) {
-          ROS_DEBUG("[ControlManager]: control timer finished");
-          break;
-        }
       }
 
       {
+        mrs_lib::AtomicScopeFlag unset_running(running_async_control_);
+
         std::scoped_lock lock(mutex_controller_list_, mutex_tracker_list_);
 
         tracker_list_[active_tracker_idx_]->switchOdometrySource(uav_state_const_ptr);
@@ -3455,13 +4693,9 @@ void ControlManager::callbackOdometry(mrs_lib::SubscribeHandler<nav_msgs::Odomet
     got_uav_state_ = true;
   }
 
-  // run the control loop asynchronously in an OneShotTimer
-  // but only if its not already running
-  if (!running_async_control_) {
-
-    running_async_control_ = true;
-
-    async_control_result_ = std::async(std::launch::async, &ControlManager::asyncControl, this);
+  // with the fixed-rate output, the control loop picks the new state up in controlOutputLoop()
+  if (!_fixed_rate_output_enabled_) {
+    startAsyncControl();
   }
 }
 
@@ -3479,6 +4713,8 @@ void ControlManager::callbackUavState(mrs_lib::SubscribeHandler<mrs_msgs::UavSta
 
   mrs_msgs::UavStateConstPtr uav_state = wrp.getMsg();
 
+  inputArrived(MONITORED_UAV_STATE, uav_state->header.stamp);
+
   // | --------------------- check for nans --------------------- |
 
   if (!validateUavState(*uav_state)) {
@@ -3486,58 +4722,19 @@ void ControlManager::callbackUavState(mrs_lib::SubscribeHandler<mrs_msgs::UavSta
     return;
   }
 
-  // | -------------------- check for hiccups ------------------- |
-
-  /* hickup detection //{ */
-
-  double alpha               = 0.99;
-  double alpha2              = 0.666;
-  double uav_state_count_lim = 1000;
-
-  double uav_state_dt = (ros::Time::now() - previous_uav_state_.header.stamp).toSec();
-
-  // belive only reasonable numbers
-  if (uav_state_dt <= 1.0) {
-
-    uav_state_avg_dt_ = alpha * uav_state_avg_dt_ + (1 - alpha) * uav_state_dt;
-
-    if (uav_state_count_ < uav_state_count_lim) {
-      uav_state_count_++;
-    }
-  }
-
-  if (uav_state_count_ == uav_state_count_lim) {
-
-    /* ROS_INFO_STREAM("[ControlManager]: uav_state_dt = " << uav_state_dt); */
-
-    if (uav_state_dt < uav_state_avg_dt_ && uav_state_dt > 0.0001) {
-
-      uav_state_hiccup_factor_ = alpha2 * uav_state_hiccup_factor_ + (1 - alpha2) * (uav_state_avg_dt_ / uav_state_dt);
-
-    } else if (uav_state_avg_dt_ > 0.0001) {
+  stateArrived();
 
-      uav_state_hiccup_factor_ = alpha2 * uav_state_hiccup_factor_ + (1 - alpha2) * (uav_state_dt / uav_state_avg_dt_);
-    }
-
-    if (uav_state_hiccup_factor_ > 3.141592653) {
+  // | -------------------- check for hiccups ------------------- |
 
-      /* ROS_ERROR_STREAM_THROTTLE(0.1, "[ControlManager]: hiccup factor = " << uav_state_hiccup_factor_); */
+  const double interval_ratio = input_timing_[MONITORED_UAV_STATE]->lastIntervalRatio(_input_timing_min_samples_);
 
-      ROS_WARN_THROTTLE(2.0, "[ControlManager]: ");
-      ROS_WARN_THROTTLE(2.0, "[ControlManager]: // | ------------------------- WARNING ------------------------ |");
-      ROS_WARN_THROTTLE(2.0, "[ControlManager]: // |                                                            |");
-      ROS_WARN_THROTTLE(2.0, "[ControlManager]: // |            UAV_STATE has a large hiccup factor!            |");
-      ROS_WARN_THROTTLE(2.0, "[ControlManager]: // |           hint, hint: you are probably rosbagging          |");
-      ROS_WARN_THROTTLE(2.0, "[ControlManager]: // |           lot of data or publishing lot of large           |");
-      ROS_WARN_THROTTLE(2.0, "[ControlManager]: // |          messages without mutual nodelet managers.         |");
-      ROS_WARN_THROTTLE(2.0, "[ControlManager]: // |                                                            |");
-      ROS_WARN_THROTTLE(2.0, "[ControlManager]: // | ------------------------- WARNING ------------------------ |");
-      ROS_WARN_THROTTLE(2.0, "[ControlManager]: ");
-    }
+  if (interval_ratio > _input_timing_hiccup_factor_) {
+    ROS_WARN_THROTTLE(2.0,
+                      "[ControlManager]: 'uav_state' arrived after %.1fx its mean period, the inputs' timing is in the timing diagnostics (hint: rosbagging "
+                      "lot of data or publishing large messages without mutual nodelet managers?)",
+                      interval_ratio);
   }
 
-  //}
-
   // | ---------------------- frame switch ---------------------- |
 
   /* frame switch //{ */
@@ -3576,20 +4773,21 @@ void ControlManager::callbackUavState(mrs_lib::SubscribeHandler<mrs_msgs::UavSta
         }
       }
 
-      // we have to also for the oneshot control timer to finish
-      while (running_async_control_) {
+      // we have to also for the oneshot control timer to finish, and keep it from starting until the source is switched
+      bool expected = false;
+
+      while (!running_async_control_.compare_exchange_strong(expected, true)) {
+
+        expected = false;
 
         ROS_DEBUG("[ControlManager]: waiting for control timer to finish");
         ros::Duration wait(0.001);
         wait.sleep();
-
-        if (!running_async_control_) {
-          ROS_DEBUG("[ControlManager]: control timer finished");
-          break;
-        }
       }
 
       {
+        mrs_lib::AtomicScopeFlag unset_running(running_async_control_);
+
         std::scoped_lock lock(mutex_controller_list_, mutex_tracker_list_);
 
         tracker_list_[active_tracker_idx_]->switchOdometrySource(uav_state);
@@ -3625,14 +4823,36 @@ void ControlManager::callbackUavState(mrs_lib::SubscribeHandler<mrs_msgs::UavSta
     got_uav_state_ = true;
   }
 
-  // run the control loop asynchronously in an OneShotTimer
-  // but only if its not already running
-  if (!running_async_control_) {
+  // with the fixed-rate output, the control loop picks the new state up in controlOutputLoop()
+  if (!_fixed_rate_output_enabled_) {
+    startAsyncControl();
+  }
+}
 
-    running_async_control_ = true;
+//}
 
-    async_control_result_ = std::async(std::launch::async, &ControlManager::asyncControl, this);
-  }
+/* //{ callbackPixhawkOdometry() */
+
+// the pixhawk odometry is polled, the callback only records its timing
+void ControlManager::callbackPixhawkOdometry(mrs_lib::SubscribeHandler<nav_msgs::Odometry>& wrp) {
+
+  if (!is_initialized_)
+    return;
+
+  inputArrived(MONITORED_PIXHAWK_ODOMETRY, wrp.getMsg()->header.stamp);
+}
+
+//}
+
+/* //{ callbackBumper() */
+
+// the bumper is polled, the callback only records its timing
+void ControlManager::callbackBumper(mrs_lib::SubscribeHandler<mrs_msgs::ObstacleSectors>& wrp) {
+
+  if (!is_initialized_)
+    return;
+
+  inputArrived(MONITORED_BUMPER, wrp.getMsg()->header.stamp);
 }
 
 //}
@@ -3649,6 +4869,8 @@ void ControlManager::callbackMavrosGps(mrs_lib::SubscribeHandler<sensor_msgs::Na
 
   sensor_msgs::NavSatFixConstPtr data = wrp.getMsg();
 
+  inputArrived(MONITORED_MAVROS_GPS, data->header.stamp);
+
   transformer_->setLatLon(data->latitude, data->longitude);
 }
 
@@ -3670,6 +4892,8 @@ void ControlManager::callbackJoystick(mrs_lib::SubscribeHandler<sensor_msgs::Joy
 
   sensor_msgs::JoyConstPtr joystick_data = wrp.getMsg();
 
+  inputArrived(MONITORED_JOYSTICK, joystick_data->header.stamp);
+
   // TODO check if the array is smaller than the largest idx
   if (joystick_data->buttons.size() == 0 || joystick_data->axes.size() == 0) {
     return;
@@ -3787,6 +5011,8 @@ void ControlManager::callbackMavrosState(mrs_lib::SubscribeHandler<mavros_msgs::
 
   mavros_msgs::StateConstPtr state = wrp.getMsg();
 
+  inputArrived(MONITORED_MAVROS_STATE, state->header.stamp);
+
   // | ------ detect and print the changes in offboard mode ----- |
   if (state->mode == "OFFBOARD") {
 
@@ -3835,6 +5061,8 @@ void ControlManager::callbackRC(mrs_lib::SubscribeHandler<mavros_msgs::RCIn>& wr
 
   mavros_msgs::RCInConstPtr rc = wrp.getMsg();
 
+  inputArrived(MONITORED_RC, rc->header.stamp);
+
   ROS_INFO_ONCE("[ControlManager]: getting RC channels");
 
   // | ------------------- rc joystic control ------------------- |
@@ -3962,7 +5190,7 @@ void ControlManager::timeoutUavState(const std::string& topic, const ros::Time&
 
   if (motors_ && !failsafe_triggered_) {
 
-    // We need to fire up timerFailsafe, which will regularly trigger the controllers
+    // We need to fire up the failsafeLoop, which will regularly trigger the controllers
     // in place of the callbackUavState/callbackOdometry().
 
     ROS_ERROR_THROTTLE(0.1, "[ControlManager]: not receiving '%s' for %.3f s, initiating failsafe land", topic.c_str(), (ros::Time::now() - last_msg).toSec());
@@ -3973,6 +5201,139 @@ void ControlManager::timeoutUavState(const std::string& topic, const ros::Time&
 
 //}
 
+// | --------------------- state watchdog --------------------- |
+
+/* stateArrived() //{ */
+
+void ControlManager::stateArrived(void) {
+
+  if (!_state_watchdog_enabled_) {
+    return;
+  }
+
+  std::scoped_lock lock(mutex_state_watchdog_);
+
+  state_watchdog_.arrived(loop_clock_.now());
+}
+
+//}
+
+/* stateWatchdogLoop() //{ */
+
+void ControlManager::stateWatchdogLoop(void) {
+
+  if (!is_initialized_) {
+    return;
+  }
+
+  const int64_t now = loop_clock_.now();
+
+  int    level;
+  double deadline, since_last, period;
+
+  {
+    std::scoped_lock lock(mutex_state_watchdog_);
+
+    level      = state_watchdog_.check(now);
+    deadline   = state_watchdog_.deadline();
+    since_last = state_watchdog_.sinceLast(now);
+    period     = std::min(state_watchdog_.stats().mean(), deadline);
+  }
+
+  const int  previous_level = state_watchdog_level_;
+  const bool flying         = motors_ && !failsafe_triggered_;
+
+  state_watchdog_level_ = level;
+
+  // the control loop predicts the state, until the state arrives again or the terminal step (eland, failsafe) is reached,
+  // the prediction error grows quadratically with the time, so it is not used for the landing
+  const int terminal_level = int(_state_watchdog_params_.ladder.size());
+
+  state_watchdog_extrapolation_max_ = deadline * _state_watchdog_params_.ladder.back();
+  state_watchdog_extrapolating_ =
+      _state_watchdog_extrapolate_step_ >= 0 && level > _state_watchdog_extrapolate_step_ && level < terminal_level && flying;
+
+  if (level < previous_level) {
+
+    if (level == 0) {
+      ROS_INFO_THROTTLE(1.0, "[ControlManager]: state watchdog: the state is being received again");
+    }
+
+    return;
+  }
+
+  if (level > previous_level && flying) {
+
+    const StateWatchdogAction_t action = _state_watchdog_actions_[level - 1];
+
+    ROS_ERROR_THROTTLE(0.1, "[ControlManager]: state watchdog: not receiving the state for %.4f s (deadline %.4f s), escalating to '%s'", since_last,
+                       deadline, state_watchdog_action_names[action]);
+
+    switch (action) {
+
+      case WATCHDOG_EXTRAPOLATE: {
+        state_watchdog_last_extrapolation_ = 0;
+        break;
+      }
+
+      case WATCHDOG_EHOVER: {
+        ehover();
+        break;
+      }
+
+      case WATCHDOG_ELAND: {
+        eland();
+        break;
+      }
+
+      case WATCHDOG_FAILSAFE: {
+        failsafe();
+        break;
+      }
+    }
+  }
+
+  // | ---------------------- extrapolation --------------------- |
+
+  // the control loop runs on the predicted state once per the expected period, until the state arrives again
+  // (the fixed-rate output loop runs it on its own)
+  if (!state_watchdog_extrapolating_ || !got_uav_state_ || _fixed_rate_output_enabled_) {
+    return;
+  }
+
+  if (double(now - state_watchdog_last_extrapolation_) * 1e-9 < period) {
+    return;
+  }
+
+  state_watchdog_last_extrapolation_ = now;
+
+  startAsyncControl();
+}
+
+//}
+
+/* controlOutputLoop() //{ */
+
+void ControlManager::controlOutputLoop(void) {
+
+  if (!is_initialized_ || !got_uav_state_) {
+    return;
+  }
+
+  // the control is also run by the odometry switch and by the failsafe, do not overlap with them
+  bool expected = false;
+
+  if (!running_async_control_.compare_exchange_strong(expected, true)) {
+    control_output_skips_++;
+    return;
+  }
+
+  // runs synchronously on the loop's thread, asyncControl() releases the running flag
+  asyncControl();
+}
+
+//}
+
 /* timeoutMavrosState() //{ */
 
 void ControlManager::timeoutMavrosState([[maybe_unused]] const std::string& topic, const ros::Time& last_msg, [[maybe_unused]] const int n_pubs) {
@@ -4009,7 +5370,7 @@ bool ControlManager::callbackSwitchTracker(mrs_msgs::String::Request& req, mrs_m
     return true;
   }
 
-  auto [success, response] = switchTracker(req.value);
+  auto [success, response] = runCommand([&]() { return switchTracker(req.value); });
 
   res.success = success;
   res.message = response;
@@ -4039,7 +5400,7 @@ bool ControlManager::callbackSwitchController(mrs_msgs::String::Request& req, mr
     return true;
   }
 
-  auto [success, response] = switchController(req.value);
+  auto [success, response] = runCommand([&]() { return switchController(req.value); });
 
   res.success = success;
   res.message = response;
@@ -4071,7 +5432,7 @@ bool ControlManager::callbackTrackerResetStatic([[maybe_unused]] std_srvs::Trigg
   }
 
   // reactivate the current tracker
-  {
+  runCommand([&]() {
     std::scoped_lock lock(mutex_tracker_list_);
 
     std::string tracker_name = _tracker_names_[active_tracker_idx_];
@@ -4085,7 +5446,7 @@ bool ControlManager::callbackTrackerResetStatic([[maybe_unused]] std_srvs::Trigg
       message << "the tracker '" << tracker_name << "' reset failed!";
       ROS_ERROR_STREAM("[ControlManager]: " << message.str());
     }
-  }
+  });
 
   res.message = message.str();
   res.success = true;
@@ -4386,22 +5747,19 @@ bool ControlManager::callbackSetConstraints(mrs_msgs::DynamicsConstraintsSrv::Re
     return true;
   }
 
-  // copy member variables
-  auto sanitized_constraints = mrs_lib::get_mutexed(mutex_constraints_, sanitized_constraints_);
-
   {
     std::scoped_lock lock(mutex_constraints_);
 
-    current_constraints_   = req;
-    sanitized_constraints_ = req;
-    got_constraints_       = true;
-
-    enforceControllersConstraints(sanitized_constraints_);
-
-    sanitized_constraints = sanitized_constraints_;
+    current_constraints_ = req;
+    current_constraints_version_++;
+    got_constraints_ = true;
   }
 
-  setConstraints(sanitized_constraints);
+  runCommand([&]() {
+    if (updateSanitizedConstraints(false)) {
+      setConstraints();
+    }
+  });
 
   res.message = "setting constraints";
   res.success = true;
@@ -4558,7 +5916,7 @@ bool ControlManager::callbackUseJoystick([[maybe_unused]] std_srvs::Trigger::Req
   std::stringstream ss;
 
   {
-    auto [success, response] = switchTracker(_joystick_tracker_name_);
+    auto [success, response] = runCommand([&]() { return switchTracker(_joystick_tracker_name_); });
 
     if (!success) {
 
@@ -4572,7 +5930,7 @@ bool ControlManager::callbackUseJoystick([[maybe_unused]] std_srvs::Trigger::Req
     }
   }
 
-  auto [success, response] = switchController(_joystick_controller_name_);
+  auto [success, response] = runCommand([&]() { return switchController(_joystick_controller_name_); });
 
   if (!success) {
 
@@ -4612,7 +5970,7 @@ bool ControlManager::callbackHover([[maybe_unused]] std_srvs::Trigger::Request&
   if (!is_initialized_)
     return false;
 
-  auto [success, message] = hover();
+  auto [success, message] = runCommand([&]() { return hover(); });
 
   res.success = success;
   res.message = message;
@@ -4629,7 +5987,7 @@ bool ControlManager::callbackStartTrajectoryTracking([[maybe_unused]] std_srvs::
   if (!is_initialized_)
     return false;
 
-  auto [success, message] = startTrajectoryTracking();
+  auto [success, message] = runCommand([&]() { return startTrajectoryTracking(); });
 
   res.success = success;
   res.message = message;
@@ -4646,7 +6004,7 @@ bool ControlManager::callbackStopTrajectoryTracking([[maybe_unused]] std_srvs::T
   if (!is_initialized_)
     return false;
 
-  auto [success, message] = stopTrajectoryTracking();
+  auto [success, message] = runCommand([&]() { return stopTrajectoryTracking(); });
 
   res.success = success;
   res.message = message;
@@ -4663,7 +6021,7 @@ bool ControlManager::callbackResumeTrajectoryTracking([[maybe_unused]] std_srvs:
   if (!is_initialized_)
     return false;
 
-  auto [success, message] = resumeTrajectoryTracking();
+  auto [success, message] = runCommand([&]() { return resumeTrajectoryTracking(); });
 
   res.success = success;
   res.message = message;
@@ -4680,7 +6038,7 @@ bool ControlManager::callbackGotoTrajectoryStart([[maybe_unused]] std_srvs::Trig
   if (!is_initialized_)
     return false;
 
-  auto [success, message] = gotoTrajectoryStart();
+  auto [success, message] = runCommand([&]() { return gotoTrajectoryStart(); });
 
   res.success = success;
   res.message = message;
@@ -4800,6 +6158,29 @@ bool ControlManager::callbackEnableBumper(std_srvs::SetBool::Request& req, std_s
 
 //}
 
+/* //{ callbackLatencyCompensation() */
+
+bool ControlManager::callbackLatencyCompensation(std_srvs::SetBool::Request& req, std_srvs::SetBool::Response& res) {
+
+  if (!is_initialized_)
+    return false;
+
+  latency_compensation_enabled_ = req.data;
+
+  std::stringstream ss;
+
+  ss << "latency compensation " << (latency_compensation_enabled_ ? "enabled" : "disabled");
+
+  ROS_INFO_STREAM("[ControlManager]: " << ss.str());
+
+  res.success = true;
+  res.message = ss.str();
+
+  return true;
+}
+
+//}
+
 /* //{ callbackUseSafetyArea() */
 
 bool ControlManager::callbackUseSafetyArea(std_srvs::SetBool::Request& req, std_srvs::SetBool::Response& res) {
@@ -5222,7 +6603,7 @@ bool ControlManager::callbackReferenceService(mrs_msgs::ReferenceStampedSrv::Req
   des_reference.header    = req.header;
   des_reference.reference = req.reference;
 
-  auto [success, message] = setReference(des_reference);
+  auto [success, message] = runCommand([&]() { return setReference(des_reference); });
 
   res.success = success;
   res.message = message;
@@ -5242,7 +6623,13 @@ void ControlManager::callbackReferenceTopic(const mrs_msgs::ReferenceStampedCons
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("callbackReferenceTopic");
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::callbackReferenceTopic", scope_timer_logger_, scope_timer_enabled_);
 
-  setReference(*msg);
+  // applied by the control loop, a reference which was not applied yet is replaced
+  if (_reference_mailbox_enabled_) {
+    mailbox_reference_.post(std::pair(msg, timing::monotonicNs()));
+    return;
+  }
+
+  runCommand([&]() { return setReference(*msg); });
 }
 
 //}
@@ -5264,7 +6651,7 @@ bool ControlManager::callbackVelocityReferenceService(mrs_msgs::VelocityReferenc
   mrs_msgs::VelocityReferenceStamped des_reference;
   des_reference = req.reference;
 
-  auto [success, message] = setVelocityReference(des_reference);
+  auto [success, message] = runCommand([&]() { return setVelocityReference(des_reference); });
 
   res.success = success;
   res.message = message;
@@ -5284,7 +6671,17 @@ void ControlManager::callbackVelocityReferenceTopic(const mrs_msgs::VelocityRefe
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("callbackVelocityReferenceTopic");
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::callbackVelocityReferenceTopic", scope_timer_logger_, scope_timer_enabled_);
 
-  setVelocityReference(*msg);
+  // applied by the control loop, a reference which was not applied yet is replaced
+  if (_reference_mailbox_enabled_) {
+    mailbox_velocity_reference_.post(std::pair(msg, timing::monotonicNs()));
+    return;
+  }
+
+  if (_velocity_reference_fast_path_enabled_) {
+    runCommand([&]() { return setVelocityReferenceFast(*msg); });
+  } else {
+    runCommand([&]() { return setVelocityReference(*msg); });
+  }
 }
 
 //}
@@ -5302,7 +6699,7 @@ bool ControlManager::callbackTrajectoryReferenceService(mrs_msgs::TrajectoryRefe
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("callbackTrajectoryReferenceService");
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::callbackTrajectoryReferenceService", scope_timer_logger_, scope_timer_enabled_);
 
-  auto [success, message, modified, tracker_names, tracker_successes, tracker_messages] = setTrajectoryReference(req.trajectory);
+  auto [success, message, modified, tracker_names, tracker_successes, tracker_messages] = runCommand([&]() { return setTrajectoryReference(req.trajectory); });
 
   res.success          = success;
   res.message          = message;
@@ -5329,7 +6726,7 @@ void ControlManager::callbackTrajectoryReferenceTopic(const mrs_msgs::Trajectory
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("callbackTrajectoryReferenceTopic");
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::callbackTrajectoryReferenceTopic", scope_timer_logger_, scope_timer_enabled_);
 
-  setTrajectoryReference(*msg);
+  runCommand([&]() { return setTrajectoryReference(*msg); });
 }
 
 //}
@@ -5357,7 +6754,7 @@ bool ControlManager::callbackGoto(mrs_msgs::Vec4::Request& req, mrs_msgs::Vec4::
   des_reference.reference.position.z = req.goal[REF_Z];
   des_reference.reference.heading    = req.goal[REF_HEADING];
 
-  auto [success, message] = setReference(des_reference);
+  auto [success, message] = runCommand([&]() { return setReference(des_reference); });
 
   res.success = success;
   res.message = message;
@@ -5388,7 +6785,7 @@ bool ControlManager::callbackGotoFcu(mrs_msgs::Vec4::Request& req, mrs_msgs::Vec
   des_reference.reference.position.z = req.goal[REF_Z];
   des_reference.reference.heading    = req.goal[REF_HEADING];
 
-  auto [success, message] = setReference(des_reference);
+  auto [success, message] = runCommand([&]() { return setReference(des_reference); });
 
   res.success = success;
   res.message = message;
@@ -5427,7 +6824,7 @@ bool ControlManager::callbackGotoRelative(mrs_msgs::Vec4::Request& req, mrs_msgs
   des_reference.reference.position.z = last_position_cmd->position.z + req.goal[REF_Z];
   des_reference.reference.heading    = last_position_cmd->heading + req.goal[REF_HEADING];
 
-  auto [success, message] = setReference(des_reference);
+  auto [success, message] = runCommand([&]() { return setReference(des_reference); });
 
   res.success = success;
   res.message = message;
@@ -5466,7 +6863,7 @@ bool ControlManager::callbackGotoAltitude(mrs_msgs::Vec1::Request& req, mrs_msgs
   des_reference.reference.position.z = req.goal;
   des_reference.reference.heading    = last_position_cmd->heading;
 
-  auto [success, message] = setReference(des_reference);
+  auto [success, message] = runCommand([&]() { return setReference(des_reference); });
 
   res.success = success;
   res.message = message;
@@ -5505,7 +6902,7 @@ bool ControlManager::callbackSetHeading(mrs_msgs::Vec1::Request& req, mrs_msgs::
   des_reference.reference.position.z = last_position_cmd->position.z;
   des_reference.reference.heading    = req.goal;
 
-  auto [success, message] = setReference(des_reference);
+  auto [success, message] = runCommand([&]() { return setReference(des_reference); });
 
   res.success = success;
   res.message = message;
@@ -5544,7 +6941,7 @@ bool ControlManager::callbackSetHeadingRelative(mrs_msgs::Vec1::Request& req, mr
   des_reference.reference.position.z = last_position_cmd->position.z;
   des_reference.reference.heading    = last_position_cmd->heading + req.goal;
 
-  auto [success, message] = setReference(des_reference);
+  auto [success, message] = runCommand([&]() { return setReference(des_reference); });
 
   res.success = success;
   res.message = message;
@@ -5826,91 +7223,321 @@ std::tuple<bool, std::string> ControlManager::setVelocityReference(const mrs_msg
 
 //}
 
-/* setTrajectoryReference() //{ */
-
-std::tuple<bool, std::string, bool, std::vector<std::string>, std::vector<bool>, std::vector<std::string>> ControlManager::setTrajectoryReference(
-    const mrs_msgs::TrajectoryReference trajectory_in) {
+/* setVelocityReferenceFast() //{ */
 
-  auto uav_state         = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
-  auto last_position_cmd = mrs_lib::get_mutexed(mutex_last_position_cmd_, last_position_cmd_);
+// the same checks as setVelocityReference(), for the high-rate streams
+// * the tfs come from the per-cycle cache, the reference is transformed with Eigen instead of the message transformations
+// * the safety area is checked against the clearance of the position command, the full check is used only near the border and the obstacles
+// * the tracker request comes from the pool
+bool ControlManager::setVelocityReferenceFast(const mrs_msgs::VelocityReferenceStamped& reference_in) {
 
-  std::stringstream ss;
+  // the transformation of the latlon frame is not rigid
+  if (reference_in.header.frame_id == "latlon_origin") {
+    return std::get<0>(setVelocityReference(reference_in));
+  }
 
   if (!callbacks_enabled_) {
-    ss << "can not set the reference, the callbacks are disabled";
-    ROS_WARN_STREAM_THROTTLE(1.0, "[ControlManager]: " << ss.str());
-    return std::tuple(false, ss.str(), false, std::vector<std::string>(), std::vector<bool>(), std::vector<std::string>());
+    ROS_WARN_THROTTLE(1.0, "[ControlManager]: can not set the reference, the callbacks are disabled");
+    return false;
   }
 
-  /* validate the size and check for NaNs //{ */
+  if (!validateVelocityReference(reference_in.reference)) {
+    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: velocity command is not valid!");
+    return false;
+  }
 
-  // check for the size 0, which is invalid
-  if (trajectory_in.points.size() == 0) {
+  auto last_position_cmd = mrs_lib::get_mutexed(mutex_last_position_cmd_, last_position_cmd_);
 
-    ss << "can not load trajectory with size 0";
-    ROS_WARN_STREAM_THROTTLE(1.0, "[ControlManager]: " << ss.str());
-    return std::tuple(false, ss.str(), false, std::vector<std::string>(), std::vector<bool>(), std::vector<std::string>());
+  if (last_position_cmd == mrs_msgs::PositionCommand::Ptr()) {
+    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: could not set velocity command, not flying!");
+    return false;
   }
 
-  for (int i = 0; i < int(trajectory_in.points.size()); i++) {
+  mrs_msgs::VelocityReference reference = reference_in.reference;
 
-    // check the point for NaN/inf
-    bool no_nans = true;
+  {
+    std::scoped_lock lock(mutex_velocity_reference_fast_path_);
 
-    if (!std::isfinite(trajectory_in.points[i].position.x)) {
-      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN/inf detected in variable 'trajectory_in.points[%d].x'!!!", i);
-      no_nans = false;
-    }
+    VelocityReferenceCache& cache = velocity_reference_cache_;
 
-    if (!std::isfinite(trajectory_in.points[i].position.y)) {
-      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN/inf detected in variable 'trajectory_in.points[%d].y'!!!", i);
-      no_nans = false;
-    }
+    const uint64_t cycle = control_cycle_;
 
-    if (!std::isfinite(trajectory_in.points[i].position.z)) {
-      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN/inf detected in variable 'trajectory_in.points[%d].z'!!!", i);
-      no_nans = false;
-    }
+    // | ------- the tf to the control frame, once per cycle ------- |
 
-    if (!std::isfinite(trajectory_in.points[i].heading)) {
-      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN/inf detected in variable 'trajectory_in.points[%d].heading'!!!", i);
-      no_nans = false;
-    }
+    bool lookup = cache.cycle != cycle || cache.frame_from != reference_in.header.frame_id;
 
-    if (no_nans == false) {
+    {
+      std::scoped_lock lock(mutex_uav_state_);
 
-      ss << "trajectory contains NaNs/infs.";
-      ROS_WARN_STREAM_THROTTLE(1.0, "[ControlManager]: " << ss.str());
-      return std::tuple(false, ss.str(), false, std::vector<std::string>(), std::vector<bool>(), std::vector<std::string>());
+      if (cache.frame_to != uav_state_.header.frame_id) {
+        cache.frame_to = uav_state_.header.frame_id;
+        lookup         = true;
+      }
     }
-  }
 
-  //}
+    if (lookup) {
 
-  /* publish the debugging topics of the original trajectory //{ */
+      cache.cycle        = 0;
+      cache.safety_cycle = 0;
+      cache.frame_from   = reference_in.header.frame_id;
 
-  {
+      auto ret = transformer_->getTransform(cache.frame_from, cache.frame_to, reference_in.header.stamp);
 
-    geometry_msgs::PoseArray debug_trajectory_out;
-    debug_trajectory_out.header = trajectory_in.header;
+      if (!ret) {
+        ROS_WARN_THROTTLE(1.0, "[ControlManager]: could not find tf from %s to %s", cache.frame_from.c_str(), cache.frame_to.c_str());
+        return false;
+      }
 
-    debug_trajectory_out.header.frame_id = transformer_->resolveFrame(debug_trajectory_out.header.frame_id);
+      cache.to_control = transformToIsometry(ret.value());
+      cache.stamp      = ret->header.stamp;
+      cache.cycle      = cycle;
 
-    if (debug_trajectory_out.header.stamp == ros::Time(0)) {
-      debug_trajectory_out.header.stamp = ros::Time::now();
+      velocity_reference_fast_path_tf_lookups_++;
     }
 
-    for (int i = 0; i < int(trajectory_in.points.size()) - 1; i++) {
+    // | ------------ transform the velocity reference ------------ |
 
-      geometry_msgs::Pose new_pose;
+    const Eigen::Vector3d velocity = cache.to_control.linear() * Eigen::Vector3d(reference.velocity.x, reference.velocity.y, reference.velocity.z);
 
-      new_pose.position.x = trajectory_in.points[i].position.x;
-      new_pose.position.y = trajectory_in.points[i].position.y;
-      new_pose.position.z = trajectory_in.points[i].position.z;
+    reference.velocity.x = velocity.x();
+    reference.velocity.y = velocity.y();
+    reference.velocity.z = velocity.z();
 
-      new_pose.orientation = mrs_lib::AttitudeConverter(0, 0, trajectory_in.points[i].heading);
+    reference.altitude = (cache.to_control * Eigen::Vector3d(0, 0, reference_in.reference.altitude)).z();
 
-      debug_trajectory_out.poses.push_back(new_pose);
+    // the heading is the direction of the rotated x axis of the heading frame
+    const Eigen::Vector3d heading = cache.to_control.linear() * Eigen::Vector3d(cos(reference.heading), sin(reference.heading), 0);
+
+    reference.heading = atan2(heading.y(), heading.x());
+
+    // | ------ the stopping point, velocityReferenceToReference() ------ |
+
+    const Eigen::Vector3d position_cmd(last_position_cmd->position.x, last_position_cmd->position.y, last_position_cmd->position.z);
+
+    Eigen::Vector3d stopping_point;
+
+    {
+      std::scoped_lock lock(mutex_constraints_);
+
+      const double horizontal_acceleration = current_constraints_.constraints.horizontal_acceleration;
+
+      stopping_point.x() = position_cmd.x() + reference.velocity.x * (1.5 * (fabs(reference.velocity.x) / horizontal_acceleration) + 1.0);
+      stopping_point.y() = position_cmd.y() + reference.velocity.y * (1.5 * (fabs(reference.velocity.y) / horizontal_acceleration) + 1.0);
+
+      if (reference.use_altitude) {
+        stopping_point.z() = reference.altitude;
+      } else {
+
+        const double vertical_acceleration = reference.velocity.x >= 0 ? current_constraints_.constraints.vertical_ascending_acceleration
+                                                                       : current_constraints_.constraints.vertical_descending_acceleration;
+
+        stopping_point.z() = position_cmd.z() + reference.velocity.z * (1.5 * (fabs(reference.velocity.z) / vertical_acceleration) + 1.0);
+      }
+    }
+
+    // the message form of the stopping point, only for the bumper and the full safety check
+    auto equivalent_reference = [&]() {
+      mrs_msgs::ReferenceStamped reference_out;
+      reference_out.header.frame_id      = cache.frame_to;
+      reference_out.header.stamp         = cache.stamp;
+      reference_out.reference.position.x = stopping_point.x();
+      reference_out.reference.position.y = stopping_point.y();
+      reference_out.reference.position.z = stopping_point.z();
+      reference_out.reference.heading    = reference.heading;
+      return reference_out;
+    };
+
+    // check the obstacle bumper
+    if (bumper_enabled_) {
+
+      mrs_msgs::ReferenceStamped bumper_reference = equivalent_reference();
+
+      if (!bumperValidatePoint(bumper_reference)) {
+        ROS_ERROR_THROTTLE(1.0, "[ControlManager]: failed to set the reference, potential collision with an obstacle!");
+        return false;
+      }
+    }
+
+    // | ------------------- safety area check ------------------- |
+
+    if (use_safety_area_) {
+
+      bool valid = false;
+
+      if (velocity_reference_analytic_safety_) {
+
+        // the clearance of the position command, once per cycle
+        if (cache.safety_cycle != cycle) {
+
+          cache.safety_cycle = cycle;
+          cache.safety_valid = false;
+
+          auto ret = transformer_->getTransform(cache.frame_to, _safety_area_frame_, cache.stamp);
+
+          if (ret) {
+
+            cache.to_safety     = transformToIsometry(ret.value());
+            cache.safety_origin = (cache.to_safety * position_cmd).head<2>();
+
+            if (safety_zone_->isPointValid2d(cache.safety_origin.x(), cache.safety_origin.y())) {
+              cache.clearance    = safetyAreaClearance(cache.safety_origin);
+              cache.safety_valid = true;
+            }
+          }
+        }
+
+        // the position command (it can change within the cycle) and the stopping point are in the disc without the border and the obstacles,
+        // so is the path between them
+        if (cache.safety_valid) {
+
+          auto min_height = mrs_lib::get_mutexed(mutex_min_height_, min_height_);
+
+          const Eigen::Vector3d position_cmd_safety   = cache.to_safety * position_cmd;
+          const Eigen::Vector3d stopping_point_safety = cache.to_safety * stopping_point;
+
+          valid = (position_cmd_safety.head<2>() - cache.safety_origin).norm() < cache.clearance &&
+                  (stopping_point_safety.head<2>() - cache.safety_origin).norm() < cache.clearance && stopping_point_safety.z() >= min_height &&
+                  stopping_point_safety.z() <= getMaxHeight();
+        }
+      }
+
+      if (!valid) {
+
+        velocity_reference_fast_path_full_checks_++;
+
+        mrs_msgs::ReferenceStamped safety_reference = equivalent_reference();
+
+        if (!isPointInSafetyArea3d(safety_reference)) {
+          ROS_ERROR_THROTTLE(1.0, "[ControlManager]: failed to set the reference, the point is outside of the safety area!");
+          return false;
+        }
+
+        mrs_msgs::ReferenceStamped from_point;
+        from_point.header.frame_id      = cache.frame_to;
+        from_point.reference.position.x = position_cmd.x();
+        from_point.reference.position.y = position_cmd.y();
+        from_point.reference.position.z = position_cmd.z();
+
+        if (!isPathToPointInSafetyArea3d(from_point, safety_reference)) {
+          ROS_ERROR_THROTTLE(1.0, "[ControlManager]: failed to set the reference, the path is going outside the safety area!");
+          return false;
+        }
+      }
+    }
+  }
+
+  // | ------------------ pass it to the tracker ----------------- |
+
+  mrs_msgs::VelocityReferenceSrvRequest::Ptr reference_request = pool_velocity_reference_request_.acquire();
+
+  reference_request->reference = reference;
+
+  {
+    std::scoped_lock lock(mutex_tracker_list_);
+
+    mrs_msgs::VelocityReferenceSrvResponse::ConstPtr tracker_response = tracker_list_[active_tracker_idx_]->setVelocityReference(reference_request);
+
+    if (tracker_response == mrs_msgs::VelocityReferenceSrvResponse::Ptr()) {
+      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: the tracker '%s' does not implement the 'setVelocityReference()' function!",
+                         _tracker_names_[active_tracker_idx_].c_str());
+      return false;
+    }
+
+    if (tracker_response->success) {
+      velocity_reference_fast_path_applied_++;
+    }
+
+    return tracker_response->success;
+  }
+}
+
+//}
+
+/* setTrajectoryReference() //{ */
+
+std::tuple<bool, std::string, bool, std::vector<std::string>, std::vector<bool>, std::vector<std::string>> ControlManager::setTrajectoryReference(
+    const mrs_msgs::TrajectoryReference trajectory_in) {
+
+  auto uav_state         = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
+  auto last_position_cmd = mrs_lib::get_mutexed(mutex_last_position_cmd_, last_position_cmd_);
+
+  std::stringstream ss;
+
+  if (!callbacks_enabled_) {
+    ss << "can not set the reference, the callbacks are disabled";
+    ROS_WARN_STREAM_THROTTLE(1.0, "[ControlManager]: " << ss.str());
+    return std::tuple(false, ss.str(), false, std::vector<std::string>(), std::vector<bool>(), std::vector<std::string>());
+  }
+
+  /* validate the size and check for NaNs //{ */
+
+  // check for the size 0, which is invalid
+  if (trajectory_in.points.size() == 0) {
+
+    ss << "can not load trajectory with size 0";
+    ROS_WARN_STREAM_THROTTLE(1.0, "[ControlManager]: " << ss.str());
+    return std::tuple(false, ss.str(), false, std::vector<std::string>(), std::vector<bool>(), std::vector<std::string>());
+  }
+
+  for (int i = 0; i < int(trajectory_in.points.size()); i++) {
+
+    // check the point for NaN/inf
+    bool no_nans = true;
+
+    if (!std::isfinite(trajectory_in.points[i].position.x)) {
+      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN/inf detected in variable 'trajectory_in.points[%d].x'!!!", i);
+      no_nans = false;
+    }
+
+    if (!std::isfinite(trajectory_in.points[i].position.y)) {
+      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN/inf detected in variable 'trajectory_in.points[%d].y'!!!", i);
+      no_nans = false;
+    }
+
+    if (!std::isfinite(trajectory_in.points[i].position.z)) {
+      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN/inf detected in variable 'trajectory_in.points[%d].z'!!!", i);
+      no_nans = false;
+    }
+
+    if (!std::isfinite(trajectory_in.points[i].heading)) {
+      ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN/inf detected in variable 'trajectory_in.points[%d].heading'!!!", i);
+      no_nans = false;
+    }
+
+    if (no_nans == false) {
+
+      ss << "trajectory contains NaNs/infs.";
+      ROS_WARN_STREAM_THROTTLE(1.0, "[ControlManager]: " << ss.str());
+      return std::tuple(false, ss.str(), false, std::vector<std::string>(), std::vector<bool>(), std::vector<std::string>());
+    }
+  }
+
+  //}
+
+  /* publish the debugging topics of the original trajectory //{ */
+
+  {
+
+    geometry_msgs::PoseArray debug_trajectory_out;
+    debug_trajectory_out.header = trajectory_in.header;
+
+    debug_trajectory_out.header.frame_id = transformer_->resolveFrame(debug_trajectory_out.header.frame_id);
+
+    if (debug_trajectory_out.header.stamp == ros::Time(0)) {
+      debug_trajectory_out.header.stamp = ros::Time::now();
+    }
+
+    for (int i = 0; i < int(trajectory_in.points.size()) - 1; i++) {
+
+      geometry_msgs::Pose new_pose;
+
+      new_pose.position.x = trajectory_in.points[i].position.x;
+      new_pose.position.y = trajectory_in.points[i].position.y;
+      new_pose.position.z = trajectory_in.points[i].position.z;
+
+      new_pose.orientation = mrs_lib::AttitudeConverter(0, 0, trajectory_in.points[i].heading);
+
+      debug_trajectory_out.poses.push_back(new_pose);
     }
 
     pub_debug_original_trajectory_poses_.publish(debug_trajectory_out);
@@ -6391,7 +8018,8 @@ void ControlManager::setCallbacks(bool in) {
 
 /* publishDiagnostics() //{ */
 
-void ControlManager::publishDiagnostics(void) {
+// forced = publish regardless of the change-driven mode, used right after a state transition (switching, motors, eland, failsafe)
+void ControlManager::publishDiagnostics(const bool forced) {
 
   if (!is_initialized_) {
     return;
@@ -6403,6 +8031,7 @@ void ControlManager::publishDiagnostics(void) {
   std::scoped_lock lock(mutex_diagnostics_);
 
   mrs_msgs::ControlManagerDiagnostics diagnostics_msg;
+  state_board::ControlManagerState    board_state;
 
   diagnostics_msg.stamp    = ros::Time::now();
   diagnostics_msg.uav_name = _uav_name_;
@@ -6426,6 +8055,10 @@ void ControlManager::publishDiagnostics(void) {
 
     diagnostics_msg.active_tracker = _tracker_names_[active_tracker_idx_];
     diagnostics_msg.tracker_status = tracker_list_[active_tracker_idx_]->getStatus();
+
+    if (state_board_) {
+      board_state.active_tracker = tracker_ids_[active_tracker_idx_];
+    }
   }
 
   // | --------------- fill the controller status --------------- |
@@ -6437,40 +8070,153 @@ void ControlManager::publishDiagnostics(void) {
 
     diagnostics_msg.active_controller = _controller_names_[active_controller_idx_];
     diagnostics_msg.controller_status = controller_list_[active_controller_idx_]->getStatus();
+
+    if (state_board_) {
+      board_state.active_controller = controller_ids_[active_controller_idx_];
+    }
   }
 
   // | ------------ fill in the available controllers ----------- |
 
   for (int i = 0; i < int(_controller_names_.size()); i++) {
-    if ((_controller_names_[i] != _failsafe_controller_name_) && (_controller_names_[i] != _eland_controller_name_)) {
+    if ((i != _failsafe_controller_idx_) && (i != _eland_controller_idx_)) {
       diagnostics_msg.available_controllers.push_back(_controller_names_[i]);
-      diagnostics_msg.human_switchable_controllers.push_back(controllers_.at(_controller_names_[i]).human_switchable);
+      diagnostics_msg.human_switchable_controllers.push_back(controllers_.params(i).human_switchable);
     }
   }
 
   // | ------------- fill in the available trackers ------------- |
 
   for (int i = 0; i < int(_tracker_names_.size()); i++) {
-    if (_tracker_names_[i] != _null_tracker_name_) {
+    if (i != _null_tracker_idx_) {
       diagnostics_msg.available_trackers.push_back(_tracker_names_[i]);
-      diagnostics_msg.human_switchable_trackers.push_back(trackers_.at(_tracker_names_[i]).human_switchable);
+      diagnostics_msg.human_switchable_trackers.push_back(trackers_.params(i).human_switchable);
+    }
+  }
+
+  // | ------------------ update the state board ---------------- |
+
+  // the board is updated on every call, regardless of the change-driven suppression below
+  if (state_board_) {
+
+    board_state.stamp              = diagnostics_msg.stamp.toSec();
+    board_state.motors             = diagnostics_msg.motors;
+    board_state.rc_mode            = diagnostics_msg.rc_mode;
+    board_state.flying_normally    = diagnostics_msg.flying_normally;
+    board_state.tracker_active     = diagnostics_msg.tracker_status.active;
+    board_state.have_goal          = diagnostics_msg.tracker_status.have_goal;
+    board_state.controller_active  = diagnostics_msg.controller_status.active;
+    board_state.eland_triggered    = eland_triggered_;
+    board_state.failsafe_triggered = failsafe_triggered_;
+
+    const double max_thrust_force = mrs_lib::quadratic_thrust_model::thrustToForce(common_handlers_->motor_params, 1.0);
+
+    board_state.mass_nominal    = _uav_mass_;
+    board_state.mass_estimate   = getMass();
+    board_state.thrust_headroom = max_thrust_force > 0 ? 1.0 - (board_state.mass_estimate * common_handlers_->g) / max_thrust_force : 0.0;
+
+    {
+      std::scoped_lock lock(mutex_uav_state_);
+
+      board_state.speed  = std::hypot(uav_state_.velocity.linear.x, uav_state_.velocity.linear.y);
+      board_state.height = uav_state_.pose.position.z;
+
+      if (_state_input_ == INPUT_UAV_STATE && uav_state_.estimator_horizontal.name != "") {
+        board_state.estimator      = board_estimator_.get(state_board_->names, uav_state_.estimator_horizontal.name);
+        board_state.estimator_type = uav_state_.estimator_horizontal.type;
+      }
     }
+
+    state_board_->control_manager.store(board_state);
   }
 
   // | ------------------------- publish ------------------------ |
 
+  // in the change-driven mode, the periodic calls only publish when something changed or when the heartbeat is due
+  if (_diagnostics_change_driven_ && !forced && got_last_diagnostics_) {
+
+    bool heartbeat_due = (diagnostics_msg.stamp - last_diagnostics_time_).toSec() >= (1.0 / _diagnostics_heartbeat_rate_);
+
+    if (!heartbeat_due && !diagnosticsChanged(diagnostics_msg, last_diagnostics_)) {
+      return;
+    }
+  }
+
   ph_diagnostics_.publish(diagnostics_msg);
+
+  last_diagnostics_      = diagnostics_msg;
+  last_diagnostics_time_ = diagnostics_msg.stamp;
+  got_last_diagnostics_  = true;
+}
+
+//}
+
+/* diagnosticsChanged() //{ */
+
+bool ControlManager::diagnosticsChanged(const mrs_msgs::ControlManagerDiagnostics& current, const mrs_msgs::ControlManagerDiagnostics& previous) {
+
+  // the stamp is deliberately not compared, the available trackers/controllers are static
+  return current.motors != previous.motors || current.rc_mode != previous.rc_mode || current.flying_normally != previous.flying_normally ||
+         current.active_tracker != previous.active_tracker || current.active_controller != previous.active_controller ||
+         current.tracker_status != previous.tracker_status || current.controller_status != previous.controller_status;
+}
+
+//}
+
+/* updateSanitizedConstraints() //{ */
+
+// returns true when the sanitized constraints changed and have to be sent to the plugins
+bool ControlManager::updateSanitizedConstraints(const bool ignore_controller_limits) {
+
+  ControllerConstraintsLimits limits;
+
+  if (!ignore_controller_limits) {
+    limits = getControllerConstraintsLimits();
+  }
+
+  std::scoped_lock lock(mutex_constraints_);
+
+  if (!ignore_controller_limits && current_constraints_version_ == enforced_constraints_version_ && limits == enforced_constraints_limits_) {
+    return false;
+  }
+
+  mrs_msgs::DynamicsConstraintsSrvRequest sanitized_constraints = current_constraints_;
+
+  enforceControllersConstraints(sanitized_constraints, limits);
+
+  enforced_constraints_version_ = current_constraints_version_;
+  enforced_constraints_limits_  = limits;
+
+  if (sanitized_constraints_version_ > 0 && sanitized_constraints.constraints == sanitized_constraints_.constraints) {
+    return false;
+  }
+
+  sanitized_constraints_ = sanitized_constraints;
+  sanitized_constraints_version_++;
+
+  return true;
 }
 
 //}
 
 /* setConstraints() //{ */
 
-void ControlManager::setConstraints(mrs_msgs::DynamicsConstraintsSrvRequest constraints) {
+// sends the sanitized constraints to the plugins which did not get the current version yet
+void ControlManager::setConstraints(void) {
 
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("setConstraints");
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::setConstraints", scope_timer_logger_, scope_timer_enabled_);
 
+  mrs_msgs::DynamicsConstraintsSrvRequest::ConstPtr constraints;
+  uint64_t                                          version;
+
+  {
+    std::scoped_lock lock(mutex_constraints_);
+
+    constraints = mrs_msgs::DynamicsConstraintsSrvRequest::ConstPtr(std::make_unique<mrs_msgs::DynamicsConstraintsSrvRequest>(sanitized_constraints_));
+    version     = sanitized_constraints_version_;
+  }
+
   mrs_msgs::DynamicsConstraintsSrvResponse::ConstPtr response;
 
   {
@@ -6479,9 +8225,13 @@ void ControlManager::setConstraints(mrs_msgs::DynamicsConstraintsSrvRequest cons
     // for each tracker
     for (int i = 0; i < int(tracker_list_.size()); i++) {
 
-      // if it is the active one, update and retrieve the command
-      response = tracker_list_[i]->setConstraints(
-          mrs_msgs::DynamicsConstraintsSrvRequest::ConstPtr(std::make_unique<mrs_msgs::DynamicsConstraintsSrvRequest>(constraints)));
+      if (tracker_constraints_version_[i] == version) {
+        continue;
+      }
+
+      response = tracker_list_[i]->setConstraints(constraints);
+
+      tracker_constraints_version_[i] = version;
     }
   }
 
@@ -6491,75 +8241,100 @@ void ControlManager::setConstraints(mrs_msgs::DynamicsConstraintsSrvRequest cons
     // for each controller
     for (int i = 0; i < int(controller_list_.size()); i++) {
 
-      // if it is the active one, update and retrieve the command
-      response = controller_list_[i]->setConstraints(
-          mrs_msgs::DynamicsConstraintsSrvRequest::ConstPtr(std::make_unique<mrs_msgs::DynamicsConstraintsSrvRequest>(constraints)));
+      if (controller_constraints_version_[i] == version) {
+        continue;
+      }
+
+      response = controller_list_[i]->setConstraints(constraints);
+
+      controller_constraints_version_[i] = version;
     }
   }
 }
 
 //}
 
-/* enforceControllerConstraints() //{ */
+/* getControllerConstraintsLimits() //{ */
 
-bool ControlManager::enforceControllersConstraints(mrs_msgs::DynamicsConstraintsSrvRequest& constraints) {
+ControlManager::ControllerConstraintsLimits ControlManager::getControllerConstraintsLimits(void) {
 
-  // copy member variables
-  auto last_attitude_cmd     = mrs_lib::get_mutexed(mutex_last_attitude_cmd_, last_attitude_cmd_);
-  auto active_controller_idx = mrs_lib::get_mutexed(mutex_controller_list_, active_controller_idx_);
+  auto last_attitude_cmd = mrs_lib::get_mutexed(mutex_last_attitude_cmd_, last_attitude_cmd_);
 
-  bool enforcing = false;
+  ControllerConstraintsLimits limits;
 
-  if (last_attitude_cmd != mrs_msgs::AttitudeCommand::Ptr()) {
-    if (last_attitude_cmd->controller_enforcing_constraints) {
+  if (last_attitude_cmd == mrs_msgs::AttitudeCommand::Ptr() || !last_attitude_cmd->controller_enforcing_constraints) {
+    return limits;
+  }
 
-      std::scoped_lock lock(mutex_tracker_list_);
+  limits.enforcing                  = true;
+  limits.horizontal_speed           = last_attitude_cmd->horizontal_speed_constraint;
+  limits.horizontal_acceleration    = last_attitude_cmd->horizontal_acc_constraint;
+  limits.vertical_asc_speed         = last_attitude_cmd->vertical_asc_speed_constraint;
+  limits.vertical_asc_acceleration  = last_attitude_cmd->vertical_asc_acc_constraint;
+  limits.vertical_desc_speed        = last_attitude_cmd->vertical_desc_speed_constraint;
+  limits.vertical_desc_acceleration = last_attitude_cmd->vertical_desc_acc_constraint;
 
-      // enforce horizontal speed
-      if (last_attitude_cmd->horizontal_speed_constraint < constraints.constraints.horizontal_speed) {
-        constraints.constraints.horizontal_speed = last_attitude_cmd->horizontal_speed_constraint;
+  return limits;
+}
 
-        enforcing = true;
-      }
+//}
 
-      // enforce horizontal acceleration
-      if (last_attitude_cmd->horizontal_acc_constraint < constraints.constraints.horizontal_acceleration) {
-        constraints.constraints.horizontal_acceleration = last_attitude_cmd->horizontal_acc_constraint;
+/* enforceControllerConstraints() //{ */
 
-        enforcing = true;
-      }
+bool ControlManager::enforceControllersConstraints(mrs_msgs::DynamicsConstraintsSrvRequest& constraints, const ControllerConstraintsLimits& limits) {
 
-      // enforce vertical ascending speed
-      if (last_attitude_cmd->vertical_asc_speed_constraint < constraints.constraints.vertical_ascending_speed) {
-        constraints.constraints.vertical_ascending_speed = last_attitude_cmd->vertical_asc_speed_constraint;
+  if (!limits.enforcing) {
+    return false;
+  }
 
-        enforcing = true;
-      }
+  bool enforcing = false;
 
-      // enforce vertical ascending acceleration
-      if (last_attitude_cmd->vertical_asc_acc_constraint < constraints.constraints.vertical_ascending_acceleration) {
-        constraints.constraints.vertical_ascending_acceleration = last_attitude_cmd->vertical_asc_acc_constraint;
+  // enforce horizontal speed
+  if (limits.horizontal_speed < constraints.constraints.horizontal_speed) {
+    constraints.constraints.horizontal_speed = limits.horizontal_speed;
 
-        enforcing = true;
-      }
+    enforcing = true;
+  }
 
-      // enforce vertical descending speed
-      if (last_attitude_cmd->vertical_desc_speed_constraint < constraints.constraints.vertical_descending_speed) {
-        constraints.constraints.vertical_descending_speed = last_attitude_cmd->vertical_desc_speed_constraint;
+  // enforce horizontal acceleration
+  if (limits.horizontal_acceleration < constraints.constraints.horizontal_acceleration) {
+    constraints.constraints.horizontal_acceleration = limits.horizontal_acceleration;
 
-        enforcing = true;
-      }
+    enforcing = true;
+  }
 
-      // enforce vertical descending acceleration
-      if (last_attitude_cmd->vertical_desc_acc_constraint < constraints.constraints.vertical_descending_acceleration) {
-        constraints.constraints.vertical_descending_acceleration = last_attitude_cmd->vertical_desc_acc_constraint;
+  // enforce vertical ascending speed
+  if (limits.vertical_asc_speed < constraints.constraints.vertical_ascending_speed) {
+    constraints.constraints.vertical_ascending_speed = limits.vertical_asc_speed;
 
-        enforcing = true;
-      }
-    }
+    enforcing = true;
+  }
+
+  // enforce vertical ascending acceleration
+  if (limits.vertical_asc_acceleration < constraints.constraints.vertical_ascending_acceleration) {
+    constraints.constraints.vertical_ascending_acceleration = limits.vertical_asc_acceleration;
+
+    enforcing = true;
+  }
+
+  // enforce vertical descending speed
+  if (limits.vertical_desc_speed < constraints.constraints.vertical_descending_speed) {
+    constraints.constraints.vertical_descending_speed = limits.vertical_desc_speed;
+
+    enforcing = true;
+  }
+
+  // enforce vertical descending acceleration
+  if (limits.vertical_desc_acceleration < constraints.constraints.vertical_descending_acceleration) {
+    constraints.constraints.vertical_descending_acceleration = limits.vertical_desc_acceleration;
+
+    enforcing = true;
   }
 
   if (enforcing) {
+
+    auto active_controller_idx = mrs_lib::get_mutexed(mutex_controller_list_, active_controller_idx_);
+
     ROS_WARN_THROTTLE(1.0, "[ControlManager]: the controller '%s' is enforcing constraints over the ConstraintManager",
                       _controller_names_[active_controller_idx].c_str());
   }
@@ -6722,9 +8497,34 @@ bool ControlManager::isPathToPointInSafetyArea2d(const mrs_msgs::ReferenceStampe
 
 //}
 
-/* //{ getMaxHeight() */
+/* //{ safetyAreaClearance() */
 
-double ControlManager::getMaxHeight(void) {
+// [m], the horizontal distance from a point in the safety area frame to the nearest edge of the border, of a polygon obstacle or of a point obstacle
+double ControlManager::safetyAreaClearance(const Eigen::Vector2d& point) {
+
+  double clearance = std::numeric_limits<double>::max();
+
+  for (auto& [a, b] : safety_area_edges_) {
+
+    const Eigen::Vector2d edge      = b - a;
+    const double          length_sq = edge.squaredNorm();
+    const double          t         = length_sq > 0 ? std::clamp((point - a).dot(edge) / length_sq, 0.0, 1.0) : 0.0;
+
+    clearance = std::min(clearance, (a + t * edge - point).norm());
+  }
+
+  for (auto& [center, radius] : safety_area_circles_) {
+    clearance = std::min(clearance, (point - center).norm() - radius);
+  }
+
+  return clearance;
+}
+
+//}
+
+/* //{ getMaxHeight() */
+
+double ControlManager::getMaxHeight(void) {
 
   double max_height;
 
@@ -6757,6 +8557,155 @@ double ControlManager::getMinHeight(void) {
 
 //}
 
+/* //{ predictUavState() */
+
+// constant acceleration prediction of the translational state, the orientation is kept
+mrs_msgs::UavState ControlManager::predictUavState(const mrs_msgs::UavState& uav_state, const double dt) {
+
+  mrs_msgs::UavState predicted = uav_state;
+
+  if (dt <= 0) {
+    return predicted;
+  }
+
+  const auto& vel = uav_state.velocity.linear;
+  const auto& acc = uav_state.acceleration.linear;
+
+  predicted.pose.position.x += vel.x * dt + 0.5 * acc.x * dt * dt;
+  predicted.pose.position.y += vel.y * dt + 0.5 * acc.y * dt * dt;
+  predicted.pose.position.z += vel.z * dt + 0.5 * acc.z * dt * dt;
+
+  predicted.velocity.linear.x += acc.x * dt;
+  predicted.velocity.linear.y += acc.y * dt;
+  predicted.velocity.linear.z += acc.z * dt;
+
+  return predicted;
+}
+
+//}
+
+/* //{ inputArrived() */
+
+void ControlManager::inputArrived(const MonitoredInput_t input, const ros::Time& stamp) {
+
+  // unstamped messages have no age
+  const double age = stamp.isZero() ? -1.0 : (ros::Time::now() - stamp).toSec();
+
+  input_timing_[input]->arrived(timing::monotonicNs(), age);
+}
+
+//}
+
+/* //{ applyReferenceMailboxes() */
+
+void ControlManager::applyReferenceMailboxes(void) {
+
+  std::pair<mrs_msgs::ReferenceStampedConstPtr, int64_t>         reference;
+  std::pair<mrs_msgs::VelocityReferenceStampedConstPtr, int64_t> velocity_reference;
+
+  const int64_t max_age = int64_t(_reference_mailbox_max_age_ * 1e9);
+
+  if (mailbox_reference_.take(reference)) {
+
+    const int64_t age = timing::monotonicNs() - reference.second;
+
+    if (age > max_age) {
+
+      mailbox_reference_expired_++;
+
+      ROS_WARN_THROTTLE(1.0, "[ControlManager]: dropping a reference from the mailbox, it is %.3f s old", double(age) * 1e-9);
+
+    } else {
+
+      setReference(*reference.first);
+
+      std::scoped_lock lock(mutex_reference_mailbox_latency_);
+
+      reference_mailbox_latency_.add(double(timing::monotonicNs() - reference.second) * 1e-9);
+    }
+  }
+
+  if (mailbox_velocity_reference_.take(velocity_reference)) {
+
+    const int64_t age = timing::monotonicNs() - velocity_reference.second;
+
+    if (age > max_age) {
+
+      mailbox_velocity_reference_expired_++;
+
+      ROS_WARN_THROTTLE(1.0, "[ControlManager]: dropping a velocity reference from the mailbox, it is %.3f s old", double(age) * 1e-9);
+
+    } else {
+
+      if (_velocity_reference_fast_path_enabled_) {
+        setVelocityReferenceFast(*velocity_reference.first);
+      } else {
+        setVelocityReference(*velocity_reference.first);
+      }
+
+      std::scoped_lock lock(mutex_reference_mailbox_latency_);
+
+      velocity_reference_mailbox_latency_.add(double(timing::monotonicNs() - velocity_reference.second) * 1e-9);
+    }
+  }
+}
+
+//}
+
+/* //{ runCommand() */
+
+// executes the command through the command queue (when enabled) and returns its result
+template <typename F>
+std::invoke_result_t<F> ControlManager::runCommand(F&& command) {
+
+  if (!_command_queue_enabled_ || in_control_loop) {
+    return command();
+  }
+
+  auto result = command_queue_.post(std::forward<F>(command));
+
+  while (result.wait_for(std::chrono::duration<double>(_command_queue_fallback_timeout_)) != std::future_status::ready) {
+
+    // the control loop does not run, execute the commands instead of it
+    bool expected = false;
+
+    if (running_async_control_.compare_exchange_strong(expected, true)) {
+
+      mrs_lib::AtomicScopeFlag unset_running(running_async_control_);
+
+      in_control_loop = true;
+
+      command_queue_.drain();
+
+      in_control_loop = false;
+
+      command_queue_fallbacks_++;
+    }
+  }
+
+  return result.get();
+}
+
+//}
+
+/* //{ startAsyncControl() */
+
+// runs the control loop asynchronously, but only if it is not already running
+void ControlManager::startAsyncControl(void) {
+
+  bool expected = false;
+
+  if (!running_async_control_.compare_exchange_strong(expected, true)) {
+    return;
+  }
+
+  std::scoped_lock lock(mutex_async_control_result_);
+
+  async_control_result_ = std::async(std::launch::async, &ControlManager::asyncControl, this);
+}
+
+//}
+
 /* //{ getMass() */
 
 double ControlManager::getMass(void) {
@@ -7094,13 +9043,12 @@ bool ControlManager::bumperPushFromObstacle(void) {
 
       if (_bumper_switch_tracker_) {
 
-        auto        active_tracker_idx  = mrs_lib::get_mutexed(mutex_tracker_list_, active_tracker_idx_);
-        std::string active_tracker_name = _tracker_names_[active_tracker_idx];
+        auto active_tracker_idx = mrs_lib::get_mutexed(mutex_tracker_list_, active_tracker_idx_);
 
         // remember the previously active tracker
-        bumper_previous_tracker_ = active_tracker_name;
+        bumper_previous_tracker_ = _tracker_names_[active_tracker_idx];
 
-        if (active_tracker_name != _bumper_tracker_name_) {
+        if (active_tracker_idx != _bumper_tracker_idx_) {
 
           switchTracker(_bumper_tracker_name_);
         }
@@ -7108,13 +9056,12 @@ bool ControlManager::bumperPushFromObstacle(void) {
 
       if (_bumper_switch_controller_) {
 
-        auto        active_controller_idx  = mrs_lib::get_mutexed(mutex_controller_list_, active_controller_idx_);
-        std::string active_controller_name = _controller_names_[active_controller_idx];
+        auto active_controller_idx = mrs_lib::get_mutexed(mutex_controller_list_, active_controller_idx_);
 
         // remember the previously active controller
-        bumper_previous_controller_ = active_controller_name;
+        bumper_previous_controller_ = _controller_names_[active_controller_idx];
 
-        if (active_controller_name != _bumper_controller_name_) {
+        if (active_controller_idx != _bumper_controller_idx_) {
 
           switchController(_bumper_controller_name_);
         }
@@ -7295,8 +9242,14 @@ void ControlManager::changeLandingState(LandingStates_t new_state) {
 
   switch (current_state_landing_) {
 
-    case IDLE_STATE:
-      break;
+    case IDLE_STATE: {
+
+      std::scoped_lock lock(mutex_landing_detector_);
+
+      landing_detector_.stop();
+    }
+
+    break;
     case LANDING_STATE: {
 
       ROS_DEBUG("[ControlManager]: starting eland timer");
@@ -7310,6 +9263,12 @@ void ControlManager::changeLandingState(LandingStates_t new_state) {
       } else {
         landing_uav_mass_ = _uav_mass_ + last_attitude_cmd->mass_difference;
       }
+
+      {
+        std::scoped_lock lock(mutex_landing_detector_);
+
+        landing_detector_.reset(landing_uav_mass_);
+      }
     }
 
     break;
@@ -7500,6 +9459,8 @@ std::tuple<bool, std::string> ControlManager::eland(void) {
 
     callbacks_enabled_ = false;
 
+    publishDiagnostics(true);
+
   } else {
 
     ss << "error during activation of eland";
@@ -7598,10 +9559,16 @@ std::tuple<bool, std::string> ControlManager::failsafe(void) {
         landing_uav_mass_ = _uav_mass_ + last_attitude_cmd->mass_difference;
       }
 
+      {
+        std::scoped_lock lock(mutex_landing_detector_);
+
+        landing_detector_.reset(landing_uav_mass_);
+      }
+
       eland_triggered_ = false;
-      ROS_DEBUG("[ControlManager]: starting failsafe timer");
-      timer_failsafe_.start();
-      ROS_DEBUG("[ControlManager]: failsafe timer started");
+      ROS_DEBUG("[ControlManager]: starting failsafe loop");
+      failsafe_loop_->start();
+      ROS_DEBUG("[ControlManager]: failsafe loop started");
 
       bumper_enabled_ = false;
 
@@ -7616,6 +9583,7 @@ std::tuple<bool, std::string> ControlManager::failsafe(void) {
 
         controller_list_[active_controller_idx_]->deactivate();
         active_controller_idx_ = _failsafe_controller_idx_;
+        installSafetyThresholds(active_controller_idx_);
       }
       catch (std::runtime_error& exrun) {
         ROS_ERROR_THROTTLE(1.0, "[ControlManager]: could not deactivate the controller '%s'", _controller_names_[active_controller_idx_].c_str());
@@ -7627,6 +9595,8 @@ std::tuple<bool, std::string> ControlManager::failsafe(void) {
     }
   }
 
+  publishDiagnostics(true);
+
   return std::tuple(true, "failsafe activated");
 }
 
@@ -8000,9 +9970,9 @@ std::tuple<bool, std::string> ControlManager::arming(const bool input) {
 
         switchMotors(false);
 
-        ROS_DEBUG("[ControlManager]: stopping failsafe timer");
-        timer_failsafe_.stop();
-        ROS_DEBUG("[ControlManager]: failsafe timer stopped");
+        ROS_DEBUG("[ControlManager]: stopping failsafe loop");
+        failsafe_loop_->stop();
+        ROS_DEBUG("[ControlManager]: failsafe loop stopped");
 
         ROS_DEBUG("[ControlManager]: stopping the eland timer");
         timer_eland_.stop();
@@ -8178,11 +10148,8 @@ void ControlManager::switchMotors(bool input) {
 
     for (int i = 0; i < int(tracker_list_.size()); i++) {
 
-      std::map<std::string, TrackerParams>::iterator it;
-      it = trackers_.find(_tracker_names_[i]);
-
       try {
-        ROS_INFO("[ControlManager]: deactivating the tracker '%s'", it->second.address.c_str());
+        ROS_INFO("[ControlManager]: deactivating the tracker '%s'", trackers_.params(i).address.c_str());
         tracker_list_[i]->deactivate();
       }
       catch (std::runtime_error& ex) {
@@ -8192,11 +10159,8 @@ void ControlManager::switchMotors(bool input) {
 
     for (int i = 0; i < int(controller_list_.size()); i++) {
 
-      std::map<std::string, ControllerParams>::iterator it;
-      it = controllers_.find(_controller_names_[i]);
-
       try {
-        ROS_INFO("[ControlManager]: deactivating the controller '%s'", it->second.address.c_str());
+        ROS_INFO("[ControlManager]: deactivating the controller '%s'", controllers_.params(i).address.c_str());
         controller_list_[i]->deactivate();
       }
       catch (std::runtime_error& ex) {
@@ -8206,6 +10170,8 @@ void ControlManager::switchMotors(bool input) {
 
     offboard_mode_was_true_ = false;
   }
+
+  publishDiagnostics(true);
 }
 
 //}
@@ -8245,13 +10211,7 @@ std::tuple<bool, std::string> ControlManager::switchTracker(const std::string tr
     return std::tuple(false, ss.str());
   }
 
-  int new_tracker_idx = -1;
-
-  for (int i = 0; i < int(_tracker_names_.size()); i++) {
-    if (tracker_name == _tracker_names_[i]) {
-      new_tracker_idx = i;
-    }
-  }
+  int new_tracker_idx = trackers_.find(tracker_name);
 
   // check if the tracker exists
   if (new_tracker_idx < 0) {
@@ -8303,7 +10263,7 @@ std::tuple<bool, std::string> ControlManager::switchTracker(const std::string tr
           tracker_list_[active_tracker_idx_]->deactivate();
 
           // if switching from null tracker, activate the active the controller
-          if (_tracker_names_[active_tracker_idx_] == _null_tracker_name_) {
+          if (active_tracker_idx_ == _null_tracker_idx_) {
 
             ROS_INFO("[ControlManager]: reactivating '%s' due to switching from 'NullTracker'", _controller_names_[active_controller_idx_].c_str());
             {
@@ -8341,7 +10301,7 @@ std::tuple<bool, std::string> ControlManager::switchTracker(const std::string tr
             }
 
             // if switching to null tracker, deactivate the active controller
-          } else if (_tracker_names_[new_tracker_idx] == _null_tracker_name_) {
+          } else if (new_tracker_idx == _null_tracker_idx_) {
 
             ROS_INFO("[ControlManager]: deactivating '%s' due to switching to 'NullTracker'", _controller_names_[active_controller_idx_].c_str());
             {
@@ -8364,11 +10324,133 @@ std::tuple<bool, std::string> ControlManager::switchTracker(const std::string tr
     }
   }
 
+  publishDiagnostics(true);
+
   return std::tuple(true, ss.str());
 }
 
 //}
 
+/* createCommands() //{ */
+
+// the commands call the service callbacks directly, so they share all the checks with the services,
+// only the (de)serialization and the round trip through the ROS master/TCP are skipped
+std::shared_ptr<const state_board::ControlManagerCommands> ControlManager::createCommands(void) {
+
+  typedef std::tuple<bool, std::string> result_t;
+
+  std::shared_ptr<CommandsLifetime> lifetime = commands_lifetime_;
+  ros::CallbackQueueInterface*      queue    = nh_services_.getCallbackQueue();
+
+  // executes the command by the services' queue and waits for it
+  auto execute = [lifetime, queue](const std::function<result_t(void)>& command) {
+    auto task = std::make_shared<std::packaged_task<result_t(void)>>([lifetime, command]() {
+      std::shared_lock lock(lifetime->mutex);
+
+      if (!lifetime->alive) {
+        return result_t(false, "the ControlManager is not running");
+      }
+
+      return command();
+    });
+
+    std::future<result_t> result = task->get_future();
+
+    {
+      std::shared_lock lock(lifetime->mutex);
+
+      // the queue lives as long as the ControlManager
+      if (!lifetime->alive) {
+        return result_t(false, "the ControlManager is not running");
+      }
+
+      queue->addCallback(boost::make_shared<FunctionCallback>([task]() { (*task)(); }));
+    }
+
+    // the queue drops its callbacks when it is destroyed, the task is then broken
+    try {
+      return result.get();
+    }
+    catch (std::future_error& e) {
+      return result_t(false, "the ControlManager is not running");
+    }
+  };
+
+  auto commands = std::make_shared<state_board::ControlManagerCommands>();
+
+  commands->switch_tracker = [this, execute](const std::string& tracker) {
+    return execute([this, tracker]() {
+      mrs_msgs::String::Request  req;
+      mrs_msgs::String::Response res;
+      req.value = tracker;
+      callbackSwitchTracker(req, res);
+      return result_t(res.success, res.message);
+    });
+  };
+
+  commands->switch_controller = [this, execute](const std::string& controller) {
+    return execute([this, controller]() {
+      mrs_msgs::String::Request  req;
+      mrs_msgs::String::Response res;
+      req.value = controller;
+      callbackSwitchController(req, res);
+      return result_t(res.success, res.message);
+    });
+  };
+
+  commands->emergency_reference = [this, execute](const mrs_msgs::ReferenceStamped& goal) {
+    return execute([this, goal]() {
+      mrs_msgs::ReferenceStampedSrv::Request  req;
+      mrs_msgs::ReferenceStampedSrv::Response res;
+      req.header    = goal.header;
+      req.reference = goal.reference;
+      callbackEmergencyReference(req, res);
+      return result_t(res.success, res.message);
+    });
+  };
+
+  commands->enable_callbacks = [this, execute](const bool enable) {
+    return execute([this, enable]() {
+      std_srvs::SetBool::Request  req;
+      std_srvs::SetBool::Response res;
+      req.data = enable;
+      callbackEnableCallbacks(req, res);
+      return result_t(res.success, res.message);
+    });
+  };
+
+  commands->eland = [this, execute]() {
+    return execute([this]() {
+      std_srvs::Trigger::Request  req;
+      std_srvs::Trigger::Response res;
+      callbackEland(req, res);
+      return result_t(res.success, res.message);
+    });
+  };
+
+  commands->ehover = [this, execute]() {
+    return execute([this]() {
+      std_srvs::Trigger::Request  req;
+      std_srvs::Trigger::Response res;
+      callbackEHover(req, res);
+      return result_t(res.success, res.message);
+    });
+  };
+
+  return commands;
+}
+
+//}
+
+/* installSafetyThresholds() //{ */
+
+void ControlManager::installSafetyThresholds(const int controller_idx) {
+
+  safety_thresholds_.store(&safety_thresholds_table_[controller_idx], std::memory_order_release);
+}
+
+//}
+
 /* switchController() //{ */
 
 std::tuple<bool, std::string> ControlManager::switchController(const std::string controller_name) {
@@ -8404,13 +10486,7 @@ std::tuple<bool, std::string> ControlManager::switchController(const std::string
     return std::tuple(false, ss.str());
   }
 
-  int new_controller_idx = -1;
-
-  for (int i = 0; i < int(_controller_names_.size()); i++) {
-    if (controller_name == _controller_names_[i]) {
-      new_controller_idx = i;
-    }
-  }
+  int new_controller_idx = controllers_.find(controller_name);
 
   // check if the controller exists
   if (new_controller_idx < 0) {
@@ -8470,6 +10546,7 @@ std::tuple<bool, std::string> ControlManager::switchController(const std::string
 
           controller_list_[active_controller_idx_]->deactivate();
           active_controller_idx_ = new_controller_idx;
+          installSafetyThresholds(active_controller_idx_);
         }
         catch (std::runtime_error& exrun) {
           ROS_ERROR("[ControlManager]: could not deactivate controller '%s'", _controller_names_[active_controller_idx_].c_str());
@@ -8482,15 +10559,12 @@ std::tuple<bool, std::string> ControlManager::switchController(const std::string
     }
   }
 
-  mrs_msgs::DynamicsConstraintsSrvRequest sanitized_constraints;
-  {
-    std::scoped_lock lock(mutex_constraints_);
-
-    sanitized_constraints_ = current_constraints_;
-    sanitized_constraints  = sanitized_constraints_;
+  // the limits of the previous controller do not apply anymore
+  if (updateSanitizedConstraints(true)) {
+    setConstraints();
   }
 
-  setConstraints(sanitized_constraints);
+  publishDiagnostics(true);
 
   return std::tuple(true, ss.str());
 }
@@ -8499,13 +10573,12 @@ std::tuple<bool, std::string> ControlManager::switchController(const std::string
 
 /* updateTrackers() //{ */
 
-void ControlManager::updateTrackers(void) {
+void ControlManager::updateTrackers(const mrs_msgs::UavState& uav_state) {
 
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("updateTrackers");
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("ControlManager::updateTrackers", scope_timer_logger_, scope_timer_enabled_);
 
   // copy member variables
-  auto uav_state          = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
   auto last_attitude_cmd  = mrs_lib::get_mutexed(mutex_last_attitude_cmd_, last_attitude_cmd_);
   auto active_tracker_idx = mrs_lib::get_mutexed(mutex_tracker_list_, active_tracker_idx_);
 
@@ -8738,6 +10811,44 @@ void ControlManager::updateControllers(mrs_msgs::UavState uav_state_for_control)
       }
     }
   }
+
+  // the measured state, not the (predicted) control input
+  feedLandingDetector(mrs_lib::get_mutexed(mutex_uav_state_, uav_state_));
+}
+
+//}
+
+/* feedLandingDetector() //{ */
+
+void ControlManager::feedLandingDetector(const mrs_msgs::UavState& uav_state) {
+
+  auto last_attitude_cmd = mrs_lib::get_mutexed(mutex_last_attitude_cmd_, last_attitude_cmd_);
+
+  if (last_attitude_cmd == mrs_msgs::AttitudeCommand::Ptr()) {
+    return;
+  }
+
+  std::scoped_lock lock(mutex_landing_detector_);
+
+  if (!landing_detector_.active()) {
+    return;
+  }
+
+  const double mass_estimate = mrs_lib::quadratic_thrust_model::thrustToForce(common_handlers_->motor_params, last_attitude_cmd->thrust) / common_handlers_->g;
+
+  // the header stamps, the same time base as the odometry, an unstamped command gets the stamp of the state it was computed from
+  const double stamp = last_attitude_cmd->header.stamp.isZero() ? uav_state.header.stamp.toSec() : last_attitude_cmd->header.stamp.toSec();
+
+  // the odometry is not trusted during failsafe, the zero-thrust shortcut was never used there either
+  if (failsafe_triggered_) {
+
+    landing_detector_.addThrust(stamp, mass_estimate, false);
+
+  } else {
+
+    landing_detector_.addThrust(stamp, mass_estimate, last_attitude_cmd->thrust < 0.01);
+    landing_detector_.addOdometry(uav_state.header.stamp.toSec(), uav_state.pose.position.z, uav_state.velocity.linear.z);
+  }
 }
 
 //}
@@ -8763,7 +10874,8 @@ void ControlManager::publish(void) {
   if (last_position_cmd != mrs_msgs::PositionCommand::Ptr()) {
 
     // publish the odom topic (position command for debugging, e.g. rviz)
-    nav_msgs::Odometry cmd_odom;
+    nav_msgs::Odometry::Ptr cmd_odom_ptr = pool_cmd_odom_.acquire();
+    nav_msgs::Odometry&     cmd_odom     = *cmd_odom_ptr;
 
     cmd_odom.header = last_position_cmd->header;
 
@@ -8835,13 +10947,13 @@ void ControlManager::publish(void) {
       cmd_odom.pose.pose.orientation = mrs_lib::AttitudeConverter(0, 0, last_position_cmd->heading);
     }
 
-    ph_cmd_odom_.publish(cmd_odom);
+    ph_cmd_odom_.publish(cmd_odom_ptr);
 
     ph_position_cmd_.publish(last_position_cmd);
 
     // publish the twist topic (velocity command in body frame for external controllers)
-    geometry_msgs::Twist cmd_twist;
-    cmd_twist = cmd_odom.twist.twist;
+    geometry_msgs::Twist::Ptr cmd_twist = pool_cmd_twist_.acquire();
+    *cmd_twist                          = cmd_odom.twist.twist;
 
     ph_cmd_twist_.publish(cmd_twist);
   }
@@ -8850,7 +10962,9 @@ void ControlManager::publish(void) {
   // |                 Publish the control command                |
   // --------------------------------------------------------------
 
-  mavros_msgs::AttitudeTarget attitude_target;
+  mavros_msgs::AttitudeTarget::Ptr attitude_target_ptr = pool_control_output_.acquire();
+  mavros_msgs::AttitudeTarget&     attitude_target     = *attitude_target_ptr;
+
   attitude_target.header.stamp    = ros::Time::now();
   attitude_target.header.frame_id = "base_link";
 
@@ -8937,7 +11051,7 @@ void ControlManager::publish(void) {
       return;
     }
 
-    ph_control_output_.publish(attitude_target);
+    ph_control_output_.publish(attitude_target_ptr);
   }
 
   // | --------- publish the attitude_cmd for debugging --------- |
@@ -8950,10 +11064,10 @@ void ControlManager::publish(void) {
 
   if (last_attitude_cmd != mrs_msgs::AttitudeCommand::Ptr()) {
 
-    mrs_msgs::Float64Stamped thrust_force;
-    thrust_force.header.stamp = ros::Time::now();
+    mrs_msgs::Float64Stamped::Ptr thrust_force = pool_thrust_force_.acquire();
+    thrust_force->header.stamp                 = ros::Time::now();
 
-    thrust_force.value = mrs_lib::quadratic_thrust_model::thrustToForce(common_handlers_->motor_params, last_attitude_cmd->thrust);
+    thrust_force->value = mrs_lib::quadratic_thrust_model::thrustToForce(common_handlers_->motor_params, last_attitude_cmd->thrust);
 
     ph_thrust_force_.publish(thrust_force);
   }
@@ -8988,128 +11102,27 @@ std::string ControlManager::resolveFrameName(const std::string in) {
 
 bool ControlManager::validatePositionCommand(const mrs_msgs::PositionCommand::ConstPtr position_command) {
 
-  // check positions
-
-  if (!std::isfinite(position_command->position.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->position.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->position.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->position.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->position.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->position.z'!!!");
-    return false;
-  }
-
-  // check velocities
-
-  if (!std::isfinite(position_command->velocity.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->velocity.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->velocity.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->velocity.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->velocity.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->velocity.z'!!!");
-    return false;
-  }
-
-  // check accelerations
-
-  if (!std::isfinite(position_command->acceleration.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->acceleration.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->acceleration.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->acceleration.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->acceleration.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->acceleration.z'!!!");
-    return false;
-  }
-
-  // check jerk
-
-  if (!std::isfinite(position_command->jerk.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->jerk.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->jerk.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->jerk.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->jerk.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->jerk.z'!!!");
-    return false;
-  }
-
-  // check snap
-
-  if (!std::isfinite(position_command->snap.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->snap.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->snap.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->snap.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->snap.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->snap.z'!!!");
-    return false;
-  }
-
-  // check attitude rate
-
-  if (!std::isfinite(position_command->attitude_rate.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->attitude_rate.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->attitude_rate.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->attitude_rate.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->attitude_rate.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->attitude_rate.z'!!!");
-    return false;
-  }
-
-  // check heading
-
-  if (!std::isfinite(position_command->heading)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->heading'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(position_command->heading_rate)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->heading_rate'!!!");
-    return false;
-  }
-
-  // check thrust
-
-  if (!std::isfinite(position_command->thrust)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'position_command->thrust'!!!");
-    return false;
-  }
-
-  return true;
+  static const std::array<const char*, 21> names = {
+      "position_command->position.x",      "position_command->position.y",      "position_command->position.z",
+      "position_command->velocity.x",      "position_command->velocity.y",      "position_command->velocity.z",
+      "position_command->acceleration.x",  "position_command->acceleration.y",  "position_command->acceleration.z",
+      "position_command->jerk.x",          "position_command->jerk.y",          "position_command->jerk.z",
+      "position_command->snap.x",          "position_command->snap.y",          "position_command->snap.z",
+      "position_command->attitude_rate.x", "position_command->attitude_rate.y", "position_command->attitude_rate.z",
+      "position_command->heading",         "position_command->heading_rate",    "position_command->thrust",
+  };
+
+  const std::array<double, 21> values = {
+      position_command->position.x,      position_command->position.y,      position_command->position.z,
+      position_command->velocity.x,      position_command->velocity.y,      position_command->velocity.z,
+      position_command->acceleration.x,  position_command->acceleration.y,  position_command->acceleration.z,
+      position_command->jerk.x,          position_command->jerk.y,          position_command->jerk.z,
+      position_command->snap.x,          position_command->snap.y,          position_command->snap.z,
+      position_command->attitude_rate.x, position_command->attitude_rate.y, position_command->attitude_rate.z,
+      position_command->heading,         position_command->heading_rate,    position_command->thrust,
+  };
+
+  return validateFinite(values, names);
 }
 
 //}
@@ -9118,90 +11131,43 @@ bool ControlManager::validatePositionCommand(const mrs_msgs::PositionCommand::Co
 
 bool ControlManager::validateAttitudeCommand(const mrs_msgs::AttitudeCommand::ConstPtr attitude_command) {
 
-  // check euler attitude
-
-  if (!std::isfinite(attitude_command->attitude.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->attitude.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->attitude.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->attitude.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->attitude.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->attitude.z'!!!");
-    return false;
-  }
-
-  // check attitude rate
-
-  if (!std::isfinite(attitude_command->attitude_rate.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->attitude_rate.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->attitude_rate.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->attitude_rate.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->attitude_rate.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->attitude_rate.z'!!!");
-    return false;
-  }
-
-  // check desired_acceleration
-
-  if (!std::isfinite(attitude_command->desired_acceleration.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->desired_acceleration.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->desired_acceleration.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->desired_acceleration.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->desired_acceleration.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->desired_acceleration.z'!!!");
-    return false;
-  }
-
-  // check the constraints
-
-  if (!std::isfinite(attitude_command->horizontal_speed_constraint)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->horizontal_speed_constraint'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->horizontal_acc_constraint)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->horizontal_acc_constraint'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->vertical_asc_speed_constraint)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->vertical_asc_speed_constraint'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->vertical_asc_acc_constraint)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->vertical_asc_acc_constraint'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->vertical_desc_speed_constraint)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->vertical_desc_speed_constraint'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_command->vertical_desc_acc_constraint)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_command->vertical_desc_acc_constraint'!!!");
-    return false;
-  }
-
-  return true;
+  static const std::array<const char*, 15> names = {
+      "attitude_command->attitude.x",
+      "attitude_command->attitude.y",
+      "attitude_command->attitude.z",
+      "attitude_command->attitude_rate.x",
+      "attitude_command->attitude_rate.y",
+      "attitude_command->attitude_rate.z",
+      "attitude_command->desired_acceleration.x",
+      "attitude_command->desired_acceleration.y",
+      "attitude_command->desired_acceleration.z",
+      "attitude_command->horizontal_speed_constraint",
+      "attitude_command->horizontal_acc_constraint",
+      "attitude_command->vertical_asc_speed_constraint",
+      "attitude_command->vertical_asc_acc_constraint",
+      "attitude_command->vertical_desc_speed_constraint",
+      "attitude_command->vertical_desc_acc_constraint",
+  };
+
+  const std::array<double, 15> values = {
+      attitude_command->attitude.x,
+      attitude_command->attitude.y,
+      attitude_command->attitude.z,
+      attitude_command->attitude_rate.x,
+      attitude_command->attitude_rate.y,
+      attitude_command->attitude_rate.z,
+      attitude_command->desired_acceleration.x,
+      attitude_command->desired_acceleration.y,
+      attitude_command->desired_acceleration.z,
+      attitude_command->horizontal_speed_constraint,
+      attitude_command->horizontal_acc_constraint,
+      attitude_command->vertical_asc_speed_constraint,
+      attitude_command->vertical_asc_acc_constraint,
+      attitude_command->vertical_desc_speed_constraint,
+      attitude_command->vertical_desc_acc_constraint,
+  };
+
+  return validateFinite(values, names);
 }
 
 //}
@@ -9210,63 +11176,19 @@ bool ControlManager::validateAttitudeCommand(const mrs_msgs::AttitudeCommand::Co
 
 bool ControlManager::validateOdometry(const nav_msgs::Odometry& odometry) {
 
-  // check position
-
-  if (!std::isfinite(odometry.pose.pose.position.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'odometry.pose.pose.position.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(odometry.pose.pose.position.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'odometry.pose.pose.position.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(odometry.pose.pose.position.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'odometry.pose.pose.position.z'!!!");
-    return false;
-  }
-
-  // check orientation
-
-  if (!std::isfinite(odometry.pose.pose.orientation.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'odometry.pose.pose.orientation.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(odometry.pose.pose.orientation.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'odometry.pose.pose.orientation.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(odometry.pose.pose.orientation.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'odometry.pose.pose.orientation.z'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(odometry.pose.pose.orientation.w)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'odometry.pose.pose.orientation.w'!!!");
-    return false;
-  }
-
-  // check velocity
-
-  if (!std::isfinite(odometry.twist.twist.linear.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'odometry.twist.twist.linear.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(odometry.twist.twist.linear.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'odometry.twist.twist.linear.y'!!!");
-    return false;
-  }
+  static const std::array<const char*, 10> names = {
+      "odometry.pose.pose.position.x",    "odometry.pose.pose.position.y",    "odometry.pose.pose.position.z",    "odometry.pose.pose.orientation.x",
+      "odometry.pose.pose.orientation.y", "odometry.pose.pose.orientation.z", "odometry.pose.pose.orientation.w", "odometry.twist.twist.linear.x",
+      "odometry.twist.twist.linear.y",    "odometry.twist.twist.linear.z",
+  };
 
-  if (!std::isfinite(odometry.twist.twist.linear.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'odometry.twist.twist.linear.z'!!!");
-    return false;
-  }
+  const std::array<double, 10> values = {
+      odometry.pose.pose.position.x,    odometry.pose.pose.position.y,    odometry.pose.pose.position.z,    odometry.pose.pose.orientation.x,
+      odometry.pose.pose.orientation.y, odometry.pose.pose.orientation.z, odometry.pose.pose.orientation.w, odometry.twist.twist.linear.x,
+      odometry.twist.twist.linear.y,    odometry.twist.twist.linear.z,
+  };
 
-  return true;
+  return validateFinite(values, names);
 }
 
 //}
@@ -9275,39 +11197,15 @@ bool ControlManager::validateOdometry(const nav_msgs::Odometry& odometry) {
 
 bool ControlManager::validateVelocityReference(const mrs_msgs::VelocityReference& reference) {
 
-  // check velocity
-
-  if (!std::isfinite(reference.velocity.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'reference.velocity.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(reference.velocity.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'reference.velocity.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(reference.velocity.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'reference.velocity.z'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(reference.altitude)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'reference.altitude'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(reference.heading)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'reference.heading'!!!");
-    return false;
-  }
+  static const std::array<const char*, 6> names = {
+      "reference.velocity.x", "reference.velocity.y", "reference.velocity.z", "reference.altitude", "reference.heading", "reference.heading_rate",
+  };
 
-  if (!std::isfinite(reference.heading_rate)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'reference.heading_rate'!!!");
-    return false;
-  }
+  const std::array<double, 6> values = {
+      reference.velocity.x, reference.velocity.y, reference.velocity.z, reference.altitude, reference.heading, reference.heading_rate,
+  };
 
-  return true;
+  return validateFinite(values, names);
 }
 
 //}
@@ -9316,148 +11214,63 @@ bool ControlManager::validateVelocityReference(const mrs_msgs::VelocityReference
 
 bool ControlManager::validateUavState(const mrs_msgs::UavState& uav_state) {
 
-  // check position
-
-  if (!std::isfinite(uav_state.pose.position.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.pose.position.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.pose.position.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.pose.position.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.pose.position.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.pose.position.z'!!!");
-    return false;
-  }
-
-  // check orientation
-
-  if (!std::isfinite(uav_state.pose.orientation.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.pose.orientation.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.pose.orientation.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.pose.orientation.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.pose.orientation.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.pose.orientation.z'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.pose.orientation.w)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.pose.orientation.w'!!!");
-    return false;
-  }
-
-  // check linear velocity
-
-  if (!std::isfinite(uav_state.velocity.linear.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.velocity.linear.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.velocity.linear.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.velocity.linear.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.velocity.linear.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.velocity.linear.z'!!!");
-    return false;
-  }
-
-  // check angular velocity
-
-  if (!std::isfinite(uav_state.velocity.angular.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.velocity.angular.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.velocity.angular.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.velocity.angular.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.velocity.angular.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.velocity.angular.z'!!!");
-    return false;
-  }
-
-  // check linear acceleration
-
-  if (!std::isfinite(uav_state.acceleration.linear.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration.linear.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.acceleration.linear.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration.linear.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.acceleration.linear.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration.linear.z'!!!");
-    return false;
-  }
-
-  // check angular acceleration
-
-  if (!std::isfinite(uav_state.acceleration.angular.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration.angular.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.acceleration.angular.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration.angular.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.acceleration.angular.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration.angular.z'!!!");
-    return false;
-  }
-
-  // check acceleration angular disturbance
-
-  if (!std::isfinite(uav_state.acceleration_disturbance.angular.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration_disturbance.angular.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.acceleration_disturbance.angular.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration_disturbance.angular.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.acceleration_disturbance.angular.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration_disturbance.angular.z'!!!");
-    return false;
-  }
-
-  // check acceleration linear disturbance
-
-  if (!std::isfinite(uav_state.acceleration_disturbance.linear.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration_disturbance.linear.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.acceleration_disturbance.linear.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration_disturbance.linear.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(uav_state.acceleration_disturbance.linear.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'uav_state.acceleration_disturbance.linear.z'!!!");
-    return false;
-  }
-
-  return true;
+  static const std::array<const char*, 25> names = {
+      "uav_state.pose.position.x",
+      "uav_state.pose.position.y",
+      "uav_state.pose.position.z",
+      "uav_state.pose.orientation.x",
+      "uav_state.pose.orientation.y",
+      "uav_state.pose.orientation.z",
+      "uav_state.pose.orientation.w",
+      "uav_state.velocity.linear.x",
+      "uav_state.velocity.linear.y",
+      "uav_state.velocity.linear.z",
+      "uav_state.velocity.angular.x",
+      "uav_state.velocity.angular.y",
+      "uav_state.velocity.angular.z",
+      "uav_state.acceleration.linear.x",
+      "uav_state.acceleration.linear.y",
+      "uav_state.acceleration.linear.z",
+      "uav_state.acceleration.angular.x",
+      "uav_state.acceleration.angular.y",
+      "uav_state.acceleration.angular.z",
+      "uav_state.acceleration_disturbance.angular.x",
+      "uav_state.acceleration_disturbance.angular.y",
+      "uav_state.acceleration_disturbance.angular.z",
+      "uav_state.acceleration_disturbance.linear.x",
+      "uav_state.acceleration_disturbance.linear.y",
+      "uav_state.acceleration_disturbance.linear.z",
+  };
+
+  const std::array<double, 25> values = {
+      uav_state.pose.position.x,
+      uav_state.pose.position.y,
+      uav_state.pose.position.z,
+      uav_state.pose.orientation.x,
+      uav_state.pose.orientation.y,
+      uav_state.pose.orientation.z,
+      uav_state.pose.orientation.w,
+      uav_state.velocity.linear.x,
+      uav_state.velocity.linear.y,
+      uav_state.velocity.linear.z,
+      uav_state.velocity.angular.x,
+      uav_state.velocity.angular.y,
+      uav_state.velocity.angular.z,
+      uav_state.acceleration.linear.x,
+      uav_state.acceleration.linear.y,
+      uav_state.acceleration.linear.z,
+      uav_state.acceleration.angular.x,
+      uav_state.acceleration.angular.y,
+      uav_state.acceleration.angular.z,
+      uav_state.acceleration_disturbance.angular.x,
+      uav_state.acceleration_disturbance.angular.y,
+      uav_state.acceleration_disturbance.angular.z,
+      uav_state.acceleration_disturbance.linear.x,
+      uav_state.acceleration_disturbance.linear.y,
+      uav_state.acceleration_disturbance.linear.z,
+  };
+
+  return validateFinite(values, names);
 }
 
 //}
@@ -9466,53 +11279,17 @@ bool ControlManager::validateUavState(const mrs_msgs::UavState& uav_state) {
 
 bool ControlManager::validateMavrosAttitudeTarget(const mavros_msgs::AttitudeTarget& attitude_target) {
 
-  // check the orientation
-
-  if (!std::isfinite(attitude_target.orientation.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_target.orientation.x'!!!");
-    return false;
-  }
+  static const std::array<const char*, 8> names = {
+      "attitude_target.orientation.x", "attitude_target.orientation.y", "attitude_target.orientation.z", "attitude_target.orientation.w",
+      "attitude_target.body_rate.x",   "attitude_target.body_rate.y",   "attitude_target.body_rate.z",   "attitude_target.thrust",
+  };
 
-  if (!std::isfinite(attitude_target.orientation.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_target.orientation.y'!!!");
-    return false;
-  }
+  const std::array<double, 8> values = {
+      attitude_target.orientation.x, attitude_target.orientation.y, attitude_target.orientation.z, attitude_target.orientation.w,
+      attitude_target.body_rate.x,   attitude_target.body_rate.y,   attitude_target.body_rate.z,   attitude_target.thrust,
+  };
 
-  if (!std::isfinite(attitude_target.orientation.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_target.orientation.z'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_target.orientation.w)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_target.orientation.w'!!!");
-    return false;
-  }
-
-  // check the body rate
-
-  if (!std::isfinite(attitude_target.body_rate.x)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_target.body_rate.x'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_target.body_rate.y)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_target.body_rate.y'!!!");
-    return false;
-  }
-
-  if (!std::isfinite(attitude_target.body_rate.z)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_target.body_rate.z'!!!");
-    return false;
-  }
-
-  // check the thrust
-
-  if (!std::isfinite(attitude_target.thrust)) {
-    ROS_ERROR_THROTTLE(1.0, "[ControlManager]: NaN detected in variable 'attitude_target.thrust'!!!");
-    return false;
-  }
-
-  return true;
+  return validateFinite(values, names);
 }
 
 //}
@@ -9646,6 +11423,37 @@ mrs_msgs::ReferenceStamped ControlManager::velocityReferenceToReference(const mr
 
 //}
 
+/* addDiagnosticValue() //{ */
+
+void ControlManager::addDiagnosticValue(diagnostic_msgs::DiagnosticStatus& status, const std::string& key, const std::string& value) {
+
+  diagnostic_msgs::KeyValue key_value;
+
+  key_value.key   = key;
+  key_value.value = value;
+
+  status.values.push_back(key_value);
+}
+
+//}
+
+/* transformToIsometry() //{ */
+
+Eigen::Isometry3d ControlManager::transformToIsometry(const geometry_msgs::TransformStamped& tf) {
+
+  const geometry_msgs::Vector3&    t = tf.transform.translation;
+  const geometry_msgs::Quaternion& q = tf.transform.rotation;
+
+  Eigen::Isometry3d isometry = Eigen::Isometry3d::Identity();
+
+  isometry.translate(Eigen::Vector3d(t.x, t.y, t.z));
+  isometry.rotate(Eigen::Quaterniond(q.w, q.x, q.y, q.z));
+
+  return isometry;
+}
+
+//}
+
 }  // namespace control_manager
 
 }  // namespace mrs_uav_managers
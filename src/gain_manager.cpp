@@ -12,6 +12,7 @@
 #include <mrs_msgs/EstimatorType.h>
 #include <mrs_msgs/ControlManagerDiagnostics.h>
 #include <mrs_msgs/GainManagerDiagnostics.h>
+#include <mrs_msgs/UavState.h>
 
 #include <mrs_lib/profiler.h>
 #include <mrs_lib/scope_timer.h>
@@ -21,10 +22,14 @@
 #include <mrs_lib/service_client_handler.h>
 #include <mrs_lib/subscribe_handler.h>
 
+#include <mrs_uav_managers/state_board.h>
+
 #include <dynamic_reconfigure/ReconfigureRequest.h>
 #include <dynamic_reconfigure/Reconfigure.h>
 #include <dynamic_reconfigure/Config.h>
 
+#include <optional>
+
 //}
 
 namespace mrs_uav_managers
@@ -35,17 +40,23 @@ namespace gain_manager
 
 /* //{ class GainManager */
 
+using Gains_t = state_board::ControllerGains;
+
+// blends the gain set towards another one based on the UAV state
 typedef struct
 {
 
-  double kpxy, kiwxy, kibxy, kvxy, kaxy, kqxy;
-  double kpz, kvz, kaz, kqz;
-  double kiwxy_lim, kibxy_lim;
-  double km, km_lim;
+  enum Variable
+  {
+    SPEED,
+    HEIGHT
+  } variable;
 
-  std::string name;
+  std::string gains;       // the other gain set, fully blended in at and beyond to_value
+  double      from_value;  // [m/s] or [m]
+  double      to_value;    // [m/s] or [m]
 
-} Gains_t;
+} GainSchedule_t;
 
 class GainManager : public nodelet::Nodelet {
 
@@ -75,11 +86,49 @@ private:
 
   mrs_lib::SubscribeHandler<mrs_msgs::OdometryDiag>              sh_odom_diag_;
   mrs_lib::SubscribeHandler<mrs_msgs::ControlManagerDiagnostics> sh_control_manager_diag_;
+  mrs_lib::SubscribeHandler<mrs_msgs::UavState>                  sh_uav_state_;
 
   // | --------------------- gain management -------------------- |
 
   bool setGains(std::string gains_name);
 
+  // the gains the controller has now, only the changed ones are sent to it
+  // * the next update is sent whole (send_all_) when the controller is (re)activated and periodically,
+  //   since the controller can lose the gains by a restart or get others through dynamic_reconfigure
+  std::optional<Gains_t> controller_gains_;
+  std::mutex             mutex_set_gains_;
+
+  double _full_resend_period_;
+  bool   send_all_               = true;
+  double last_full_send_time_    = 0;
+  int    last_active_controller_ = state_board::NameRegistry::INVALID_ID;
+  bool   last_controller_active_ = false;
+
+  bool setGainsInProcess(const Gains_t& gains);
+  bool setGainsReconfigure(const Gains_t& gains, const uint32_t changed);
+
+  // | --------------------- gain scheduling -------------------- |
+
+  // the gains sent to the controller move from the previous ones to the target set over the transition time,
+  // the target set can be blended with another set based on the UAV state,
+  // the updates are sent at most at the max rate (mutex_set_gains_ protects the state)
+  // * only through the in-process gain channel, dynamic_reconfigure gets one discrete (diff-based) call per switch,
+  //   so the controller is not flooded with reconfigure calls
+  double _transition_time_;
+  double _scheduling_max_rate_;
+  double _scheduling_deadband_;
+
+  std::map<std::string, GainSchedule_t> _schedules_;
+
+  std::string target_gains_;
+  Gains_t     transition_from_;
+  double      transition_start_ = 0;
+  double      last_push_time_   = 0;
+
+  bool    pushGains(const bool force);
+  Gains_t scheduledGains(const std::string& gains_name);
+  bool    getScheduleVariable(const GainSchedule_t::Variable variable, double& value);
+
   ros::ServiceServer service_server_set_gains_;
   bool               callbackSetGains(mrs_msgs::String::Request& req, mrs_msgs::String::Response& res);
 
@@ -111,6 +160,25 @@ private:
   bool                                       scope_timer_enabled_ = false;
   std::shared_ptr<mrs_lib::ScopeTimerLogger> scope_timer_logger_;
 
+  // | ----------------------- state board ---------------------- |
+
+  bool                     _state_board_enabled_ = false;
+  double                   _state_board_timeout_;
+  state_board::StateBoard* state_board_ = nullptr;
+
+  // with state_board/gains_channel, the gains are stored on the board for a controller attached as a gains consumer,
+  // no controller attaches yet (the consumer side belongs to the controllers), so it is off by default
+  bool _gains_channel_enabled_ = false;
+
+  bool gainsChannelActive(void);
+
+  bool getEstimator(int& estimator_id, mrs_msgs::EstimatorType::_type_type& estimator_type);
+  bool getActiveController(int& active_controller, bool& controller_active);
+
+  // the names from the diagnostics topics, interned only when they change
+  state_board::InternCache odometry_estimator_;
+  state_board::InternCache diagnostics_active_controller_;
+
   // | ------------------------- helpers ------------------------ |
 
   bool stringInVector(const std::string& value, const std::vector<std::string>& vector);
@@ -149,6 +217,20 @@ void GainManager::onInit() {
   param_loader.loadParam("rate", _gain_management_rate_);
   param_loader.loadParam("diagnostics_rate", _diagnostics_rate_);
 
+  param_loader.loadParam("gain_scheduling/transition_time", _transition_time_);
+  param_loader.loadParam("gain_scheduling/max_rate", _scheduling_max_rate_);
+  param_loader.loadParam("gain_scheduling/deadband", _scheduling_deadband_);
+  param_loader.loadParam("gain_scheduling/full_resend_period", _full_resend_period_);
+
+  if (_scheduling_max_rate_ <= 0) {
+    ROS_ERROR("[GainManager]: gain_scheduling/max_rate has to be > 0");
+    ros::shutdown();
+  }
+
+  param_loader.loadParam("state_board/enabled", _state_board_enabled_);
+  param_loader.loadParam("state_board/timeout", _state_board_timeout_);
+  param_loader.loadParam("state_board/gains_channel", _gains_channel_enabled_);
+
   // | ------------------- scope timer logger ------------------- |
 
   param_loader.loadParam("scope_timer/enabled", scope_timer_enabled_);
@@ -164,24 +246,62 @@ void GainManager::onInit() {
 
     Gains_t new_gains;
 
-    param_loader.loadParam(*it + "/horizontal/kp", new_gains.kpxy);
-    param_loader.loadParam(*it + "/horizontal/kv", new_gains.kvxy);
-    param_loader.loadParam(*it + "/horizontal/ka", new_gains.kaxy);
-    param_loader.loadParam(*it + "/horizontal/attitude/kq", new_gains.kqxy);
-    param_loader.loadParam(*it + "/horizontal/kib", new_gains.kibxy);
-    param_loader.loadParam(*it + "/horizontal/kiw", new_gains.kiwxy);
-    param_loader.loadParam(*it + "/horizontal/kib_lim", new_gains.kibxy_lim);
-    param_loader.loadParam(*it + "/horizontal/kiw_lim", new_gains.kiwxy_lim);
+    param_loader.loadParam(*it + "/horizontal/kp", new_gains.values[Gains_t::KPXY]);
+    param_loader.loadParam(*it + "/horizontal/kv", new_gains.values[Gains_t::KVXY]);
+    param_loader.loadParam(*it + "/horizontal/ka", new_gains.values[Gains_t::KAXY]);
+    param_loader.loadParam(*it + "/horizontal/attitude/kq", new_gains.values[Gains_t::KQXY]);
+    param_loader.loadParam(*it + "/horizontal/kib", new_gains.values[Gains_t::KIBXY]);
+    param_loader.loadParam(*it + "/horizontal/kiw", new_gains.values[Gains_t::KIWXY]);
+    param_loader.loadParam(*it + "/horizontal/kib_lim", new_gains.values[Gains_t::KIBXY_LIM]);
+    param_loader.loadParam(*it + "/horizontal/kiw_lim", new_gains.values[Gains_t::KIWXY_LIM]);
 
-    param_loader.loadParam(*it + "/vertical/kp", new_gains.kpz);
-    param_loader.loadParam(*it + "/vertical/kv", new_gains.kvz);
-    param_loader.loadParam(*it + "/vertical/ka", new_gains.kaz);
-    param_loader.loadParam(*it + "/vertical/attitude/kq", new_gains.kqz);
+    param_loader.loadParam(*it + "/vertical/kp", new_gains.values[Gains_t::KPZ]);
+    param_loader.loadParam(*it + "/vertical/kv", new_gains.values[Gains_t::KVZ]);
+    param_loader.loadParam(*it + "/vertical/ka", new_gains.values[Gains_t::KAZ]);
+    param_loader.loadParam(*it + "/vertical/attitude/kq", new_gains.values[Gains_t::KQZ]);
 
-    param_loader.loadParam(*it + "/mass_estimator/km", new_gains.km);
-    param_loader.loadParam(*it + "/mass_estimator/km_lim", new_gains.km_lim);
+    param_loader.loadParam(*it + "/mass_estimator/km", new_gains.values[Gains_t::KM]);
+    param_loader.loadParam(*it + "/mass_estimator/km_lim", new_gains.values[Gains_t::KM_LIM]);
 
     _gains_.insert(std::pair<std::string, Gains_t>(*it, new_gains));
+
+    bool schedule_enabled;
+    param_loader.loadParam(*it + "/schedule/enabled", schedule_enabled, false);
+
+    if (schedule_enabled) {
+
+      GainSchedule_t schedule;
+      std::string    variable;
+
+      param_loader.loadParam(*it + "/schedule/variable", variable);
+      param_loader.loadParam(*it + "/schedule/gains", schedule.gains);
+      param_loader.loadParam(*it + "/schedule/from", schedule.from_value);
+      param_loader.loadParam(*it + "/schedule/to", schedule.to_value);
+
+      if (variable == "speed") {
+        schedule.variable = GainSchedule_t::SPEED;
+      } else if (variable == "height") {
+        schedule.variable = GainSchedule_t::HEIGHT;
+      } else {
+        ROS_ERROR("[GainManager]: the schedule variable of '%s' has to be 'speed' or 'height'", it->c_str());
+        ros::shutdown();
+      }
+
+      if (schedule.to_value <= schedule.from_value) {
+        ROS_ERROR("[GainManager]: the schedule of '%s' has to have from < to", it->c_str());
+        ros::shutdown();
+      }
+
+      _schedules_.insert(std::pair<std::string, GainSchedule_t>(*it, schedule));
+    }
+  }
+
+  // the scheduled gains have to be loaded as well
+  for (auto& schedule : _schedules_) {
+    if (!stringInVector(schedule.second.gains, _gain_names_)) {
+      ROS_ERROR("[GainManager]: the gains '%s' scheduled from '%s' are not a valid gain!", schedule.second.gains.c_str(), schedule.first.c_str());
+      ros::shutdown();
+    }
   }
 
   // loading the allowed gains lists
@@ -215,6 +335,10 @@ void GainManager::onInit() {
     _map_type_fallback_gains_.insert(std::pair<std::string, std::string>(*it, temp_str));
   }
 
+  if ((_transition_time_ > 0 || !_schedules_.empty()) && !(_state_board_enabled_ && _gains_channel_enabled_)) {
+    ROS_INFO("[GainManager]: the gain transitions and schedules need state_board/gains_channel, the gains will be switched at once");
+  }
+
   ROS_INFO("[GainManager]: done loading dynamical params");
 
   current_gains_       = "";
@@ -240,6 +364,15 @@ void GainManager::onInit() {
   sh_odom_diag_            = mrs_lib::SubscribeHandler<mrs_msgs::OdometryDiag>(shopts, "odometry_diagnostics_in");
   sh_control_manager_diag_ = mrs_lib::SubscribeHandler<mrs_msgs::ControlManagerDiagnostics>(shopts, "control_manager_diagnostics_in");
 
+  // the state is needed only for the state-based schedules, when it is not on the state board
+  if (!_schedules_.empty() && _gains_channel_enabled_) {
+    sh_uav_state_ = mrs_lib::SubscribeHandler<mrs_msgs::UavState>(shopts, "uav_state_in");
+  }
+
+  // | ----------------------- state board ---------------------- |
+
+  state_board_ = &state_board::getStateBoard(ros::names::parentNamespace(nh_.getNamespace()));
+
   // | ----------------------- publishers ----------------------- |
 
   ph_diagnostics_ = mrs_lib::PublisherHandler<mrs_msgs::GainManagerDiagnostics>(nh_, "diagnostics_out", 1);
@@ -275,6 +408,7 @@ void GainManager::onInit() {
 
 /* setGains() //{ */
 
+// starts the transition to the new gains, the first step is sent right away
 bool GainManager::setGains(std::string gains_name) {
 
   std::map<std::string, Gains_t>::iterator it;
@@ -285,88 +419,174 @@ bool GainManager::setGains(std::string gains_name) {
     return false;
   }
 
-  dynamic_reconfigure::Config          conf;
-  dynamic_reconfigure::DoubleParameter param;
+  std::scoped_lock lock(mutex_set_gains_);
+
+  ROS_INFO_THROTTLE(1.0, "[GainManager]: setting up gains for '%s'", gains_name.c_str());
+
+  const std::string previous_target = target_gains_;
+
+  // there is nothing to transition from before the first gains are set
+  transition_from_  = controller_gains_ ? controller_gains_.value() : it->second;
+  transition_start_ = ros::Time::now().toSec();
+  target_gains_     = gains_name;
+
+  if (!pushGains(true)) {
 
-  param.name  = "kpxy";
-  param.value = it->second.kpxy;
-  conf.doubles.push_back(param);
+    ROS_WARN_THROTTLE(1.0, "[GainManager]: the service for setting gains has failed!");
 
-  param.name  = "kvxy";
-  param.value = it->second.kvxy;
-  conf.doubles.push_back(param);
+    target_gains_ = previous_target;
 
-  param.name  = "kaxy";
-  param.value = it->second.kaxy;
-  conf.doubles.push_back(param);
+    return false;
 
-  param.name  = "kqxy";
-  param.value = it->second.kqxy;
-  conf.doubles.push_back(param);
+  } else {
 
-  param.name  = "kibxy";
-  param.value = it->second.kibxy;
-  conf.doubles.push_back(param);
+    mrs_lib::set_mutexed(mutex_current_gains_, gains_name, current_gains_);
 
-  param.name  = "kiwxy";
-  param.value = it->second.kiwxy;
-  conf.doubles.push_back(param);
+    return true;
+  }
+}
 
-  param.name  = "kibxy_lim";
-  param.value = it->second.kibxy_lim;
-  conf.doubles.push_back(param);
+//}
 
-  param.name  = "kiwxy_lim";
-  param.value = it->second.kiwxy_lim;
-  conf.doubles.push_back(param);
+/* pushGains() //{ */
 
-  param.name  = "kpz";
-  param.value = it->second.kpz;
-  conf.doubles.push_back(param);
+// sends the current step of the transition and of the state schedule to the controller
+// * called with mutex_set_gains_ locked
+// * unless forced, the updates are limited by the max rate, changes within the deadband are sent at most once per second
+bool GainManager::pushGains(const bool force) {
 
-  param.name  = "kvz";
-  param.value = it->second.kvz;
-  conf.doubles.push_back(param);
+  if (target_gains_.empty()) {
+    return true;
+  }
 
-  param.name  = "kaz";
-  param.value = it->second.kaz;
-  conf.doubles.push_back(param);
+  const double now        = ros::Time::now().toSec();
+  const double since_last = now - last_push_time_;
 
-  param.name  = "kqz";
-  param.value = it->second.kqz;
-  conf.doubles.push_back(param);
+  if (!force && since_last < 1.0 / _scheduling_max_rate_) {
+    return true;
+  }
 
-  param.name  = "km";
-  param.value = it->second.km;
-  conf.doubles.push_back(param);
+  const bool in_process = gainsChannelActive();
 
-  param.name  = "km_lim";
-  param.value = it->second.km_lim;
-  conf.doubles.push_back(param);
+  Gains_t gains = in_process ? scheduledGains(target_gains_) : _gains_.at(target_gains_);
 
-  dynamic_reconfigure::ReconfigureRequest  srv_req;
-  dynamic_reconfigure::ReconfigureResponse srv_resp;
+  if (in_process && _transition_time_ > 0) {
+    gains = Gains_t::interpolate(transition_from_, gains, std::clamp((now - transition_start_) / _transition_time_, 0.0, 1.0));
+  }
 
-  srv_req.config = conf;
+  if (!force && controller_gains_ && !send_all_) {
 
-  dynamic_reconfigure::Reconfigure reconf;
-  reconf.request = srv_req;
+    const double change = gains.maxRelativeDiff(controller_gains_.value());
 
-  ROS_INFO_THROTTLE(1.0, "[GainManager]: setting up gains for '%s'", gains_name.c_str());
+    if (change == 0 || (change < _scheduling_deadband_ && since_last < 1.0)) {
+      return true;
+    }
+  }
 
-  bool res = service_client_set_gains_.call(reconf);
+  // the first set after start, after a failure or after the controller's activation is sent whole
+  gains.changed = (controller_gains_ && !send_all_) ? gains.diff(controller_gains_.value()) : ~uint32_t(0);
+
+  last_push_time_ = now;
+
+  bool res;
+
+  if (in_process) {
+    res = setGainsInProcess(gains);
+  } else {
+    res = setGainsReconfigure(gains, gains.changed);
+  }
 
   if (!res) {
 
-    ROS_WARN_THROTTLE(1.0, "[GainManager]: the service for setting gains has failed!");
+    controller_gains_.reset();
+
     return false;
+  }
 
-  } else {
+  if (gains.changed == ~uint32_t(0)) {
+    last_full_send_time_ = now;
+    send_all_            = false;
+  }
 
-    mrs_lib::set_mutexed(mutex_current_gains_, gains_name, current_gains_);
+  controller_gains_ = gains;
+
+  return true;
+}
+
+//}
+
+/* scheduledGains() //{ */
+
+Gains_t GainManager::scheduledGains(const std::string& gains_name) {
+
+  const Gains_t& gains = _gains_.at(gains_name);
+
+  auto it = _schedules_.find(gains_name);
+
+  if (it == _schedules_.end()) {
+    return gains;
+  }
+
+  const GainSchedule_t& schedule = it->second;
+
+  double value;
+
+  if (!getScheduleVariable(schedule.variable, value)) {
+    ROS_WARN_THROTTLE(1.0, "[GainManager]: missing the UAV state for the gain schedule of '%s'", gains_name.c_str());
+    return gains;
+  }
+
+  const double alpha = std::clamp((value - schedule.from_value) / (schedule.to_value - schedule.from_value), 0.0, 1.0);
+
+  return Gains_t::interpolate(gains, _gains_.at(schedule.gains), alpha);
+}
+
+//}
+
+/* setGainsInProcess() //{ */
+
+// the controller loads the new set in its next update()
+bool GainManager::setGainsInProcess(const Gains_t& gains) {
 
+  state_board_->controller_gains.store(gains);
+
+  return true;
+}
+
+//}
+
+/* setGainsReconfigure() //{ */
+
+bool GainManager::setGainsReconfigure(const Gains_t& gains, const uint32_t changed) {
+
+  dynamic_reconfigure::Config          conf;
+  dynamic_reconfigure::DoubleParameter param;
+
+  for (int i = 0; i < Gains_t::COUNT; i++) {
+
+    if (!(changed & (1u << i))) {
+      continue;
+    }
+
+    param.name  = Gains_t::names[i];
+    param.value = gains.values[i];
+    conf.doubles.push_back(param);
+  }
+
+  // nothing has changed, the controller already has those gains
+  if (conf.doubles.empty()) {
     return true;
   }
+
+  dynamic_reconfigure::ReconfigureRequest  srv_req;
+  dynamic_reconfigure::ReconfigureResponse srv_resp;
+
+  srv_req.config = conf;
+
+  dynamic_reconfigure::Reconfigure reconf;
+  reconf.request = srv_req;
+
+  return service_client_set_gains_.call(reconf);
 }
 
 //}
@@ -387,7 +607,10 @@ bool GainManager::callbackSetGains(mrs_msgs::String::Request& req, mrs_msgs::Str
 
   std::stringstream ss;
 
-  if (!sh_odom_diag_.hasMsg()) {
+  int                                 estimator_id;
+  mrs_msgs::EstimatorType::_type_type estimator_type;
+
+  if (!getEstimator(estimator_id, estimator_type)) {
 
     ss << "missing odometry diagnostics";
 
@@ -398,7 +621,7 @@ bool GainManager::callbackSetGains(mrs_msgs::String::Request& req, mrs_msgs::Str
     return true;
   }
 
-  auto odometry_diagnostics = *sh_odom_diag_.getMsg();
+  const std::string estimator_name = state_board_->names.name(estimator_id);
 
   if (!stringInVector(req.value, _gain_names_)) {
 
@@ -411,7 +634,7 @@ bool GainManager::callbackSetGains(mrs_msgs::String::Request& req, mrs_msgs::Str
     return true;
   }
 
-  if (!stringInVector(req.value, _map_type_allowed_gains_.at(odometry_diagnostics.estimator_type.name))) {
+  if (!stringInVector(req.value, _map_type_allowed_gains_.at(estimator_name))) {
 
     ss << "the gains '" << req.value.c_str() << "' are not allowed given the current odometry type";
 
@@ -462,52 +685,76 @@ void GainManager::timerGainManagement(const ros::TimerEvent& event) {
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("gainManagementTimer", _gain_management_rate_, 0.01, event);
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("GainManager::gainManagementTimer", scope_timer_logger_, scope_timer_enabled_);
 
-  if (!sh_odom_diag_.hasMsg()) {
+  int                                 estimator_id;
+  mrs_msgs::EstimatorType::_type_type estimator_type;
+
+  if (!getEstimator(estimator_id, estimator_type)) {
     ROS_WARN_THROTTLE(1.0, "[GainManager]: can not do constraint management, missing odometry diagnostics!");
     return;
   }
 
-  auto odometry_diagnostics = *sh_odom_diag_.getMsg();
+  int  active_controller;
+  bool controller_active;
 
-  if (!sh_control_manager_diag_.hasMsg()) {
+  if (!getActiveController(active_controller, controller_active)) {
     ROS_WARN_THROTTLE(1.0, "[GainManager]: can not do constraint management, missing control manager diagnostics!");
     return;
   }
 
-  auto control_manager_diagnostics = *sh_odom_diag_.getMsg();
+  // | -------- advance the transition and the state schedule -------- |
+
+  {
+    std::scoped_lock lock(mutex_set_gains_);
+
+    // the controller could have lost the gains, they are sent whole
+    const bool reactivated = active_controller != last_active_controller_ || (controller_active && !last_controller_active_);
+
+    last_active_controller_ = active_controller;
+    last_controller_active_ = controller_active;
+
+    if (reactivated || (_full_resend_period_ > 0 && ros::Time::now().toSec() - last_full_send_time_ > _full_resend_period_)) {
+      send_all_ = true;
+    }
+
+    if (!pushGains(false)) {
+      ROS_WARN_THROTTLE(1.0, "[GainManager]: could not update the scheduled gains!");
+    }
+  }
 
   auto current_gains       = mrs_lib::get_mutexed(mutex_current_gains_, current_gains_);
   auto last_estimator_type = mrs_lib::get_mutexed(mutex_last_estimator_type_, last_estimator_type_);
 
   // | --- automatically set _gains_ when odometry.type changes -- |
-  if (odometry_diagnostics.estimator_type.type != last_estimator_type) {
+  if (estimator_type != last_estimator_type) {
+
+    ROS_INFO_THROTTLE(1.0, "[GainManager]: the odometry type has changed! %d -> %d", last_estimator_type, estimator_type);
 
-    ROS_INFO_THROTTLE(1.0, "[GainManager]: the odometry type has changed! %d -> %d", last_estimator_type, odometry_diagnostics.estimator_type.type);
+    // the name is only needed when the estimator changes
+    const std::string estimator_name = state_board_->names.name(estimator_id);
 
     std::map<std::string, std::string>::iterator it;
-    it = _map_type_fallback_gains_.find(odometry_diagnostics.estimator_type.name);
+    it = _map_type_fallback_gains_.find(estimator_name);
 
     if (it == _map_type_fallback_gains_.end()) {
 
-      ROS_WARN_THROTTLE(1.0, "[GainManager]: the odometry type '%s' was not specified in the gain_manager's config!",
-                        odometry_diagnostics.estimator_type.name.c_str());
+      ROS_WARN_THROTTLE(1.0, "[GainManager]: the odometry type '%s' was not specified in the gain_manager's config!", estimator_name.c_str());
 
     } else {
 
       // if the current gains are within the allowed odometry types, do nothing
-      if (stringInVector(current_gains, _map_type_allowed_gains_.at(odometry_diagnostics.estimator_type.name))) {
+      if (stringInVector(current_gains, _map_type_allowed_gains_.at(estimator_name))) {
 
-        last_estimator_type = odometry_diagnostics.estimator_type.type;
+        last_estimator_type = estimator_type;
 
         // else, try to set the fallback gains
       } else {
 
         ROS_WARN_THROTTLE(1.0, "[GainManager]: the current gains '%s' are not within the allowed gains for '%s'", current_gains.c_str(),
-                          odometry_diagnostics.estimator_type.name.c_str());
+                          estimator_name.c_str());
 
         if (setGains(it->second)) {
 
-          last_estimator_type = odometry_diagnostics.estimator_type.type;
+          last_estimator_type = estimator_type;
 
           ROS_INFO_THROTTLE(1.0, "[GainManager]: gains set to fallback: '%s'", it->second.c_str());
 
@@ -535,12 +782,15 @@ void GainManager::timerDiagnostics(const ros::TimerEvent& event) {
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerDiagnostics", _diagnostics_rate_, 0.01, event);
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("GainManager::timerDiagnostics", scope_timer_logger_, scope_timer_enabled_);
 
-  if (!sh_odom_diag_.hasMsg()) {
+  int                                 estimator_id;
+  mrs_msgs::EstimatorType::_type_type estimator_type;
+
+  if (!getEstimator(estimator_id, estimator_type)) {
     ROS_WARN_THROTTLE(1.0, "[GainManager]: can not do constraint management, missing odometry diagnostics!");
     return;
   }
 
-  auto odometry_diagnostics = *sh_odom_diag_.getMsg();
+  const std::string estimator_name = state_board_->names.name(estimator_id);
 
   auto current_gains = mrs_lib::get_mutexed(mutex_current_gains_, current_gains_);
 
@@ -553,43 +803,44 @@ void GainManager::timerDiagnostics(const ros::TimerEvent& event) {
   // get the available gains
   {
     std::map<std::string, std::vector<std::string>>::iterator it;
-    it = _map_type_allowed_gains_.find(odometry_diagnostics.estimator_type.name);
+    it = _map_type_allowed_gains_.find(estimator_name);
 
     if (it == _map_type_allowed_gains_.end()) {
-      ROS_WARN_THROTTLE(1.0, "[GainManager]: the odometry.type '%s' was not specified in the gain_manager's config!",
-                        odometry_diagnostics.estimator_type.name.c_str());
+      ROS_WARN_THROTTLE(1.0, "[GainManager]: the odometry.type '%s' was not specified in the gain_manager's config!", estimator_name.c_str());
     } else {
       diagnostics.available = it->second;
     }
   }
 
-  // get the current gain values
+  // get the current gain values, as they were sent to the controller (they can be in the middle of a transition)
   {
-    std::map<std::string, Gains_t>::iterator it;
-    it = _gains_.find(current_gains);
+    auto controller_gains = mrs_lib::get_mutexed(mutex_set_gains_, controller_gains_);
+
+    if (controller_gains) {
 
-    diagnostics.current_values.kpxy = it->second.kpxy;
-    diagnostics.current_values.kvxy = it->second.kvxy;
-    diagnostics.current_values.kaxy = it->second.kaxy;
+      const Gains_t& gains = controller_gains.value();
 
-    diagnostics.current_values.kqxy = it->second.kqxy;
-    diagnostics.current_values.kqxy = it->second.kqxy;
+      diagnostics.current_values.kpxy = gains.values[Gains_t::KPXY];
+      diagnostics.current_values.kvxy = gains.values[Gains_t::KVXY];
+      diagnostics.current_values.kaxy = gains.values[Gains_t::KAXY];
 
-    diagnostics.current_values.kibxy     = it->second.kibxy;
-    diagnostics.current_values.kibxy_lim = it->second.kibxy_lim;
+      diagnostics.current_values.kqxy = gains.values[Gains_t::KQXY];
 
-    diagnostics.current_values.kiwxy     = it->second.kiwxy;
-    diagnostics.current_values.kiwxy_lim = it->second.kiwxy_lim;
+      diagnostics.current_values.kibxy     = gains.values[Gains_t::KIBXY];
+      diagnostics.current_values.kibxy_lim = gains.values[Gains_t::KIBXY_LIM];
 
-    diagnostics.current_values.kpz = it->second.kpz;
-    diagnostics.current_values.kvz = it->second.kvz;
-    diagnostics.current_values.kaz = it->second.kaz;
+      diagnostics.current_values.kiwxy     = gains.values[Gains_t::KIWXY];
+      diagnostics.current_values.kiwxy_lim = gains.values[Gains_t::KIWXY_LIM];
 
-    diagnostics.current_values.kqz = it->second.kqz;
-    diagnostics.current_values.kqz = it->second.kqz;
+      diagnostics.current_values.kpz = gains.values[Gains_t::KPZ];
+      diagnostics.current_values.kvz = gains.values[Gains_t::KVZ];
+      diagnostics.current_values.kaz = gains.values[Gains_t::KAZ];
 
-    diagnostics.current_values.km     = it->second.km;
-    diagnostics.current_values.km_lim = it->second.km_lim;
+      diagnostics.current_values.kqz = gains.values[Gains_t::KQZ];
+
+      diagnostics.current_values.km     = gains.values[Gains_t::KM];
+      diagnostics.current_values.km_lim = gains.values[Gains_t::KM_LIM];
+    }
   }
 
   ph_diagnostics_.publish(diagnostics);
@@ -601,6 +852,108 @@ void GainManager::timerDiagnostics(const ros::TimerEvent& event) {
 // |                          routines                          |
 // --------------------------------------------------------------
 
+/* getEstimator() //{ */
+
+// the estimator is read from the state board when the ControlManager runs in the same nodelet manager,
+// otherwise from the odometry diagnostics
+bool GainManager::getEstimator(int& estimator_id, mrs_msgs::EstimatorType::_type_type& estimator_type) {
+
+  state_board::ControlManagerState control_manager_state;
+
+  if (_state_board_enabled_ && state_board_->getControlManagerState(control_manager_state, ros::Time::now().toSec(), _state_board_timeout_) &&
+      control_manager_state.estimator != state_board::NameRegistry::INVALID_ID) {
+
+    estimator_id   = control_manager_state.estimator;
+    estimator_type = control_manager_state.estimator_type;
+
+    return true;
+  }
+
+  if (!sh_odom_diag_.hasMsg()) {
+    return false;
+  }
+
+  auto odometry_diagnostics = sh_odom_diag_.getMsg();
+
+  estimator_id   = odometry_estimator_.get(state_board_->names, odometry_diagnostics->estimator_type.name);
+  estimator_type = odometry_diagnostics->estimator_type.type;
+
+  return true;
+}
+
+//}
+
+/* getActiveController() //{ */
+
+// the active controller is read from the state board when the ControlManager runs in the same nodelet manager,
+// otherwise from the ControlManager diagnostics
+bool GainManager::getActiveController(int& active_controller, bool& controller_active) {
+
+  state_board::ControlManagerState control_manager_state;
+
+  if (_state_board_enabled_ && state_board_->getControlManagerState(control_manager_state, ros::Time::now().toSec(), _state_board_timeout_)) {
+
+    active_controller = control_manager_state.active_controller;
+    controller_active = control_manager_state.controller_active;
+
+    return true;
+  }
+
+  if (!sh_control_manager_diag_.hasMsg()) {
+    return false;
+  }
+
+  auto control_manager_diag = sh_control_manager_diag_.getMsg();
+
+  active_controller = diagnostics_active_controller_.get(state_board_->names, control_manager_diag->active_controller);
+  controller_active = control_manager_diag->controller_status.active;
+
+  return true;
+}
+
+//}
+
+/* gainsChannelActive() //{ */
+
+bool GainManager::gainsChannelActive(void) {
+
+  return _state_board_enabled_ && _gains_channel_enabled_ && state_board_->hasGainsConsumer();
+}
+
+//}
+
+/* getScheduleVariable() //{ */
+
+// the state is read from the state board when the ControlManager runs in the same nodelet manager,
+// otherwise from the UAV state topic
+bool GainManager::getScheduleVariable(const GainSchedule_t::Variable variable, double& value) {
+
+  state_board::ControlManagerState control_manager_state;
+
+  if (_state_board_enabled_ && state_board_->getControlManagerState(control_manager_state, ros::Time::now().toSec(), _state_board_timeout_)) {
+
+    value = variable == GainSchedule_t::SPEED ? control_manager_state.speed : control_manager_state.height;
+
+    return true;
+  }
+
+  if (!sh_uav_state_.hasMsg()) {
+    return false;
+  }
+
+  auto uav_state = sh_uav_state_.getMsg();
+
+  if (variable == GainSchedule_t::SPEED) {
+    value = std::hypot(uav_state->velocity.linear.x, uav_state->velocity.linear.y);
+  } else {
+    value = uav_state->pose.position.z;
+  }
+
+  return true;
+}
+
+//}
+
 /* stringInVector() //{ */
 
 bool GainManager::stringInVector(const std::string& value, const std::vector<std::string>& vector) {
@@ -0,0 +1,34 @@
+#include <mrs_uav_managers/state_board.h>
+
+#include <map>
+#include <memory>
+
+namespace mrs_uav_managers
+{
+
+namespace state_board
+{
+
+/* getStateBoard() //{ */
+
+StateBoard& getStateBoard(const std::string& uav_namespace) {
+
+  static std::mutex                                         mutex;
+  static std::map<std::string, std::unique_ptr<StateBoard>> boards;
+
+  std::scoped_lock lock(mutex);
+
+  auto it = boards.find(uav_namespace);
+
+  if (it == boards.end()) {
+    it = boards.insert({uav_namespace, std::make_unique<StateBoard>()}).first;
+  }
+
+  return *it->second;
+}
+
+//}
+
+}  // namespace state_board
+
+}  // namespace mrs_uav_managers
@@ -45,6 +45,18 @@
 #include <mrs_lib/geometry/misc.h>
 #include <mrs_lib/quadratic_thrust_model.h>
 
+#include <mrs_uav_managers/state_board.h>
+#include <mrs_uav_managers/control_manager_commands.h>
+#include <mrs_uav_managers/landing_detector.h>
+
+#include <optional>
+#include <future>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+
 //}
 
 /* using //{ */
@@ -63,6 +75,313 @@ namespace mrs_uav_managers
 namespace uav_manager
 {
 
+/* class CommandStragglers //{ */
+
+// finishes the steps of the command sequences which missed their deadline, so that the sequence can return at the deadline
+// * the jobs are executed in the order of posting by a worker thread, which outlives the sequences
+// * the destructor waits for the pending jobs, since the steps use the manager
+class CommandStragglers {
+
+public:
+  typedef std::function<void(void)> job_t;
+
+  CommandStragglers(void);
+  ~CommandStragglers(void);
+
+  void post(const job_t& job);
+
+private:
+  std::mutex              mutex_;
+  std::condition_variable cv_;
+  std::deque<job_t>       jobs_;
+  bool                    stop_ = false;
+  std::thread             thread_;
+
+  void loop(void);
+};
+
+CommandStragglers::CommandStragglers(void) {
+  thread_ = std::thread(&CommandStragglers::loop, this);
+}
+
+CommandStragglers::~CommandStragglers(void) {
+
+  {
+    std::scoped_lock lock(mutex_);
+
+    stop_ = true;
+  }
+
+  cv_.notify_one();
+
+  thread_.join();
+}
+
+void CommandStragglers::post(const job_t& job) {
+
+  {
+    std::scoped_lock lock(mutex_);
+
+    jobs_.push_back(job);
+  }
+
+  cv_.notify_one();
+}
+
+void CommandStragglers::loop(void) {
+
+  while (true) {
+
+    job_t job;
+
+    {
+      std::unique_lock lock(mutex_);
+
+      cv_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+
+      // the pending jobs are finished before stopping
+      if (jobs_.empty()) {
+        return;
+      }
+
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+
+    job();
+  }
+}
+
+//}
+
+/* class CommandSequence //{ */
+
+// executes a chain of blocking service calls
+// * the chain is split into stages, the steps within a stage are independent and are issued concurrently
+// * each step runs in its own thread and has its own timeout, run() returns at the deadline of a required step which did not finish,
+//   the step is reported as failed and handed off to the stragglers' worker together with the rest of its stage
+// * the chain stops after the first stage with a failed required step, the failure handlers of the failed steps are called
+//   after all the steps of the stage finish (by the worker, when some of them missed the deadline), a step which timed out
+//   and then succeeded is not rolled back, its late success is reported instead
+class CommandSequence {
+
+public:
+  typedef std::function<bool(void)>                                                                       step_t;
+  typedef std::function<void(void)>                                                                       failure_t;
+  typedef std::function<void(const std::string& step, const std::string& result, const double duration)> progress_t;
+
+  CommandSequence(CommandStragglers& stragglers, const progress_t& progress);
+  ~CommandSequence(void);
+
+  void addStep(const std::string& name, const step_t& step, const double timeout, const failure_t& on_failure = nullptr);
+  void addOptionalStep(const std::string& name, const step_t& step, const double timeout);
+
+  // the following steps are started after all the steps of the current stage finish
+  void nextStage(void);
+
+  // returns the success and the name of the first failed step
+  std::tuple<bool, std::string> run(void);
+
+private:
+  struct Step
+  {
+    std::string name;
+    step_t      step;
+    double      timeout;
+    failure_t   on_failure;
+    bool        required;
+  };
+
+  // the rest of a stage with steps which missed their deadline, finished by the stragglers' worker
+  struct LateStep
+  {
+    std::string       name;
+    std::future<bool> result;
+    failure_t         on_failure;
+  };
+
+  struct LateStage
+  {
+    std::vector<std::thread>              threads;
+    std::vector<LateStep>                 steps;
+    std::vector<failure_t>                rollbacks;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  CommandStragglers&             stragglers_;
+  progress_t                     progress_;
+  std::vector<std::vector<Step>> stages_;
+  std::vector<std::thread>       threads_;  // the threads of the current stage
+
+  void joinThreads(void);
+};
+
+CommandSequence::CommandSequence(CommandStragglers& stragglers, const progress_t& progress) : stragglers_(stragglers), progress_(progress), stages_(1) {
+}
+
+CommandSequence::~CommandSequence(void) {
+  joinThreads();
+}
+
+void CommandSequence::joinThreads(void) {
+
+  for (auto& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  threads_.clear();
+}
+
+void CommandSequence::addStep(const std::string& name, const step_t& step, const double timeout, const failure_t& on_failure) {
+  stages_.back().push_back(Step{name, step, timeout, on_failure, true});
+}
+
+void CommandSequence::addOptionalStep(const std::string& name, const step_t& step, const double timeout) {
+  stages_.back().push_back(Step{name, step, timeout, nullptr, false});
+}
+
+void CommandSequence::nextStage(void) {
+  stages_.emplace_back();
+}
+
+std::tuple<bool, std::string> CommandSequence::run(void) {
+
+  for (auto& stage : stages_) {
+
+    std::vector<std::future<bool>> results;
+
+    const auto stage_start = std::chrono::steady_clock::now();
+
+    // issue all the steps of the stage at once
+    for (auto& step : stage) {
+
+      std::packaged_task<bool(void)> task(step.step);
+
+      results.push_back(task.get_future());
+
+      threads_.push_back(std::thread(std::move(task)));
+
+      progress_(step.name, "started", 0.0);
+    }
+
+    bool                   stage_success = true;
+    std::string            failed_step;
+    std::vector<failure_t> rollbacks;
+    std::vector<size_t>    late_steps;
+
+    for (size_t i = 0; i < stage.size(); i++) {
+
+      const auto deadline = stage_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(stage[i].timeout));
+
+      bool success = false;
+
+      if (results[i].wait_until(deadline) == std::future_status::timeout) {
+
+        progress_(stage[i].name, "timeout", std::chrono::duration<double>(std::chrono::steady_clock::now() - stage_start).count());
+
+        // the step is still running, its result is handled by the stragglers' worker
+        late_steps.push_back(i);
+
+      } else {
+
+        std::string result;
+
+        try {
+          success = results[i].get();
+          result  = success ? "done" : "failed";
+        }
+        catch (std::exception& e) {
+          result = std::string("exception: ") + e.what();
+        }
+
+        progress_(stage[i].name, result, std::chrono::duration<double>(std::chrono::steady_clock::now() - stage_start).count());
+
+        if (!success && stage[i].required && stage[i].on_failure) {
+          rollbacks.push_back(stage[i].on_failure);
+        }
+      }
+
+      if (!stage[i].required || success) {
+        continue;
+      }
+
+      if (stage_success) {
+        failed_step = stage[i].name;
+      }
+
+      stage_success = false;
+    }
+
+    if (late_steps.empty()) {
+
+      // the rollbacks do not overlap with the steps of the stage
+      joinThreads();
+
+      for (auto& rollback : rollbacks) {
+        rollback();
+      }
+
+    } else {
+
+      // the caller does not wait for the late steps, the rollbacks run after them
+      auto late_stage = std::make_shared<LateStage>();
+
+      late_stage->threads   = std::move(threads_);
+      late_stage->rollbacks = rollbacks;
+      late_stage->start     = stage_start;
+
+      threads_.clear();
+
+      for (auto& i : late_steps) {
+        late_stage->steps.push_back(LateStep{stage[i].name, std::move(results[i]), stage[i].required ? stage[i].on_failure : nullptr});
+      }
+
+      // the worker outlives the sequence, so it gets a copy of the progress callback, not this
+      stragglers_.post([late_stage, progress = progress_]() {
+        for (auto& thread : late_stage->threads) {
+          thread.join();
+        }
+
+        for (auto& step : late_stage->steps) {
+
+          std::string result;
+          bool        success = false;
+
+          try {
+            success = step.result.get();
+            result  = success ? "done" : "failed";
+          }
+          catch (std::exception& e) {
+            result = std::string("exception: ") + e.what();
+          }
+
+          progress(step.name, success ? "finished late, not rolled back" : "finished late, " + result,
+                   std::chrono::duration<double>(std::chrono::steady_clock::now() - late_stage->start).count());
+
+          // the late success already took effect, rolling it back could undo it in the wrong state (e.g., eland after a finished takeoff)
+          if (!success && step.on_failure) {
+            late_stage->rollbacks.push_back(step.on_failure);
+          }
+        }
+
+        for (auto& rollback : late_stage->rollbacks) {
+          rollback();
+        }
+      });
+    }
+
+    if (!stage_success) {
+      return std::tuple(false, failed_step);
+    }
+  }
+
+  return std::tuple(true, "");
+}
+
+//}
+
 /* //{ class UavManager */
 
 // state machine
@@ -115,6 +434,8 @@ public:
 
   void callbackMavrosGps(mrs_lib::SubscribeHandler<sensor_msgs::NavSatFix>& wrp);
   void callbackOdometry(mrs_lib::SubscribeHandler<nav_msgs::Odometry>& wrp);
+  void callbackHeight(mrs_lib::SubscribeHandler<mrs_msgs::Float64Stamped>& wrp);
+  void callbackAttitudeCmd(mrs_lib::SubscribeHandler<mrs_msgs::AttitudeCommand>& wrp);
 
   // service servers
   ros::ServiceServer service_server_takeoff_;
@@ -162,10 +483,7 @@ public:
   bool offboardSrv(const bool in);
 
   ros::Timer timer_takeoff_;
-  ros::Timer timer_max_height_;
-  ros::Timer timer_min_height_;
   ros::Timer timer_landing_;
-  ros::Timer timer_maxthrust_;
   ros::Timer timer_flighttime_;
   ros::Timer timer_diagnostics_;
   ros::Timer timer_midair_activation_;
@@ -173,33 +491,44 @@ public:
   // timer callbacks
   void timerLanding(const ros::TimerEvent& event);
   void timerTakeoff(const ros::TimerEvent& event);
-  void timerMaxHeight(const ros::TimerEvent& event);
-  void timerMinHeight(const ros::TimerEvent& event);
   void timerFlightTime(const ros::TimerEvent& event);
-  void timerMaxThrust(const ros::TimerEvent& event);
   void timerDiagnostics(const ros::TimerEvent& event);
 
   // publishers
   mrs_lib::PublisherHandler<mrs_msgs::UavManagerDiagnostics> ph_diag_;
+  mrs_lib::PublisherHandler<std_msgs::String>                ph_command_progress_;
+  mrs_lib::PublisherHandler<mrs_msgs::Float64Stamped>        ph_landing_confidence_;
+
+  // | -------------------- safety monitors --------------------- |
+
+  // the monitors are evaluated in the callbacks of the measurements they watch,
+  // the interventions are edge-triggered and released with a hysteresis
 
   // max height checking
   bool              _max_height_enabled_ = false;
-  int               _max_height_checking_rate_;
+  double            _max_height_retry_period_;
+  double            _max_height_hysteresis_;
   double            _max_height_offset_;
   double            _max_height_;
   std::atomic<bool> fixing_max_height_ = false;
+  ros::Time         max_height_last_attempt_;
 
   // min height checking
   bool              _min_height_enabled_ = false;
-  int               _min_height_checking_rate_;
+  double            _min_height_retry_period_;
+  double            _min_height_hysteresis_;
   double            _min_height_offset_;
   double            _min_height_;
   std::atomic<bool> fixing_min_height_ = false;
+  ros::Time         min_height_last_attempt_;
+
+  void checkMaxHeight(const double height);
+  void checkMinHeight(const double height);
 
-  // mass estimation during landing
-  double    thrust_mass_estimate_;
-  bool      thrust_under_threshold_ = false;
-  ros::Time thrust_mass_estimate_first_time_;
+  // touchdown detection during landing, fed from the attitude command and odometry callbacks
+  landing::LandingDetectorParams _landing_detector_params_;
+  landing::LandingDetector       landing_detector_;
+  std::mutex                     mutex_landing_detector_;
 
   bool _gain_manager_required_       = false;
   bool _constraint_manager_required_ = false;
@@ -238,8 +567,6 @@ public:
   // Landing timer
   std::string _landing_tracker_name_;
   std::string _landing_controller_name_;
-  double      _landing_cutoff_mass_factor_;
-  double      _landing_cutoff_mass_timeout_;
   double      _landing_timer_rate_;
   double      _landing_descend_height_;
   bool        landing_ = false;
@@ -266,14 +593,18 @@ public:
   double     flighttime_                = 0;
   std::mutex mutex_flighttime_;
 
-  // timer for checking maximum thrust
-  bool      _maxthrust_timer_enabled_ = false;
-  double    _maxthrust_timer_rate_;
-  double    _maxthrust_max_thrust_;
-  double    _maxthrust_eland_timeout_;
-  double    _maxthrust_ungrip_timeout_;
-  bool      maxthrust_above_threshold_ = false;
-  ros::Time maxthrust_first_time_;
+  // checking maximum thrust, armed after takeoff, disarmed after triggering eland
+  bool              _maxthrust_enabled_ = false;
+  double            _maxthrust_max_thrust_;
+  double            _maxthrust_hysteresis_;
+  double            _maxthrust_eland_timeout_;
+  double            _maxthrust_ungrip_timeout_;
+  std::atomic<bool> maxthrust_armed_           = false;
+  bool              maxthrust_above_threshold_ = false;
+  bool              maxthrust_ungripped_       = false;
+  ros::Time         maxthrust_first_time_;
+
+  void checkMaxThrust(const double desired_thrust);
 
   // profiler
   mrs_lib::Profiler profiler_;
@@ -289,6 +620,41 @@ public:
   std::string _midair_activation_during_tracker_;
   std::string _midair_activation_after_controller_;
   std::string _midair_activation_after_tracker_;
+
+  // | ----------------------- state board ---------------------- |
+
+  // the ControlManager state is read from the in-process state board when the ControlManager
+  // runs in the same nodelet manager, otherwise it is parsed from its diagnostics topic
+  bool                     _state_board_enabled_ = false;
+  double                   _state_board_timeout_;
+  state_board::StateBoard* state_board_ = nullptr;
+
+  int null_tracker_id_;
+  int takeoff_tracker_id_;
+  int landing_tracker_id_;
+
+  std::optional<state_board::ControlManagerState> getControlManagerState(void);
+
+  // the names from the diagnostics topic, interned only when they change
+  state_board::InternCache diagnostics_active_tracker_;
+  state_board::InternCache diagnostics_active_controller_;
+
+  // the ControlManager commands are called directly when it runs in the same nodelet manager,
+  // the service client wrappers fall back to the services otherwise
+  std::shared_ptr<const state_board::ControlManagerCommands> getControlManagerCommands(void);
+
+  // | -------------------- command sequences ------------------- |
+
+  // timeouts of the individual service calls of the takeoff and landing sequences
+  double _command_timeout_switch_;
+  double _command_timeout_takeoff_;
+  double _command_timeout_land_;
+  double _command_timeout_callbacks_;
+
+  CommandSequence::progress_t commandProgress(const std::string& sequence);
+
+  // the steps which missed their deadline, declared last, so it waits for them before the rest of the manager is destroyed
+  CommandStragglers command_stragglers_;
 };
 
 //}
@@ -330,13 +696,13 @@ void UavManager::onInit() {
   param_loader.loadParam("landing/rate", _landing_timer_rate_);
   param_loader.loadParam("landing/landing_tracker", _landing_tracker_name_);
   param_loader.loadParam("landing/landing_controller", _landing_controller_name_);
-  param_loader.loadParam("landing/landing_cutoff_mass_factor", _landing_cutoff_mass_factor_);
-  param_loader.loadParam("landing/landing_cutoff_timeout", _landing_cutoff_mass_timeout_);
   param_loader.loadParam("landing/disarm", _landing_disarm_);
   param_loader.loadParam("landing/descend_height", _landing_descend_height_);
   param_loader.loadParam("landing/tracking_tolerance/translation", _landing_tracking_tolerance_translation_);
   param_loader.loadParam("landing/tracking_tolerance/heading", _landing_tracking_tolerance_heading_);
 
+  landing::loadParams(param_loader, _landing_detector_params_);
+
   param_loader.loadParam("midair_activation/rate", _midair_activation_timer_rate_);
   param_loader.loadParam("midair_activation/during_activation/controller", _midair_activation_during_controller_);
   param_loader.loadParam("midair_activation/during_activation/tracker", _midair_activation_during_tracker_);
@@ -351,11 +717,13 @@ void UavManager::onInit() {
   param_loader.loadParam("motor_params/b", _motor_params_.B);
 
   param_loader.loadParam("max_height_checking/enabled", _max_height_enabled_);
-  param_loader.loadParam("max_height_checking/rate", _max_height_checking_rate_);
+  param_loader.loadParam("max_height_checking/retry_period", _max_height_retry_period_);
+  param_loader.loadParam("max_height_checking/hysteresis", _max_height_hysteresis_);
   param_loader.loadParam("max_height_checking/safety_height_offset", _max_height_offset_);
 
   param_loader.loadParam("min_height_checking/enabled", _min_height_enabled_);
-  param_loader.loadParam("min_height_checking/rate", _min_height_checking_rate_);
+  param_loader.loadParam("min_height_checking/retry_period", _min_height_retry_period_);
+  param_loader.loadParam("min_height_checking/hysteresis", _min_height_hysteresis_);
   param_loader.loadParam("min_height_checking/safety_height_offset", _min_height_offset_);
   param_loader.loadParam("min_height_checking/min_height", _min_height_);
 
@@ -368,14 +736,22 @@ void UavManager::onInit() {
   param_loader.loadParam("flight_timer/rate", _flighttime_timer_rate_);
   param_loader.loadParam("flight_timer/max_time", _flighttime_max_time_);
 
-  param_loader.loadParam("max_thrust/enabled", _maxthrust_timer_enabled_);
-  param_loader.loadParam("max_thrust/rate", _maxthrust_timer_rate_);
+  param_loader.loadParam("max_thrust/enabled", _maxthrust_enabled_);
   param_loader.loadParam("max_thrust/max_thrust", _maxthrust_max_thrust_);
+  param_loader.loadParam("max_thrust/hysteresis", _maxthrust_hysteresis_);
   param_loader.loadParam("max_thrust/eland_timeout", _maxthrust_eland_timeout_);
   param_loader.loadParam("max_thrust/ungrip_timeout", _maxthrust_ungrip_timeout_);
 
   param_loader.loadParam("diagnostics/rate", _diagnostics_timer_rate_);
 
+  param_loader.loadParam("state_board/enabled", _state_board_enabled_);
+  param_loader.loadParam("state_board/timeout", _state_board_timeout_);
+
+  param_loader.loadParam("command_sequence/timeout/switch", _command_timeout_switch_);
+  param_loader.loadParam("command_sequence/timeout/takeoff", _command_timeout_takeoff_);
+  param_loader.loadParam("command_sequence/timeout/land", _command_timeout_land_);
+  param_loader.loadParam("command_sequence/timeout/callbacks", _command_timeout_callbacks_);
+
   // | ------------------- scope timer logger ------------------- |
 
   param_loader.loadParam("scope_timer/enabled", scope_timer_enabled_);
@@ -387,6 +763,29 @@ void UavManager::onInit() {
     ros::shutdown();
   }
 
+  // the intervention targets a height beyond the hysteresis band, otherwise it would never be released
+  if (_max_height_hysteresis_ < 0 || _max_height_hysteresis_ >= _max_height_offset_) {
+    ROS_ERROR("[UavManager]: max_height_checking/hysteresis has to be within [0, safety_height_offset)");
+    ros::shutdown();
+  }
+
+  if (_min_height_hysteresis_ < 0 || _min_height_hysteresis_ >= _min_height_offset_) {
+    ROS_ERROR("[UavManager]: min_height_checking/hysteresis has to be within [0, safety_height_offset)");
+    ros::shutdown();
+  }
+
+  if (_maxthrust_hysteresis_ < 0) {
+    ROS_ERROR("[UavManager]: max_thrust/hysteresis has to be >= 0");
+    ros::shutdown();
+  }
+
+  if (!_landing_detector_params_.valid()) {
+    ROS_ERROR("[UavManager]: the landing_detector parameters are not valid");
+    ros::shutdown();
+  }
+
+  landing_detector_ = landing::LandingDetector(_landing_detector_params_);
+
   // | --------------------- tf transformer --------------------- |
 
   transformer_ = std::make_shared<mrs_lib::Transformer>(nh_, "ControlManager");
@@ -408,8 +807,8 @@ void UavManager::onInit() {
   sh_odometry_diagnostics_ = mrs_lib::SubscribeHandler<mrs_msgs::OdometryDiag>(shopts, "odometry_diagnostics_in");
   sh_control_manager_diag_ = mrs_lib::SubscribeHandler<mrs_msgs::ControlManagerDiagnostics>(shopts, "control_manager_diagnostics_in");
   sh_motors_               = mrs_lib::SubscribeHandler<mrs_msgs::BoolStamped>(shopts, "motors_in");
-  sh_attitude_cmd_         = mrs_lib::SubscribeHandler<mrs_msgs::AttitudeCommand>(shopts, "attitude_cmd_in");
-  sh_height_               = mrs_lib::SubscribeHandler<mrs_msgs::Float64Stamped>(shopts, "height_in");
+  sh_attitude_cmd_         = mrs_lib::SubscribeHandler<mrs_msgs::AttitudeCommand>(shopts, "attitude_cmd_in", &UavManager::callbackAttitudeCmd, this);
+  sh_height_               = mrs_lib::SubscribeHandler<mrs_msgs::Float64Stamped>(shopts, "height_in", &UavManager::callbackHeight, this);
   sh_mavros_state_         = mrs_lib::SubscribeHandler<mavros_msgs::State>(shopts, "mavros_state_in");
   sh_gains_diag_           = mrs_lib::SubscribeHandler<mrs_msgs::GainManagerDiagnostics>(shopts, "gain_manager_diagnostics_in");
   sh_constraints_diag_     = mrs_lib::SubscribeHandler<mrs_msgs::ConstraintManagerDiagnostics>(shopts, "constraint_manager_diagnostics_in");
@@ -419,7 +818,9 @@ void UavManager::onInit() {
 
   // | ----------------------- publishers ----------------------- |
 
-  ph_diag_ = mrs_lib::PublisherHandler<mrs_msgs::UavManagerDiagnostics>(nh_, "diagnostics_out", 1);
+  ph_diag_               = mrs_lib::PublisherHandler<mrs_msgs::UavManagerDiagnostics>(nh_, "diagnostics_out", 1);
+  ph_command_progress_   = mrs_lib::PublisherHandler<std_msgs::String>(nh_, "command_progress_out", 10);
+  ph_landing_confidence_ = mrs_lib::PublisherHandler<mrs_msgs::Float64Stamped>(nh_, "landing_confidence_out", 10);
 
   // | --------------------- service servers -------------------- |
 
@@ -446,6 +847,14 @@ void UavManager::onInit() {
   sch_motors_              = mrs_lib::ServiceClientHandler<std_srvs::SetBool>(nh_, "motors_out");
   sch_offboard_            = mrs_lib::ServiceClientHandler<mavros_msgs::SetMode>(nh_, "offboard_out");
 
+  // | ----------------------- state board ---------------------- |
+
+  state_board_ = &state_board::getStateBoard(ros::names::parentNamespace(nh_.getNamespace()));
+
+  null_tracker_id_    = state_board_->names.intern(_null_tracker_name_);
+  takeoff_tracker_id_ = state_board_->names.intern(_takeoff_tracker_name_);
+  landing_tracker_id_ = state_board_->names.intern(_landing_tracker_name_);
+
   // | ---------------------- state machine --------------------- |
 
   current_state_landing_ = IDLE_STATE;
@@ -459,18 +868,9 @@ void UavManager::onInit() {
   timer_landing_           = nh_.createTimer(ros::Rate(_landing_timer_rate_), &UavManager::timerLanding, this, false, false);
   timer_takeoff_           = nh_.createTimer(ros::Rate(_takeoff_timer_rate_), &UavManager::timerTakeoff, this, false, false);
   timer_flighttime_        = nh_.createTimer(ros::Rate(_flighttime_timer_rate_), &UavManager::timerFlightTime, this, false, false);
-  timer_maxthrust_         = nh_.createTimer(ros::Rate(_maxthrust_timer_rate_), &UavManager::timerMaxThrust, this, false, false);
   timer_diagnostics_       = nh_.createTimer(ros::Rate(_diagnostics_timer_rate_), &UavManager::timerDiagnostics, this);
   timer_midair_activation_ = nh_.createTimer(ros::Rate(_midair_activation_timer_rate_), &UavManager::timerMidairActivation, this, false, false);
 
-  if (_max_height_enabled_) {
-    timer_max_height_ = nh_.createTimer(ros::Rate(_max_height_checking_rate_), &UavManager::timerMaxHeight, this);
-  }
-
-  if (_min_height_enabled_) {
-    timer_min_height_ = nh_.createTimer(ros::Rate(_min_height_checking_rate_), &UavManager::timerMinHeight, this);
-  }
-
   // | ----------------------- finish init ---------------------- |
 
   is_initialized_ = true;
@@ -499,6 +899,22 @@ void UavManager::changeLandingState(LandingStates_t new_state) {
     case LANDING_STATE: {
 
       landing_uav_mass_ = _uav_mass_ + attitude_cmd->mass_difference;
+
+      {
+        std::scoped_lock lock(mutex_landing_detector_);
+
+        landing_detector_.reset(landing_uav_mass_);
+      }
+
+      break;
+    };
+
+    case IDLE_STATE: {
+
+      std::scoped_lock lock(mutex_landing_detector_);
+
+      landing_detector_.stop();
+
       break;
     };
 
@@ -529,11 +945,16 @@ void UavManager::timerLanding(const ros::TimerEvent& event) {
 
   auto land_there_reference = mrs_lib::get_mutexed(mutex_land_there_reference_, land_there_reference_);
 
+  auto control_manager_state = getControlManagerState();
+
+  if (!control_manager_state) {
+    ROS_WARN_THROTTLE(1.0, "[UavManager]: missing the ControlManager state during landing");
+    return;
+  }
+
   // copy member variables
-  auto   control_manager_diagnostics = sh_control_manager_diag_.getMsg();
-  double desired_thrust              = sh_attitude_cmd_.getMsg()->thrust;
-  auto   odometry                    = sh_odometry_.getMsg();
-  auto   position_cmd                = sh_position_cmd_.getMsg();
+  auto odometry     = sh_odometry_.getMsg();
+  auto position_cmd = sh_position_cmd_.getMsg();
 
   auto res = transformer_->transformSingle(land_there_reference, odometry->header.frame_id);
 
@@ -577,7 +998,7 @@ void UavManager::timerLanding(const ros::TimerEvent& event) {
         ROS_ERROR_THROTTLE(1.0, "[UavManager]: call for landing failed: '%s'", message.c_str());
       }
 
-    } else if (!control_manager_diagnostics->tracker_status.have_goal && control_manager_diagnostics->flying_normally) {
+    } else if (!control_manager_state->have_goal && control_manager_state->flying_normally) {
 
       ROS_WARN_THROTTLE(1.0, "[UavManager]: the tracker does not have a goal while flying home, setting the reference again");
 
@@ -620,29 +1041,37 @@ void UavManager::timerLanding(const ros::TimerEvent& event) {
   } else if (current_state_landing_ == LANDING_STATE) {
 
     // we should not attempt to finish the landing if some other tracked was activated
-    if (_landing_tracker_name_ == sh_control_manager_diag_.getMsg()->active_tracker) {
+    if (landing_tracker_id_ == control_manager_state->active_tracker) {
 
-      // recalculate the mass based on the thrust
-      thrust_mass_estimate_ = mrs_lib::quadratic_thrust_model::thrustToForce(_motor_params_, desired_thrust) / _g_;
-      ROS_INFO_THROTTLE(1.0, "[UavManager]: landing: initial mass: %.2f thrust mass estimate: %.2f", landing_uav_mass_, thrust_mass_estimate_);
-
-      // condition for automatic motor turn off
-      if (((thrust_mass_estimate_ < _landing_cutoff_mass_factor_ * landing_uav_mass_) || desired_thrust < 0.01)) {
+      const double now = ros::Time::now().toSec();
 
-        if (!thrust_under_threshold_) {
+      bool   touchdown;
+      double confidence, mass_ratio, time_under_cutoff;
 
-          thrust_mass_estimate_first_time_ = ros::Time::now();
-          thrust_under_threshold_          = true;
-        }
+      {
+        std::scoped_lock lock(mutex_landing_detector_);
 
-        ROS_INFO_THROTTLE(0.5, "[UavManager]: thrust is under cutoff factor for %.2f s", (ros::Time::now() - thrust_mass_estimate_first_time_).toSec());
+        touchdown         = landing_detector_.update(now);
+        confidence        = landing_detector_.confidence();
+        mass_ratio        = landing_detector_.massRatio();
+        time_under_cutoff = landing_detector_.timeUnderCutoff(now);
+      }
 
-      } else {
+      ROS_INFO_THROTTLE(1.0, "[UavManager]: landing: initial mass: %.2f thrust mass estimate: %.2f, touchdown confidence: %.2f", landing_uav_mass_,
+                        mass_ratio * landing_uav_mass_, confidence);
 
-        thrust_under_threshold_ = false;
+      if (time_under_cutoff > 0) {
+        ROS_INFO_THROTTLE(0.5, "[UavManager]: thrust is under cutoff factor for %.2f s", time_under_cutoff);
       }
 
-      if (thrust_under_threshold_ && ((ros::Time::now() - thrust_mass_estimate_first_time_).toSec() > _landing_cutoff_mass_timeout_)) {
+      mrs_msgs::Float64Stamped confidence_out;
+      confidence_out.header.stamp = ros::Time::now();
+      confidence_out.value        = confidence;
+
+      ph_landing_confidence_.publish(confidence_out);
+
+      // condition for automatic motor turn off
+      if (touchdown) {
 
         switchTrackerSrv(_null_tracker_name_);
 
@@ -681,11 +1110,16 @@ void UavManager::timerTakeoff(const ros::TimerEvent& event) {
   mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerTakeoff", _takeoff_timer_rate_, 0.1, event);
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("UavManager::timerTakeoff", scope_timer_logger_, scope_timer_enabled_);
 
-  auto control_manager_diagnostics = sh_control_manager_diag_.getMsg();
+  auto control_manager_state = getControlManagerState();
+
+  if (!control_manager_state) {
+    ROS_WARN_THROTTLE(1.0, "[UavManager]: missing the ControlManager state during takeoff");
+    return;
+  }
 
   if (waiting_for_takeoff_) {
 
-    if (control_manager_diagnostics->active_tracker == _takeoff_tracker_name_ && control_manager_diagnostics->tracker_status.have_goal) {
+    if (control_manager_state->active_tracker == takeoff_tracker_id_ && control_manager_state->have_goal) {
 
       waiting_for_takeoff_ = false;
     } else {
@@ -697,13 +1131,13 @@ void UavManager::timerTakeoff(const ros::TimerEvent& event) {
 
   if (takingoff_) {
 
-    if (control_manager_diagnostics->active_tracker != _takeoff_tracker_name_ || !control_manager_diagnostics->tracker_status.have_goal) {
+    if (control_manager_state->active_tracker != takeoff_tracker_id_ || !control_manager_state->have_goal) {
 
       ROS_INFO("[UavManager]: take off finished, switching to %s", _after_takeoff_tracker_name_.c_str());
 
-      // if enabled, start the timer for landing after reaching max thrust
-      if (_maxthrust_timer_enabled_) {
-        timer_maxthrust_.start();
+      // if enabled, arm the monitor for landing after reaching max thrust
+      if (_maxthrust_enabled_) {
+        maxthrust_armed_ = true;
       }
 
       switchTrackerSrv(_after_takeoff_tracker_name_);
@@ -724,159 +1158,6 @@ void UavManager::timerTakeoff(const ros::TimerEvent& event) {
 
 //}
 
-/* //{ timerMaxHeight() */
-
-void UavManager::timerMaxHeight(const ros::TimerEvent& event) {
-
-  if (!is_initialized_)
-    return;
-
-  mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerMaxHeight", _max_height_checking_rate_, 0.1, event);
-  mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("UavManager::timerMaxHeight", scope_timer_logger_, scope_timer_enabled_);
-
-  if (!sh_max_height_.hasMsg() || !sh_height_.hasMsg() || !sh_odometry_.hasMsg()) {
-    return;
-  }
-
-  double                     max_height = sh_max_height_.getMsg()->value;
-  double                     height     = sh_height_.getMsg()->value;
-  nav_msgs::OdometryConstPtr odometry   = sh_odometry_.getMsg();
-
-  auto [odometry_x, odometry_y, odometry_z] = mrs_lib::getPosition(odometry);
-
-  double odometry_heading = 0;
-  try {
-    odometry_heading = mrs_lib::getHeading(odometry);
-  }
-  catch (mrs_lib::AttitudeConverter::GetHeadingException& e) {
-    ROS_ERROR_THROTTLE(1.0, "[UavManager]: exception caught: '%s'", e.what());
-    return;
-  }
-
-  if (height > max_height) {
-
-    ROS_WARN_THROTTLE(1.0, "[UavManager]: max height exceeded: %.2f >  %.2f, triggering safety goto", height, max_height);
-
-    mrs_msgs::ReferenceStamped reference_out;
-    reference_out.header.frame_id = odometry->header.frame_id;
-    reference_out.header.stamp    = ros::Time::now();
-
-    reference_out.reference.position.x = odometry_x;
-    reference_out.reference.position.y = odometry_y;
-    reference_out.reference.position.z = odometry_z + ((max_height - _max_height_offset_) - height);
-
-    reference_out.reference.heading = odometry_heading;
-
-    setControlCallbacksSrv(false);
-
-    bool success = emergencyReferenceSrv(reference_out);
-
-    if (success) {
-
-      ROS_INFO("[UavManager]: descending");
-
-      fixing_max_height_ = true;
-
-    } else {
-
-      ROS_ERROR_THROTTLE(1.0, "[UavManager]: could not descend");
-
-      setControlCallbacksSrv(true);
-    }
-  }
-
-  if (fixing_max_height_ && height < max_height) {
-
-    setControlCallbacksSrv(true);
-
-    ROS_WARN_THROTTLE(1.0, "[UavManager]: safe height reached");
-
-    fixing_max_height_ = false;
-  }
-}
-
-//}
-
-/* //{ timerMinHeight() */
-
-void UavManager::timerMinHeight(const ros::TimerEvent& event) {
-
-  if (!is_initialized_)
-    return;
-
-  ROS_INFO_ONCE("[UavManager]: min height timer spinning");
-
-  mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerMinHeight", _min_height_checking_rate_, 0.1, event);
-  mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("UavManager::timerMinHeight", scope_timer_logger_, scope_timer_enabled_);
-
-  if (!sh_height_.hasMsg() || !sh_odometry_.hasMsg() || !sh_control_manager_diag_.hasMsg()) {
-    return;
-  }
-
-  auto control_manager_diag = sh_control_manager_diag_.getMsg();
-
-  if (!control_manager_diag->flying_normally) {
-    return;
-  }
-
-  auto   odometry = sh_odometry_.getMsg();
-  double height   = sh_height_.getMsg()->value;
-
-  auto [odometry_x, odometry_y, odometry_z] = mrs_lib::getPosition(odometry);
-
-  double odometry_heading = 0;
-  try {
-    odometry_heading = mrs_lib::getHeading(odometry);
-  }
-  catch (mrs_lib::AttitudeConverter::GetHeadingException& e) {
-    ROS_ERROR_THROTTLE(1.0, "[UavManager]: exception caught: '%s'", e.what());
-    return;
-  }
-
-  if (height < _min_height_) {
-
-    ROS_WARN_THROTTLE(1.0, "[UavManager]: min height breached: %.2f < %.2f, triggering safety goto", height, _min_height_);
-
-    mrs_msgs::ReferenceStamped reference_out;
-    reference_out.header.frame_id = odometry->header.frame_id;
-    reference_out.header.stamp    = ros::Time::now();
-
-    reference_out.reference.position.x = odometry_x;
-    reference_out.reference.position.y = odometry_y;
-    reference_out.reference.position.z = odometry_z + ((_min_height_ + _min_height_offset_) - height);
-
-    reference_out.reference.heading = odometry_heading;
-
-    setControlCallbacksSrv(false);
-
-    bool success = emergencyReferenceSrv(reference_out);
-
-    if (success) {
-
-      ROS_INFO("[UavManager]: ascending");
-
-      fixing_min_height_ = true;
-
-    } else {
-
-      ROS_ERROR_THROTTLE(1.0, "[UavManager]: could not ascend");
-
-      setControlCallbacksSrv(true);
-    }
-  }
-
-  if (fixing_min_height_ && height > _min_height_) {
-
-    setControlCallbacksSrv(true);
-
-    ROS_WARN_THROTTLE(1.0, "[UavManager]: safe height reached");
-
-    fixing_min_height_ = false;
-  }
-}
-
-//}
-
 /* //{ timerFlightTime() */
 
 void UavManager::timerFlightTime(const ros::TimerEvent& event) {
@@ -913,62 +1194,6 @@ void UavManager::timerFlightTime(const ros::TimerEvent& event) {
 
 //}
 
-/* //{ timerMaxThrust() */
-
-void UavManager::timerMaxThrust(const ros::TimerEvent& event) {
-
-  if (!is_initialized_)
-    return;
-
-  if (!sh_attitude_cmd_.hasMsg()) {
-    return;
-  }
-
-  mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerMaxThrust", _maxthrust_timer_rate_, 0.03, event);
-  mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("UavManager::timerMaxThrust", scope_timer_logger_, scope_timer_enabled_);
-
-  auto desired_thrust = sh_attitude_cmd_.getMsg()->thrust;
-
-  if (desired_thrust >= _maxthrust_max_thrust_) {
-
-    if (!maxthrust_above_threshold_) {
-
-      maxthrust_first_time_      = ros::Time::now();
-      maxthrust_above_threshold_ = true;
-      ROS_WARN_THROTTLE(1.0, "[UavManager]: max thrust exceeded threshold (%.2f/%.2f)", desired_thrust, _maxthrust_max_thrust_);
-
-    } else {
-
-      ROS_WARN_THROTTLE(0.1, "[UavManager]: thrust over threshold (%.2f/%.2f) for %.2f s", desired_thrust, _maxthrust_max_thrust_,
-                        (ros::Time::now() - maxthrust_first_time_).toSec());
-    }
-
-  } else {
-
-    maxthrust_above_threshold_ = false;
-  }
-
-  if (maxthrust_above_threshold_ && (ros::Time::now() - maxthrust_first_time_).toSec() > _maxthrust_ungrip_timeout_) {
-
-    ROS_WARN_THROTTLE(1.0, "[UavManager]: thrust over threshold (%.2f/%.2f) for more than %.2f s, ungripping payload", desired_thrust, _maxthrust_max_thrust_,
-                      _maxthrust_ungrip_timeout_);
-
-    ungripSrv();
-  }
-
-  if (maxthrust_above_threshold_ && (ros::Time::now() - maxthrust_first_time_).toSec() > _maxthrust_eland_timeout_) {
-
-    timer_maxthrust_.stop();
-
-    ROS_ERROR_THROTTLE(1.0, "[UavManager]: thrust over threshold (%.2f/%.2f) for more than %.2f s, calling for emergency landing", desired_thrust,
-                       _maxthrust_max_thrust_, _maxthrust_eland_timeout_);
-
-    elandSrv();
-  }
-}
-
-//}
-
 /* //{ timerDiagnostics() */
 
 void UavManager::timerDiagnostics(const ros::TimerEvent& event) {
@@ -976,7 +1201,7 @@ void UavManager::timerDiagnostics(const ros::TimerEvent& event) {
   if (!is_initialized_)
     return;
 
-  mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerDiagnostics", _maxthrust_timer_rate_, 0.03, event);
+  mrs_lib::Routine    profiler_routine = profiler_.createRoutine("timerDiagnostics", _diagnostics_timer_rate_, 0.03, event);
   mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("UavManager::timerDiagnostics", scope_timer_logger_, scope_timer_enabled_);
 
   bool got_gps_est = false;
@@ -1136,6 +1361,72 @@ void UavManager::callbackOdometry(mrs_lib::SubscribeHandler<nav_msgs::Odometry>&
   nav_msgs::OdometryConstPtr data = wrp.getMsg();
 
   transformer_->setDefaultFrame(data->header.frame_id);
+
+  {
+    std::scoped_lock lock(mutex_landing_detector_);
+
+    if (landing_detector_.active()) {
+      landing_detector_.addOdometry(data->header.stamp.toSec(), data->pose.pose.position.z, data->twist.twist.linear.z);
+    }
+  }
+}
+
+//}
+
+/* //{ callbackHeight() */
+
+void UavManager::callbackHeight(mrs_lib::SubscribeHandler<mrs_msgs::Float64Stamped>& wrp) {
+
+  if (!is_initialized_)
+    return;
+
+  mrs_lib::Routine    profiler_routine = profiler_.createRoutine("callbackHeight");
+  mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("UavManager::callbackHeight", scope_timer_logger_, scope_timer_enabled_);
+
+  const double height = wrp.getMsg()->value;
+
+  if (_max_height_enabled_) {
+    checkMaxHeight(height);
+  }
+
+  if (_min_height_enabled_) {
+    checkMinHeight(height);
+  }
+}
+
+//}
+
+/* //{ callbackAttitudeCmd() */
+
+void UavManager::callbackAttitudeCmd(mrs_lib::SubscribeHandler<mrs_msgs::AttitudeCommand>& wrp) {
+
+  if (!is_initialized_)
+    return;
+
+  mrs_lib::Routine    profiler_routine = profiler_.createRoutine("callbackAttitudeCmd");
+  mrs_lib::ScopeTimer timer            = mrs_lib::ScopeTimer("UavManager::callbackAttitudeCmd", scope_timer_logger_, scope_timer_enabled_);
+
+  mrs_msgs::AttitudeCommandConstPtr attitude_cmd = wrp.getMsg();
+
+  const double desired_thrust = attitude_cmd->thrust;
+
+  {
+    std::scoped_lock lock(mutex_landing_detector_);
+
+    if (landing_detector_.active()) {
+
+      const double mass_estimate = mrs_lib::quadratic_thrust_model::thrustToForce(_motor_params_, desired_thrust) / _g_;
+
+      // the header stamps, the same time base as the odometry, an unstamped command is stamped on arrival
+      const double stamp = attitude_cmd->header.stamp.isZero() ? ros::Time::now().toSec() : attitude_cmd->header.stamp.toSec();
+
+      landing_detector_.addThrust(stamp, mass_estimate, desired_thrust < 0.01);
+    }
+  }
+
+  if (maxthrust_armed_) {
+    checkMaxThrust(desired_thrust);
+  }
 }
 
 //}
@@ -1187,7 +1478,9 @@ bool UavManager::callbackTakeoff([[maybe_unused]] std_srvs::Trigger::Request& re
     }
 
     {
-      if (!sh_control_manager_diag_.hasMsg()) {
+      auto control_manager_state = getControlManagerState();
+
+      if (!control_manager_state) {
         ss << "can not takeoff, missing control manager diagnostics!";
         ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
         res.message = ss.str();
@@ -1195,7 +1488,7 @@ bool UavManager::callbackTakeoff([[maybe_unused]] std_srvs::Trigger::Request& re
         return true;
       }
 
-      if (_null_tracker_name_ != sh_control_manager_diag_.getMsg()->active_tracker) {
+      if (null_tracker_id_ != control_manager_state->active_tracker) {
         ss << "can not takeoff, need '" << _null_tracker_name_ << "' to be active!";
         ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
         res.message = ss.str();
@@ -1271,9 +1564,9 @@ bool UavManager::callbackTakeoff([[maybe_unused]] std_srvs::Trigger::Request& re
 
   //}
 
-  auto control_manager_diagnostics = sh_control_manager_diag_.getMsg();
-  auto odometry                    = sh_odometry_.getMsg();
-  auto [odom_x, odom_y, odom_z]    = mrs_lib::getPosition(sh_odometry_.getMsg());
+  auto control_manager_state    = getControlManagerState();
+  auto odometry                 = sh_odometry_.getMsg();
+  auto [odom_x, odom_y, odom_z] = mrs_lib::getPosition(sh_odometry_.getMsg());
 
   double odom_heading;
   try {
@@ -1292,101 +1585,95 @@ bool UavManager::callbackTakeoff([[maybe_unused]] std_srvs::Trigger::Request& re
 
   ROS_INFO("[UavManager]: taking off");
 
-  setOdometryCallbacksSrv(false);
+  const std::string old_controller = state_board_->names.name(control_manager_state->active_controller);
+  const std::string old_tracker    = state_board_->names.name(control_manager_state->active_tracker);
 
-  // activating the takeoff controller
-  {
-    std::string old_controller      = sh_control_manager_diag_.getMsg()->active_controller;
-    bool        controller_switched = switchControllerSrv(_takeoff_controller_name_);
+  CommandSequence sequence(command_stragglers_, commandProgress("takeoff"));
 
-    // if it fails, activate back the old controller
-    // this is no big deal since the control outputs are not used
-    // until NullTracker is active
-    if (!controller_switched) {
-
-      std::stringstream ss;
-      ss << "could not activate '" << _takeoff_controller_name_ << "' for takeoff";
-      ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
-      res.success = false;
-      res.message = ss.str();
+  // the odometry callbacks are independent of the controller switch, its failure does not stop the takeoff
+  sequence.addOptionalStep(
+      "odometry_callbacks",
+      [this]() {
+        setOdometryCallbacksSrv(false);
+        return true;
+      },
+      _command_timeout_callbacks_);
 
-      switchControllerSrv(old_controller);
+  // activating the takeoff controller
+  // if it fails, activate back the old controller
+  // this is no big deal since the control outputs are not used
+  // until NullTracker is active
+  sequence.addStep(
+      "switch_controller", [this]() { return switchControllerSrv(_takeoff_controller_name_); }, _command_timeout_switch_,
+      [this, old_controller]() { switchControllerSrv(old_controller); });
 
-      return true;
-    }
-  }
+  sequence.nextStage();
 
   // activate the takeoff tracker
-  {
-    std::string old_tracker      = sh_control_manager_diag_.getMsg()->active_tracker;
-    bool        tracker_switched = switchTrackerSrv(_takeoff_tracker_name_);
-
-    // if it fails, activate back the old tracker
-    if (!tracker_switched) {
-
-      std::stringstream ss;
-      ss << "could not activate '" << _takeoff_tracker_name_ << "' for takeoff";
-      ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
-      res.success = false;
-      res.message = ss.str();
-
-      switchTrackerSrv(old_tracker);
+  // if it fails, activate back the old tracker
+  sequence.addStep(
+      "switch_tracker", [this]() { return switchTrackerSrv(_takeoff_tracker_name_); }, _command_timeout_switch_,
+      [this, old_tracker]() { switchTrackerSrv(old_tracker); });
 
-      return true;
-    }
-  }
+  sequence.nextStage();
 
   // now the takeoff tracker and controller are active
   // the UAV is basically hovering on the ground
   // (the controller is probably rumping up the thrust now)
 
   // call the takeoff service at the takeoff tracker
-  {
-    bool takeoff_successful = takeoffSrv();
+  // if the call for takeoff fails, call for emergency landing
+  sequence.addStep(
+      "takeoff", [this]() { return takeoffSrv(); }, _command_timeout_takeoff_, [this]() { elandSrv(); });
 
-    // if the takeoff was not successful, switch to NullTracker
-    if (takeoff_successful) {
+  auto [takeoff_successful, failed_step] = sequence.run();
 
-      // save the current spot for later landing
-      {
-        std::scoped_lock lock(mutex_land_there_reference_);
+  if (!takeoff_successful) {
 
-        land_there_reference_.header               = odometry->header;
-        land_there_reference_.reference.position.x = odom_x;
-        land_there_reference_.reference.position.y = odom_y;
-        land_there_reference_.reference.position.z = odom_z;
-        land_there_reference_.reference.heading    = odom_heading;
-      }
+    std::stringstream ss;
 
-      timer_flighttime_.start();
+    if (failed_step == "switch_controller") {
+      ss << "could not activate '" << _takeoff_controller_name_ << "' for takeoff";
+    } else if (failed_step == "switch_tracker") {
+      ss << "could not activate '" << _takeoff_tracker_name_ << "' for takeoff";
+    } else {
+      ss << "takeoff was not successful";
+    }
 
-      std::stringstream ss;
-      ss << "taking off";
-      res.success = true;
-      res.message = ss.str();
-      ROS_INFO_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
+    ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
+    res.success = false;
+    res.message = ss.str();
 
-      takingoff_ = true;
-      number_of_takeoffs_++;
-      waiting_for_takeoff_ = true;
+    return true;
+  }
 
-      // start the takeoff timer
-      timer_takeoff_.start();
+  // save the current spot for later landing
+  {
+    std::scoped_lock lock(mutex_land_there_reference_);
 
-      takeoff_successful_ = takeoff_successful;
+    land_there_reference_.header               = odometry->header;
+    land_there_reference_.reference.position.x = odom_x;
+    land_there_reference_.reference.position.y = odom_y;
+    land_there_reference_.reference.position.z = odom_z;
+    land_there_reference_.reference.heading    = odom_heading;
+  }
 
-    } else {
+  timer_flighttime_.start();
 
-      std::stringstream ss;
-      ss << "takeoff was not successful";
-      ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
-      res.success = false;
-      res.message = ss.str();
+  std::stringstream ss;
+  ss << "taking off";
+  res.success = true;
+  res.message = ss.str();
+  ROS_INFO_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
 
-      // if the call for takeoff fails, call for emergency landing
-      elandSrv();
-    }
-  }
+  takingoff_ = true;
+  number_of_takeoffs_++;
+  waiting_for_takeoff_ = true;
+
+  // start the takeoff timer
+  timer_takeoff_.start();
+
+  takeoff_successful_ = takeoff_successful;
 
   return true;
 }
@@ -1414,7 +1701,9 @@ bool UavManager::callbackLand([[maybe_unused]] std_srvs::Trigger::Request& req,
     }
 
     {
-      if (!sh_control_manager_diag_.hasMsg()) {
+      auto control_manager_state = getControlManagerState();
+
+      if (!control_manager_state) {
         ss << "can not land, missing control manager diagnostics!";
         res.message = ss.str();
         res.success = false;
@@ -1422,7 +1711,7 @@ bool UavManager::callbackLand([[maybe_unused]] std_srvs::Trigger::Request& req,
         return true;
       }
 
-      if (_null_tracker_name_ == sh_control_manager_diag_.getMsg()->active_tracker) {
+      if (null_tracker_id_ == control_manager_state->active_tracker) {
         ss << "can not land, '" << _null_tracker_name_ << "' is active!";
         ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
         res.message = ss.str();
@@ -1489,7 +1778,9 @@ bool UavManager::callbackLandHome([[maybe_unused]] std_srvs::Trigger::Request& r
     }
 
     {
-      if (!sh_control_manager_diag_.hasMsg()) {
+      auto control_manager_state = getControlManagerState();
+
+      if (!control_manager_state) {
         ss << "can not land, missing tracker status!";
         res.message = ss.str();
         res.success = false;
@@ -1497,7 +1788,7 @@ bool UavManager::callbackLandHome([[maybe_unused]] std_srvs::Trigger::Request& r
         return true;
       }
 
-      if (_null_tracker_name_ == sh_control_manager_diag_.getMsg()->active_tracker) {
+      if (null_tracker_id_ == control_manager_state->active_tracker) {
         ss << "can not land, '" << _null_tracker_name_ << "' is active!";
         ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
         res.message = ss.str();
@@ -1636,7 +1927,9 @@ bool UavManager::callbackLandThere(mrs_msgs::ReferenceStampedSrv::Request& req,
     }
 
     {
-      if (!sh_control_manager_diag_.hasMsg()) {
+      auto control_manager_state = getControlManagerState();
+
+      if (!control_manager_state) {
         ss << "can not land, missing tracker status!";
         res.message = ss.str();
         res.success = false;
@@ -1644,7 +1937,7 @@ bool UavManager::callbackLandThere(mrs_msgs::ReferenceStampedSrv::Request& req,
         return true;
       }
 
-      if (_null_tracker_name_ == sh_control_manager_diag_.getMsg()->active_tracker) {
+      if (null_tracker_id_ == control_manager_state->active_tracker) {
         ss << "can not land, '" << _null_tracker_name_ << "' is active!";
         ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
         res.message = ss.str();
@@ -1775,7 +2068,9 @@ bool UavManager::callbackMidairActivation([[maybe_unused]] std_srvs::Trigger::Re
     }
 
     {
-      if (!sh_control_manager_diag_.hasMsg()) {
+      auto control_manager_state = getControlManagerState();
+
+      if (!control_manager_state) {
         ss << "can not activate, missing control manager diagnostics!";
         ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
         res.message = ss.str();
@@ -1783,7 +2078,7 @@ bool UavManager::callbackMidairActivation([[maybe_unused]] std_srvs::Trigger::Re
         return true;
       }
 
-      if (_null_tracker_name_ != sh_control_manager_diag_.getMsg()->active_tracker) {
+      if (null_tracker_id_ != control_manager_state->active_tracker) {
         ss << "can not activate, need '" << _null_tracker_name_ << "' to be active!";
         ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
         res.message = ss.str();
@@ -1865,91 +2160,303 @@ bool UavManager::callbackMidairActivation([[maybe_unused]] std_srvs::Trigger::Re
 
 // | ------------------------ routines ------------------------ |
 
-/* landImpl() //{ */
+/* checkMaxHeight() //{ */
 
-std::tuple<bool, std::string> UavManager::landImpl(void) {
+void UavManager::checkMaxHeight(const double height) {
 
-  // activating the landing controller
-  {
-    std::string old_controller      = sh_control_manager_diag_.getMsg()->active_controller;
-    bool        controller_switched = switchControllerSrv(_landing_controller_name_);
+  if (!sh_max_height_.hasMsg() || !sh_odometry_.hasMsg()) {
+    return;
+  }
 
-    // if it fails, activate eland
-    // Tomas: I pressume that its more important to get the UAV to the ground rather than
-    // just throw out error.
-    if (!controller_switched) {
+  const double max_height = sh_max_height_.getMsg()->value;
 
-      std::stringstream ss;
-      ss << "could not activate '" << _takeoff_controller_name_ << "' for landing";
-      ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
+  // | ------------ released below the hysteresis band ----------- |
 
-      elandSrv();
+  if (fixing_max_height_) {
 
-      return std::tuple(false, ss.str());
+    if (height < max_height - _max_height_hysteresis_) {
+
+      setControlCallbacksSrv(true);
+
+      ROS_WARN_THROTTLE(1.0, "[UavManager]: safe height reached");
+
+      fixing_max_height_ = false;
     }
+
+    return;
   }
 
-  // activate the landing tracker
-  {
-    std::string old_tracker      = sh_control_manager_diag_.getMsg()->active_tracker;
-    bool        tracker_switched = switchTrackerSrv(_landing_tracker_name_);
+  // | --------- triggered once when the limit is crossed -------- |
 
-    // if it fails, activate eland
-    // Tomas: I pressume that its more important to get the UAV to the ground rather than
-    // just throw out error.
-    if (!tracker_switched) {
+  if (height <= max_height) {
+    return;
+  }
 
-      std::stringstream ss;
-      ss << "could not activate '" << _takeoff_tracker_name_ << "' for landing";
-      ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
+  // a failed intervention is retried, but not on every measurement
+  if ((ros::Time::now() - max_height_last_attempt_).toSec() < _max_height_retry_period_) {
+    return;
+  }
 
-      elandSrv();
+  max_height_last_attempt_ = ros::Time::now();
 
-      return std::tuple(false, ss.str());
+  nav_msgs::OdometryConstPtr odometry = sh_odometry_.getMsg();
+
+  auto [odometry_x, odometry_y, odometry_z] = mrs_lib::getPosition(odometry);
+
+  double odometry_heading = 0;
+  try {
+    odometry_heading = mrs_lib::getHeading(odometry);
+  }
+  catch (mrs_lib::AttitudeConverter::GetHeadingException& e) {
+    ROS_ERROR_THROTTLE(1.0, "[UavManager]: exception caught: '%s'", e.what());
+    return;
+  }
+
+  ROS_WARN_THROTTLE(1.0, "[UavManager]: max height exceeded: %.2f >  %.2f, triggering safety goto", height, max_height);
+
+  mrs_msgs::ReferenceStamped reference_out;
+  reference_out.header.frame_id = odometry->header.frame_id;
+  reference_out.header.stamp    = ros::Time::now();
+
+  reference_out.reference.position.x = odometry_x;
+  reference_out.reference.position.y = odometry_y;
+  reference_out.reference.position.z = odometry_z + ((max_height - _max_height_offset_) - height);
+
+  reference_out.reference.heading = odometry_heading;
+
+  setControlCallbacksSrv(false);
+
+  bool success = emergencyReferenceSrv(reference_out);
+
+  if (success) {
+
+    ROS_INFO("[UavManager]: descending");
+
+    fixing_max_height_ = true;
+
+  } else {
+
+    ROS_ERROR_THROTTLE(1.0, "[UavManager]: could not descend");
+
+    setControlCallbacksSrv(true);
+  }
+}
+
+//}
+
+/* checkMinHeight() //{ */
+
+void UavManager::checkMinHeight(const double height) {
+
+  // | ------------ released above the hysteresis band ----------- |
+
+  if (fixing_min_height_) {
+
+    if (height > _min_height_ + _min_height_hysteresis_) {
+
+      setControlCallbacksSrv(true);
+
+      ROS_WARN_THROTTLE(1.0, "[UavManager]: safe height reached");
+
+      fixing_min_height_ = false;
     }
+
+    return;
   }
 
-  // call the landing service
-  {
-    bool land_successful = landSrv();
+  // | --------- triggered once when the limit is crossed -------- |
 
-    if (land_successful) {
+  if (height >= _min_height_) {
+    return;
+  }
 
-      // stop the eventual takeoff
-      waiting_for_takeoff_ = false;
-      takingoff_           = false;
-      timer_takeoff_.stop();
+  if (!sh_odometry_.hasMsg()) {
+    return;
+  }
 
-      // stop counting the flight time
-      timer_flighttime_.stop();
+  auto control_manager_state = getControlManagerState();
 
-      // remember the last valid mass estimated
-      // used during subsequent takeoff
-      last_mass_difference_ = sh_attitude_cmd_.getMsg()->mass_difference;
+  if (!control_manager_state || !control_manager_state->flying_normally) {
+    return;
+  }
 
-      setOdometryCallbacksSrv(false);
+  // a failed intervention is retried, but not on every measurement
+  if ((ros::Time::now() - min_height_last_attempt_).toSec() < _min_height_retry_period_) {
+    return;
+  }
 
-      changeLandingState(LANDING_STATE);
+  min_height_last_attempt_ = ros::Time::now();
 
-      timer_landing_.start();
+  auto odometry = sh_odometry_.getMsg();
 
-      std::stringstream ss;
-      ss << "landing initiated";
-      ROS_INFO_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
+  auto [odometry_x, odometry_y, odometry_z] = mrs_lib::getPosition(odometry);
 
-      return std::tuple(true, ss.str());
+  double odometry_heading = 0;
+  try {
+    odometry_heading = mrs_lib::getHeading(odometry);
+  }
+  catch (mrs_lib::AttitudeConverter::GetHeadingException& e) {
+    ROS_ERROR_THROTTLE(1.0, "[UavManager]: exception caught: '%s'", e.what());
+    return;
+  }
 
-    } else {
+  ROS_WARN_THROTTLE(1.0, "[UavManager]: min height breached: %.2f < %.2f, triggering safety goto", height, _min_height_);
 
-      std::stringstream ss;
-      ss << "could not land";
-      ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
+  mrs_msgs::ReferenceStamped reference_out;
+  reference_out.header.frame_id = odometry->header.frame_id;
+  reference_out.header.stamp    = ros::Time::now();
 
-      elandSrv();
+  reference_out.reference.position.x = odometry_x;
+  reference_out.reference.position.y = odometry_y;
+  reference_out.reference.position.z = odometry_z + ((_min_height_ + _min_height_offset_) - height);
 
-      return std::tuple(false, ss.str());
+  reference_out.reference.heading = odometry_heading;
+
+  setControlCallbacksSrv(false);
+
+  bool success = emergencyReferenceSrv(reference_out);
+
+  if (success) {
+
+    ROS_INFO("[UavManager]: ascending");
+
+    fixing_min_height_ = true;
+
+  } else {
+
+    ROS_ERROR_THROTTLE(1.0, "[UavManager]: could not ascend");
+
+    setControlCallbacksSrv(true);
+  }
+}
+
+//}
+
+/* checkMaxThrust() //{ */
+
+void UavManager::checkMaxThrust(const double desired_thrust) {
+
+  // | --------- entering and leaving the violation (edges) ------- |
+
+  if (!maxthrust_above_threshold_ && desired_thrust >= _maxthrust_max_thrust_) {
+
+    maxthrust_first_time_      = ros::Time::now();
+    maxthrust_above_threshold_ = true;
+    maxthrust_ungripped_       = false;
+
+    ROS_WARN_THROTTLE(1.0, "[UavManager]: max thrust exceeded threshold (%.2f/%.2f)", desired_thrust, _maxthrust_max_thrust_);
+
+  } else if (maxthrust_above_threshold_ && desired_thrust < _maxthrust_max_thrust_ - _maxthrust_hysteresis_) {
+
+    maxthrust_above_threshold_ = false;
+  }
+
+  if (!maxthrust_above_threshold_) {
+    return;
+  }
+
+  const double time_above = (ros::Time::now() - maxthrust_first_time_).toSec();
+
+  ROS_WARN_THROTTLE(0.1, "[UavManager]: thrust over threshold (%.2f/%.2f) for %.2f s", desired_thrust, _maxthrust_max_thrust_, time_above);
+
+  if (!maxthrust_ungripped_ && time_above > _maxthrust_ungrip_timeout_) {
+
+    ROS_WARN_THROTTLE(1.0, "[UavManager]: thrust over threshold (%.2f/%.2f) for more than %.2f s, ungripping payload", desired_thrust, _maxthrust_max_thrust_,
+                      _maxthrust_ungrip_timeout_);
+
+    ungripSrv();
+
+    maxthrust_ungripped_ = true;
+  }
+
+  if (time_above > _maxthrust_eland_timeout_) {
+
+    maxthrust_armed_ = false;
+
+    ROS_ERROR_THROTTLE(1.0, "[UavManager]: thrust over threshold (%.2f/%.2f) for more than %.2f s, calling for emergency landing", desired_thrust,
+                       _maxthrust_max_thrust_, _maxthrust_eland_timeout_);
+
+    elandSrv();
+  }
+}
+
+//}
+
+/* landImpl() //{ */
+
+std::tuple<bool, std::string> UavManager::landImpl(void) {
+
+  CommandSequence sequence(command_stragglers_, commandProgress("landing"));
+
+  // the odometry callbacks are disabled for the landing, independently of the controller switch
+  // (its failure leads to eland, when the callbacks stay disabled as well)
+  sequence.addOptionalStep(
+      "odometry_callbacks",
+      [this]() {
+        setOdometryCallbacksSrv(false);
+        return true;
+      },
+      _command_timeout_callbacks_);
+
+  // activating the landing controller
+  // if it fails, activate eland
+  // Tomas: I pressume that its more important to get the UAV to the ground rather than
+  // just throw out error.
+  sequence.addStep(
+      "switch_controller", [this]() { return switchControllerSrv(_landing_controller_name_); }, _command_timeout_switch_, [this]() { elandSrv(); });
+
+  sequence.nextStage();
+
+  // activate the landing tracker, if it fails, activate eland
+  sequence.addStep(
+      "switch_tracker", [this]() { return switchTrackerSrv(_landing_tracker_name_); }, _command_timeout_switch_, [this]() { elandSrv(); });
+
+  sequence.nextStage();
+
+  // call the landing service
+  sequence.addStep(
+      "land", [this]() { return landSrv(); }, _command_timeout_land_, [this]() { elandSrv(); });
+
+  auto [land_successful, failed_step] = sequence.run();
+
+  if (!land_successful) {
+
+    std::stringstream ss;
+
+    if (failed_step == "switch_controller") {
+      ss << "could not activate '" << _landing_controller_name_ << "' for landing";
+    } else if (failed_step == "switch_tracker") {
+      ss << "could not activate '" << _landing_tracker_name_ << "' for landing";
+    } else {
+      ss << "could not land";
     }
+
+    ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
+
+    return std::tuple(false, ss.str());
   }
+
+  // stop the eventual takeoff
+  waiting_for_takeoff_ = false;
+  takingoff_           = false;
+  timer_takeoff_.stop();
+
+  // stop counting the flight time
+  timer_flighttime_.stop();
+
+  // remember the last valid mass estimated
+  // used during subsequent takeoff
+  last_mass_difference_ = sh_attitude_cmd_.getMsg()->mass_difference;
+
+  changeLandingState(LANDING_STATE);
+
+  timer_landing_.start();
+
+  std::stringstream ss;
+  ss << "landing initiated";
+  ROS_INFO_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
+
+  return std::tuple(true, ss.str());
 }
 
 //}
@@ -2020,11 +2527,22 @@ std::tuple<bool, std::string> UavManager::landWithDescendImpl(void) {
 
 std::tuple<bool, std::string> UavManager::midairActivationImpl(void) {
 
+  auto control_manager_state = getControlManagerState();
+
+  if (!control_manager_state) {
+
+    std::stringstream ss;
+    ss << "missing the ControlManager state";
+    ROS_ERROR_STREAM_THROTTLE(1.0, "[UavManager]: " << ss.str());
+
+    return std::tuple(false, ss.str());
+  }
+
   // 1. activate the mid-air activation controller
   // the controller will output hover thrust and "leveled" desired orientation with the currend heading
   std::string old_controller;
   {
-    old_controller           = sh_control_manager_diag_.getMsg()->active_controller;
+    old_controller           = state_board_->names.name(control_manager_state->active_controller);
     bool controller_switched = switchControllerSrv(_midair_activation_during_controller_);
 
     if (!controller_switched) {
@@ -2057,7 +2575,7 @@ std::tuple<bool, std::string> UavManager::midairActivationImpl(void) {
   // this will cause the Control Manager to output something else than min-thrust
   std::string old_tracker;
   {
-    old_tracker = sh_control_manager_diag_.getMsg()->active_tracker;
+    old_tracker = state_board_->names.name(control_manager_state->active_tracker);
 
     bool tracker_switched = switchTrackerSrv(_midair_activation_during_tracker_);
 
@@ -2111,6 +2629,71 @@ std::tuple<bool, std::string> UavManager::midairActivationImpl(void) {
 
 //}
 
+/* getControlManagerState() //{ */
+
+std::optional<state_board::ControlManagerState> UavManager::getControlManagerState(void) {
+
+  state_board::ControlManagerState state;
+
+  // the ControlManager runs in the same process and keeps the board fresh
+  if (_state_board_enabled_ && state_board_->getControlManagerState(state, ros::Time::now().toSec(), _state_board_timeout_)) {
+    return state;
+  }
+
+  if (!sh_control_manager_diag_.hasMsg()) {
+    return {};
+  }
+
+  auto diagnostics = sh_control_manager_diag_.getMsg();
+
+  state.stamp             = diagnostics->stamp.toSec();
+  state.active_tracker    = diagnostics_active_tracker_.get(state_board_->names, diagnostics->active_tracker);
+  state.active_controller = diagnostics_active_controller_.get(state_board_->names, diagnostics->active_controller);
+  state.motors            = diagnostics->motors;
+  state.rc_mode           = diagnostics->rc_mode;
+  state.flying_normally   = diagnostics->flying_normally;
+  state.tracker_active    = diagnostics->tracker_status.active;
+  state.have_goal         = diagnostics->tracker_status.have_goal;
+  state.controller_active = diagnostics->controller_status.active;
+
+  return state;
+}
+
+//}
+
+/* getControlManagerCommands() //{ */
+
+std::shared_ptr<const state_board::ControlManagerCommands> UavManager::getControlManagerCommands(void) {
+
+  if (!_state_board_enabled_) {
+    return nullptr;
+  }
+
+  return state_board_->getControlManagerCommands();
+}
+
+//}
+
+/* commandProgress() //{ */
+
+// reports the progress of the command sequences on a topic
+CommandSequence::progress_t UavManager::commandProgress(const std::string& sequence) {
+
+  return [this, sequence](const std::string& step, const std::string& result, const double duration) {
+    std::stringstream ss;
+    ss << sequence << ": " << step << ": " << result << " (" << std::fixed << std::setprecision(3) << duration << " s)";
+
+    ROS_DEBUG_STREAM("[UavManager]: " << ss.str());
+
+    std_msgs::String msg;
+    msg.data = ss.str();
+
+    ph_command_progress_.publish(msg);
+  };
+}
+
+//}
+
 // | ----------------- service client wrappers ---------------- |
 
 /* setOdometryCallbacksSrv() //{ */
@@ -2144,6 +2727,17 @@ void UavManager::setControlCallbacksSrv(const bool& input) {
 
   ROS_INFO("[UavManager]: switching control callabcks to %s", input ? "ON" : "OFF");
 
+  if (auto commands = getControlManagerCommands()) {
+
+    auto [success, message] = commands->enable_callbacks(input);
+
+    if (!success) {
+      ROS_WARN("[UavManager]: in-process call for setting control callbacks returned: %s.", message.c_str());
+    }
+
+    return;
+  }
+
   std_srvs::SetBool srv;
 
   srv.request.data = input;
@@ -2298,6 +2892,17 @@ bool UavManager::switchControllerSrv(const std::string& controller) {
 
   ROS_INFO_STREAM("[UavManager]: activating controller '" << controller << "'");
 
+  if (auto commands = getControlManagerCommands()) {
+
+    auto [success, message] = commands->switch_controller(controller);
+
+    if (!success) {
+      ROS_WARN("[UavManager]: in-process call for switching controller returned: '%s'", message.c_str());
+    }
+
+    return success;
+  }
+
   mrs_msgs::String srv;
   srv.request.value = controller;
 
@@ -2327,6 +2932,16 @@ bool UavManager::switchTrackerSrv(const std::string& tracker) {
 
   ROS_INFO_STREAM("[UavManager]: activating tracker '" << tracker << "'");
 
+  if (auto commands = getControlManagerCommands()) {
+
+    auto [success, message] = commands->switch_tracker(tracker);
+
+    if (!success) {
+      ROS_WARN("[UavManager]: in-process call for switching tracker returned: '%s'", message.c_str());
+    }
+
+    return success;
+  }
 
   mrs_msgs::String srv;
   srv.request.value = tracker;
@@ -2385,6 +3000,17 @@ bool UavManager::elandSrv(void) {
 
   ROS_INFO("[UavManager]: calling for eland");
 
+  if (auto commands = getControlManagerCommands()) {
+
+    auto [success, message] = commands->eland();
+
+    if (!success) {
+      ROS_WARN("[UavManager]: in-process call for eland returned: '%s'", message.c_str());
+    }
+
+    return success;
+  }
+
   std_srvs::Trigger srv;
 
   bool res = sch_eland_.call(srv);
@@ -2413,6 +3039,17 @@ bool UavManager::ehoverSrv(void) {
 
   ROS_INFO("[UavManager]: calling for ehover");
 
+  if (auto commands = getControlManagerCommands()) {
+
+    auto [success, message] = commands->ehover();
+
+    if (!success) {
+      ROS_WARN("[UavManager]: in-process call for ehover returned: '%s'", message.c_str());
+    }
+
+    return success;
+  }
+
   std_srvs::Trigger srv;
 
   bool res = sch_ehover_.call(srv);
@@ -2471,6 +3108,17 @@ bool UavManager::emergencyReferenceSrv(const mrs_msgs::ReferenceStamped& goal) {
 
   ROS_INFO_THROTTLE(1.0, "[UavManager]: calling for emergency reference");
 
+  if (auto commands = getControlManagerCommands()) {
+
+    auto [success, message] = commands->emergency_reference(goal);
+
+    if (!success) {
+      ROS_WARN_THROTTLE(1.0, "[UavManager]: in-process call for emergency reference returned: '%s'", message.c_str());
+    }
+
+    return success;
+  }
+
   mrs_msgs::ReferenceStampedSrv srv;
 
   srv.request.header    = goal.header;